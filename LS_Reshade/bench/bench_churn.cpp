@@ -0,0 +1,123 @@
+// Window churn on FakeWindowSystem with passthrough on: every tick LS
+// destroys its oldest few popup windows (layered, so they are subclassed)
+// and opens as many new ones. Checks that the worker's window state stays
+// flat (rows, proc table entries, restore journal records and the memory
+// behind them) and that destroyed windows are released without a sweep;
+// reports per-tick latency, split by whether the tick falls where the old
+// 100-tick sweep ran.
+//
+//   bench_churn [--children N] [--popups N] [--churn N] [--ticks N]
+#include "bench_common.hpp"
+#include "window_manager.hpp"
+#include "worker.hpp"
+#include "settings.hpp"
+#include "focus_resolver.hpp"
+#include "restore_journal.hpp"
+#include <deque>
+
+namespace {
+    int failures = 0;
+
+    void Expect(bool ok, const char* what) {
+        if (!ok) {
+            printf("FAILED: %s\n", what);
+            ++failures;
+        }
+    }
+
+    HWND AddPopup(FakeWindowSystem& sys, HWND lsWindow) {
+        FakeWindowSystem::WindowDesc d;
+        d.pid = sys.CurrentProcessId(); d.tid = 2; d.parent = lsWindow; d.className = "Popup";
+        d.exStyle = WS_EX_LAYERED | WS_EX_TRANSPARENT;
+        return sys.AddWindow(d);
+    }
+}
+
+int main(int argc, char** argv) {
+    int children = (int)Bench::ArgInt(argc, argv, "--children", 64);
+    int popups = (int)Bench::ArgInt(argc, argv, "--popups", 32);
+    int churn = (int)Bench::ArgInt(argc, argv, "--churn", 4);
+    int ticks = (int)Bench::ArgInt(argc, argv, "--ticks", 5000);
+    if (popups < 1) popups = 1;
+    if (churn < 1) churn = 1;
+    if (churn > popups) churn = popups;
+    if (ticks < 200) ticks = 200;
+
+    FakeWindowSystem sys;
+    g_WindowSystem = &sys;
+    Bench::Scene scene = Bench::BuildScene(sys, 100, children);
+    g_Settings.SetPassthrough(true);
+    g_FocusResolver.Start(); // destroy events reach the rules cache, as in the addon
+    WorkerState state;
+    uint64_t now = 0;
+    WorkerTick(state, now);
+
+    std::deque<HWND> live;
+    for (int i = 0; i < popups; ++i) live.push_back(AddPopup(sys, scene.lsWindow));
+    WorkerTick(state, now += 10);
+    const LONG_PTR hook = sys.Peek(scene.lsWindow, GWLP_WNDPROC);
+    const WindowManager::Footprint start = WindowManager::GetFootprint();
+    printf("bench_churn: %d LS children, %d popups, %d replaced per tick, %d ticks (%d windows destroyed)\n",
+           children, popups, churn, ticks, ticks * churn);
+
+    std::vector<uint64_t> samples, sweepTicks, otherTicks;
+    samples.reserve(ticks);
+    WindowManager::Footprint low = start, high = start;
+    size_t journalHigh = 0;
+    bool allHooked = true;
+    sys.ResetCounters();
+    for (int t = 0; t < ticks; ++t) {
+        for (int i = 0; i < churn; ++i) {
+            sys.RemoveWindow(live.front());
+            live.pop_front();
+            live.push_back(AddPopup(sys, scene.lsWindow));
+        }
+        uint64_t t0 = Bench::NowNs();
+        WorkerTick(state, now += 10);
+        uint64_t ns = Bench::NowNs() - t0;
+        samples.push_back(ns);
+        (t % 100 == 99 ? sweepTicks : otherTicks).push_back(ns);
+
+        allHooked = allHooked && sys.Peek(live.back(), GWLP_WNDPROC) == hook;
+        WindowManager::Footprint f = WindowManager::GetFootprint();
+        low.rows = std::min(low.rows, f.rows);
+        high.rows = std::max(high.rows, f.rows);
+        low.procs = std::min(low.procs, f.procs);
+        high.procs = std::max(high.procs, f.procs);
+        high.rowCapacity = std::max(high.rowCapacity, f.rowCapacity);
+        high.procCapacity = std::max(high.procCapacity, f.procCapacity);
+        journalHigh = std::max(journalHigh, g_Journal.Records());
+    }
+    const double isAlive = (double)sys.Count(FakeWindowSystem::ApiIsAlive) / ticks;
+
+    // Every popup gone at once (focus back on the LS window, since the
+    // last one raised had it): back to the LS window's own rows.
+    sys.Focus(scene.lsWindow);
+    for (HWND hwnd : live) sys.RemoveWindow(hwnd);
+    WorkerTick(state, now += 10);
+    const WindowManager::Footprint end = WindowManager::GetFootprint();
+
+    Bench::Summary all = Bench::Summarize(samples);
+    Bench::PrintSummary("tick ns", all);
+    Bench::PrintSummary("  every 100th tick", Bench::Summarize(sweepTicks));
+    Bench::PrintSummary("  other ticks", Bench::Summarize(otherTicks));
+    printf("IsWindow calls/tick    %.2f\n", isAlive);
+    printf("rows                   %zu..%zu (room for %zu -> %zu)\n", low.rows, high.rows, start.rowCapacity, high.rowCapacity);
+    printf("proc table entries     %zu..%zu (fixed capacity %zu)\n", low.procs, high.procs, high.procCapacity);
+    printf("journal records        up to %zu (first allocation %zu)\n", journalHigh, RestoreJournal::kInitialRecords);
+    printf("after closing popups   %zu rows, %zu entries\n", end.rows, end.procs);
+
+    Expect(allHooked, "every new popup is subclassed");
+    Expect(low.rows == start.rows && high.rows == start.rows, "rows stay flat under churn");
+    Expect(low.procs == start.procs && high.procs == start.procs, "proc table entries stay flat under churn");
+    Expect(high.rowCapacity == start.rowCapacity, "row columns never grow under churn");
+    Expect(high.procCapacity == start.procCapacity, "proc table never grows");
+    Expect(journalHigh <= RestoreJournal::kInitialRecords, "restore journal never grows");
+    Expect(end.rows == start.rows - popups && end.procs == start.procs - popups, "closed popups are released");
+
+    g_FocusResolver.Stop();
+    g_Settings.SetPassthrough(false);
+    WindowManager::RestoreAll();
+    printf("failures               %d\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,146 @@
+#pragma once
+#include "fake_window_system.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Shared helpers for the fake-backend benchmarks.
+namespace Bench {
+    typedef std::chrono::steady_clock Clock;
+
+    inline uint64_t NowNs() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+    }
+
+    // "--name value" integer option, or fallback.
+    inline long ArgInt(int argc, char** argv, const char* name, long fallback) {
+        for (int i = 1; i + 1 < argc; ++i) {
+            if (strcmp(argv[i], name) == 0) return strtol(argv[i + 1], nullptr, 10);
+        }
+        return fallback;
+    }
+
+    // "--name value" string option, or fallback.
+    inline const char* ArgStr(int argc, char** argv, const char* name, const char* fallback) {
+        for (int i = 1; i + 1 < argc; ++i) {
+            if (strcmp(argv[i], name) == 0) return argv[i + 1];
+        }
+        return fallback;
+    }
+
+    struct Summary {
+        uint64_t min = 0, p50 = 0, p99 = 0, max = 0;
+        double mean = 0;
+    };
+
+    inline Summary Summarize(std::vector<uint64_t> samples) {
+        Summary s;
+        if (samples.empty()) return s;
+        std::sort(samples.begin(), samples.end());
+        uint64_t total = 0;
+        for (uint64_t v : samples) total += v;
+        s.min = samples.front();
+        s.max = samples.back();
+        s.p50 = samples[samples.size() / 2];
+        s.p99 = samples[std::min(samples.size() - 1, samples.size() * 99 / 100)];
+        s.mean = (double)total / samples.size();
+        return s;
+    }
+
+    inline void PrintSummary(const char* label, const Summary& s) {
+        printf("%-22s min %8llu  p50 %8llu  p99 %8llu  max %9llu  mean %10.1f\n", label,
+               (unsigned long long)s.min, (unsigned long long)s.p50, (unsigned long long)s.p99,
+               (unsigned long long)s.max, s.mean);
+    }
+
+    // Prints the per-API call counts of the fake, divided by `per`.
+    inline void PrintCalls(const FakeWindowSystem& sys, double per) {
+        for (int i = 0; i < FakeWindowSystem::ApiCount; ++i) {
+            uint64_t n = sys.Count((FakeWindowSystem::Api)i);
+            if (n) printf("  %-20s %10.2f\n", FakeWindowSystem::ApiName((FakeWindowSystem::Api)i), n / per);
+        }
+    }
+
+    // One LS session on top of the z-order: a game window, then right above
+    // it an LS window with `children` child windows (every 8th is layered).
+    struct Session {
+        HWND lsWindow = nullptr;
+        HWND target = nullptr;
+        std::vector<HWND> lsChildren;
+    };
+
+    inline Session AddSession(FakeWindowSystem& sys, int children, DWORD gamePid = 3000, bool hiddenSibling = false) {
+        const DWORD self = sys.CurrentProcessId();
+        Session session;
+
+        FakeWindowSystem::WindowDesc game;
+        game.pid = gamePid; game.tid = gamePid * 10; game.className = "UnityWndClass";
+        session.target = sys.AddWindow(game);
+
+        if (hiddenSibling) {
+            FakeWindowSystem::WindowDesc hidden;
+            hidden.pid = self; hidden.tid = 2; hidden.style = 0; hidden.className = "HwndWrapper[Hidden]";
+            sys.AddWindow(hidden);
+        }
+
+        FakeWindowSystem::WindowDesc ls;
+        ls.pid = self; ls.tid = 2; ls.className = "HwndWrapper[LosslessScaling]";
+        ls.exStyle = WS_EX_LAYERED | WS_EX_TRANSPARENT | WS_EX_NOACTIVATE;
+        session.lsWindow = sys.AddWindow(ls);
+
+        for (int i = 0; i < children; ++i) {
+            FakeWindowSystem::WindowDesc c;
+            c.pid = self; c.tid = 2; c.parent = session.lsWindow; c.className = "Static";
+            c.exStyle = (i % 8 == 0) ? WS_EX_LAYERED : 0;
+            session.lsChildren.push_back(sys.AddWindow(c));
+        }
+        return session;
+    }
+
+    // Shell windows at the bottom of the z-order, then `foreign` unrelated
+    // top-level windows.
+    inline std::vector<HWND> AddDesktop(FakeWindowSystem& sys, int foreign) {
+        static const char* const kClasses[] = { "Chrome_WidgetWin_1", "Notepad", "CabinetWClass", "ConsoleWindowClass", "ApplicationFrameWindow" };
+        FakeWindowSystem::WindowDesc d;
+        d.pid = 4; d.tid = 40;
+        d.className = "Progman"; sys.AddWindow(d);
+        d.className = "WorkerW"; sys.AddWindow(d);
+        d.className = "Shell_TrayWnd"; sys.AddWindow(d);
+
+        std::vector<HWND> windows;
+        for (int i = 0; i < foreign; ++i) {
+            FakeWindowSystem::WindowDesc f;
+            f.pid = 2000 + (i % 64);
+            f.tid = 20000 + i;
+            f.className = kClasses[i % 5];
+            f.style = (i % 3 == 0) ? 0 : WS_VISIBLE;
+            windows.push_back(sys.AddWindow(f));
+        }
+        return windows;
+    }
+
+    // A desktop resembling a Lossless Scaling session: shell windows at the
+    // bottom, `foreign` unrelated top-level windows, the scaled game, then the
+    // LS overlay on top with `children` child windows (every 8th is layered).
+    struct Scene {
+        HWND lsWindow = nullptr;
+        HWND target = nullptr;
+        std::vector<HWND> lsChildren;
+        std::vector<HWND> foreign;
+    };
+
+    inline Scene BuildScene(FakeWindowSystem& sys, int foreign, int children) {
+        Scene scene;
+        scene.foreign = AddDesktop(sys, foreign);
+        Session session = AddSession(sys, children, 3000, true);
+        scene.lsWindow = session.lsWindow;
+        scene.target = session.target;
+        scene.lsChildren.swap(session.lsChildren);
+        sys.Focus(scene.lsWindow);
+        return scene;
+    }
+}
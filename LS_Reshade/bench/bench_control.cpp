@@ -0,0 +1,197 @@
+// Control channel: round-trip time of requests from other threads to the
+// worker through the shared mailbox, with the worker idle (waiting for
+// events) and active (passthrough on), toggles and config changes made that
+// way, several clients at once, a request nobody serves (it must time out
+// and be withdrawn without upsetting the next one), and a client frozen
+// between claiming a queue cell and publishing it, as if killed there (the
+// worker must skip the cell, and cope when the client wakes up after all).
+//
+//   bench_control [--requests N] [--clients C]
+#include "bench_common.hpp"
+#include "control_channel.hpp"
+#include "settings.hpp"
+#include "worker.hpp"
+#include <atomic>
+#include <filesystem>
+#include <future>
+#include <thread>
+
+namespace {
+    ControlRequest Request(ControlCommand command, uint32_t arg = 0) {
+        ControlRequest r = {};
+        r.command = command;
+        r.arg = arg;
+        return r;
+    }
+
+    // Round trips of GetState; false if any failed.
+    bool Measure(ControlClient& client, int requests, std::vector<uint64_t>& out) {
+        ControlReply reply;
+        for (int i = 0; i < requests; ++i) {
+            uint64_t t = Bench::NowNs();
+            if (client.Send(Request(ControlGetState), reply) != ControlOk) return false;
+            out.push_back(Bench::NowNs() - t);
+        }
+        return true;
+    }
+
+    // Until its first loop the worker has not registered as the server.
+    void StartWorker() {
+        g_Worker.Start();
+        while (g_Worker.GetStats().loops == 0) std::this_thread::yield();
+    }
+}
+
+int main(int argc, char** argv) {
+    const int requests = (int)Bench::ArgInt(argc, argv, "--requests", 2000);
+    const int clients = (int)Bench::ArgInt(argc, argv, "--clients", 4);
+    int failures = 0;
+
+    FakeWindowSystem sys;
+    g_WindowSystem = &sys;
+    Bench::Scene scene = Bench::BuildScene(sys, 200, 32);
+    sys.Focus(scene.target);
+    SettingsValues config;
+    config.autoClickRepress = false;
+    g_Settings.SetValues(config);
+    g_Settings.SetPassthrough(false);
+
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "bench_control.mailbox";
+    if (!g_Control.Open(path.wstring())) {
+        printf("error: could not map %s\n", path.string().c_str());
+        return 1;
+    }
+    ControlClient client;
+    ControlReply reply;
+    if (!client.Connect(path.wstring())) {
+        printf("error: client could not connect\n");
+        return 1;
+    }
+    if (client.Send(Request(ControlGetState), reply, 50) != ControlNoServer) ++failures; // worker not running
+    StartWorker();
+
+    // 1. Round trips, idle and active.
+    std::vector<uint64_t> idleNs, activeNs;
+    if (!Measure(client, requests, idleNs)) ++failures;
+    if (client.Send(Request(ControlSetPassthrough, 1), reply) != ControlOk || !reply.state.passthrough) ++failures;
+    if (!Measure(client, requests, activeNs)) ++failures;
+
+    // 2. Toggles and config changes.
+    std::vector<uint64_t> toggleNs;
+    for (int i = 0; i < 100; ++i) {
+        uint64_t t = Bench::NowNs();
+        ControlResult r = client.Send(Request(ControlToggle), reply);
+        toggleNs.push_back(Bench::NowNs() - t);
+        if (r != ControlOk || reply.state.passthrough != (i % 2 == 1)) ++failures;
+    }
+    if (client.Send(Request(ControlSetPassthrough, 0), reply) != ControlOk || g_Settings.Read().inputPassthrough) ++failures;
+    if (client.Send(Request(ControlSetPassthrough, 2), reply) != ControlInvalid) ++failures;
+    if (client.Send(Request((ControlCommand)99), reply) != ControlInvalid) ++failures;
+
+    ControlRequest set = Request(ControlSetConfig);
+    set.hotkeyVk = VK_F1 + 7;
+    set.mods = 3;
+    set.autoClickRepress = 0;
+    SettingsValues values = g_Settings.Read().values;
+    if (client.Send(set, reply) != ControlOk || reply.state.hotkeyVk != VK_F1 + 7 || reply.state.mods != 3) ++failures;
+    values = g_Settings.Read().values;
+    if (values.hotkeyVk != VK_F1 + 7 || !values.hotkeyCtrl || !values.hotkeyAlt || values.hotkeyShift) ++failures;
+    set.hotkeyVk = 300;
+    if (client.Send(set, reply) != ControlInvalid) ++failures;
+
+    uint64_t t = Bench::NowNs();
+    if (client.Send(Request(ControlGetMetrics), reply) != ControlOk || reply.metrics.seconds <= 0) ++failures;
+    uint64_t metricsNs = Bench::NowNs() - t;
+
+    // 3. Several clients at once, each with its own mapping.
+    std::atomic<int> errors{ 0 };
+    std::vector<std::vector<uint64_t>> perClient(clients);
+    uint64_t servedBefore = g_Control.GetStats().served;
+    t = Bench::NowNs();
+    std::vector<std::thread> threads;
+    for (int c = 0; c < clients; ++c) {
+        threads.emplace_back([&, c] {
+            ControlClient mine;
+            if (!mine.Connect(path.wstring()) || !Measure(mine, requests / clients, perClient[c])) errors++;
+        });
+    }
+    for (std::thread& th : threads) th.join();
+    uint64_t concurrentNs = Bench::NowNs() - t;
+    std::vector<uint64_t> concurrent;
+    for (const std::vector<uint64_t>& v : perClient) concurrent.insert(concurrent.end(), v.begin(), v.end());
+    uint64_t served = g_Control.GetStats().served - servedBefore;
+    if (errors || served != (uint64_t)(requests / clients) * clients) ++failures;
+
+    // 4. Nobody serving: the request times out, is withdrawn, and the slot
+    // and queue still work once the worker is back.
+    g_Worker.Stop();
+    g_Control.SetServer(1, nullptr);
+    t = Bench::NowNs();
+    ControlResult timedOut = client.Send(Request(ControlGetState), reply, 20);
+    uint64_t timeoutNs = Bench::NowNs() - t;
+    StartWorker();
+    if (timedOut != ControlTimeout) ++failures;
+    if (client.Send(Request(ControlGetState), reply) != ControlOk) ++failures;
+    uint64_t abandoned = g_Control.GetStats().abandoned;
+    if (abandoned != 1) ++failures;
+
+    // 5. A dead client in the middle of the queue. Busy answers are retried.
+    auto sendRetrying = [&]() {
+        ControlResult r = ControlBusy;
+        for (uint64_t start = Bench::NowNs(); Bench::NowNs() - start < 5000000000ull;) {
+            r = client.Send(Request(ControlGetState), reply, 3000);
+            if (r != ControlBusy) break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return r;
+    };
+    MappedFile raw;
+    raw.Open(path.wstring(), true);
+    raw.Map(sizeof(ControlChannel::Mailbox));
+    ControlChannel::Mailbox* box = (ControlChannel::Mailbox*)raw.Data();
+    std::promise<void> thaw;
+    std::shared_future<void> thawed = thaw.get_future().share();
+    std::atomic<bool> claimed{ false };
+    std::thread frozen([&] {
+        box->queue.TryPush([&](uint64_t& e) {
+            claimed = true;
+            thawed.wait();
+            e = ~0ull; // no such slot
+        });
+    });
+    while (!claimed) std::this_thread::yield();
+    t = Bench::NowNs();
+    if (sendRetrying() != ControlOk) ++failures;
+    uint64_t stallNs = Bench::NowNs() - t;
+    // It publishes over the skipped cell; the next lap of the queue gets there.
+    thaw.set_value();
+    frozen.join();
+    t = Bench::NowNs();
+    for (size_t i = 0; i < decltype(box->queue)::Capacity() * 2; ++i) {
+        if (sendRetrying() != ControlOk) ++failures;
+    }
+    uint64_t lapNs = Bench::NowNs() - t;
+    raw.Close();
+    uint64_t recovered = g_Control.GetStats().recovered;
+    if (recovered != 2) ++failures;
+
+    g_Worker.Stop();
+    g_Control.Close();
+    client.Disconnect();
+    std::filesystem::remove(path);
+
+    printf("bench_control: %d requests per phase, %d concurrent clients\n", requests, clients);
+    Bench::PrintSummary("round trip idle ns", Bench::Summarize(idleNs));
+    Bench::PrintSummary("round trip active ns", Bench::Summarize(activeNs));
+    Bench::PrintSummary("toggle ns", Bench::Summarize(toggleNs));
+    Bench::PrintSummary("concurrent ns", Bench::Summarize(concurrent));
+    printf("concurrent            %.0f requests/s over %d clients\n", concurrent.size() / (concurrentNs / 1e9), clients);
+    printf("metrics snapshot      %llu ns\n", (unsigned long long)metricsNs);
+    printf("unserved request      timed out after %.1f ms, %llu withdrawn entry skipped\n", timeoutNs / 1e6,
+           (unsigned long long)abandoned);
+    printf("dead client           request behind it served after %.0f ms, lap past the late publish %.0f ms, "
+           "%llu cells recovered (stall timeout %u ms)\n",
+           stallNs / 1e6, lapNs / 1e6, (unsigned long long)recovered, ControlChannel::kStallMs);
+    printf("failures              %d\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,90 @@
+// A 1000 Hz mouse over the LS overlay with passthrough on, while the game
+// periodically hides and re-clips the cursor. Reports cursor API calls
+// against the previous per-message handling (SetCursor + GetCursorInfo +
+// ClipCursor on every WM_SETCURSOR and WM_MOUSEMOVE, plus ClipCursor every
+// worker tick) and how long the cursor stays hidden or clipped.
+//
+//   bench_cursor [--seconds S] [--reclip-ms MS]
+#include "bench_common.hpp"
+#include "cursor_manager.hpp"
+#include "focus_resolver.hpp"
+#include "settings.hpp"
+#include "worker.hpp"
+
+int main(int argc, char** argv) {
+    const int seconds = (int)Bench::ArgInt(argc, argv, "--seconds", 20);
+    const int reclipMs = (int)Bench::ArgInt(argc, argv, "--reclip-ms", 1500);
+
+    FakeWindowSystem sys;
+    g_WindowSystem = &sys;
+    Bench::Scene scene = Bench::BuildScene(sys, 32, 16);
+    sys.Focus(scene.target);
+    g_FocusResolver.Start();
+    SettingsValues config;
+    config.autoClickRepress = false;
+    g_Settings.SetValues(config);
+    g_Settings.SetPassthrough(true);
+
+    WorkerState state;
+    WorkerTick(state, 0);
+    sys.SetGameCursor(true, true);
+    sys.ResetCounters();
+    g_Cursor.ResetStats();
+
+    const FakeWindowSystem::Api cursorApis[] = { FakeWindowSystem::ApiSetArrowCursor, FakeWindowSystem::ApiIsCursorShowing,
+                                                 FakeWindowSystem::ApiQueryCursor, FakeWindowSystem::ApiShowCursor,
+                                                 FakeWindowSystem::ApiReleaseCursorClip };
+    uint64_t messages = 0;
+    uint64_t ticks = 0;
+    uint64_t brokenSince = 0;
+    bool broken = true;
+    std::vector<uint64_t> recoveryMs;
+    uint64_t hookNs = 0;
+    for (uint64_t now = 1; now <= (uint64_t)seconds * 1000; ++now) {
+        // Offset from the worker's 10 ms ticks, so recovery is not flattered.
+        if ((now + 3) % reclipMs == 0) {
+            sys.SetGameCursor(true, true);
+            if (!broken) brokenSince = now;
+            broken = true;
+        }
+        uint64_t t = Bench::NowNs();
+        sys.Dispatch(scene.lsWindow, WM_SETCURSOR);
+        sys.Dispatch(scene.lsWindow, WM_MOUSEMOVE);
+        hookNs += Bench::NowNs() - t;
+        messages += 2;
+        if (now % 10 == 0) {
+            WorkerTick(state, now);
+            ++ticks;
+        }
+        CursorState c = sys.PeekCursor();
+        if (broken && c.showing && c.arrow && !c.clipped) {
+            recoveryMs.push_back(now - brokenSince);
+            broken = false;
+        }
+    }
+
+    uint64_t calls = 0;
+    for (FakeWindowSystem::Api api : cursorApis) calls += sys.Count(api);
+    const uint64_t before = messages * 3 + ticks;
+    CursorManager::Stats stats = g_Cursor.GetStats();
+    printf("bench_cursor: %d s, %llu mouse messages, %llu worker ticks, game re-clips every %d ms\n", seconds,
+           (unsigned long long)messages, (unsigned long long)ticks, reclipMs);
+    printf("cursor calls          %llu (per-message handling: %llu), %.3f per message\n", (unsigned long long)calls,
+           (unsigned long long)before, (double)calls / messages);
+    printf("avoided               %llu, worker re-clips released %llu\n", (unsigned long long)stats.avoided,
+           (unsigned long long)stats.reclips);
+    printf("HookProc ns/message   %.1f\n", (double)hookNs / messages);
+    Bench::Summary recovery = Bench::Summarize(recoveryMs);
+    printf("hidden/clipped for    p50 %llu ms  max %llu ms over %zu takeovers\n", (unsigned long long)recovery.p50,
+           (unsigned long long)recovery.max, recoveryMs.size());
+    for (FakeWindowSystem::Api api : cursorApis) {
+        printf("  %-20s %10llu\n", FakeWindowSystem::ApiName(api), (unsigned long long)sys.Count(api));
+    }
+
+    g_FocusResolver.Stop();
+    if (broken || recovery.max > 10) {
+        printf("error: the cursor was left hidden or clipped\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,206 @@
+// Per-message cost of HookProc against the hook it replaced (reproduced
+// below as LegacyHook: every message timed, counted and looked up in the
+// table, with the passthrough flag read from the settings). Both run on one
+// FakeWindowSystem with passthrough on: the current hook on the windows the
+// worker subclassed (all of them), the legacy one on a second LS window.
+//
+//   bench_hookproc [--children N] [--messages N] [--compactions N]
+#include "bench_common.hpp"
+#include "window_manager.hpp"
+#include "worker.hpp"
+#include "settings.hpp"
+#include "metrics.hpp"
+#include "cursor_manager.hpp"
+#include "trace_recorder.hpp"
+#include "proc_table.hpp"
+#include <atomic>
+#include <thread>
+
+namespace {
+    ProcTable g_LegacyProcs;
+
+    void RecordLegacy(HWND hwnd, UINT msg, bool passthrough, uint64_t entered) {
+        uint64_t ns = Metrics::NowNs() - entered;
+        g_Metrics.hookNs.Record(ns);
+        g_Trace.Record(TraceHook, ns, 0, (uint16_t)msg, passthrough, hwnd);
+    }
+
+    LRESULT CALLBACK LegacyHook(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
+        IWindowSystem* sys = g_WindowSystem;
+        if (uMsg == sys->WakeMessage()) return 0;
+        const uint64_t entered = Metrics::NowNs();
+        g_Metrics.hookMessages.fetch_add(1, std::memory_order_relaxed);
+        const bool passthrough = g_Settings.Read().inputPassthrough;
+        if (passthrough && (uMsg == WM_SETCURSOR || uMsg == WM_MOUSEMOVE)) {
+            g_Cursor.Enforce(sys);
+            if (uMsg == WM_SETCURSOR) {
+                RecordLegacy(hwnd, uMsg, passthrough, entered);
+                return TRUE;
+            }
+        }
+        WNDPROC oldProc = g_LegacyProcs.Find(hwnd);
+        if (!oldProc) {
+            oldProc = (WNDPROC)sys->GetLong(hwnd, GWLP_WNDPROC);
+            if (oldProc == LegacyHook) {
+                RecordLegacy(hwnd, uMsg, passthrough, entered);
+                return sys->DefProc(hwnd, uMsg, wParam, lParam);
+            }
+        }
+        RecordLegacy(hwnd, uMsg, passthrough, entered);
+        LRESULT ret = sys->CallProc(oldProc, hwnd, uMsg, wParam, lParam);
+        if (passthrough && uMsg == WM_NCHITTEST && ret == HTTRANSPARENT) return HTCLIENT;
+        return ret;
+    }
+
+    // Messages a WPF window sees most, none of which the hook handles:
+    // WM_PAINT, WM_GETTEXT, WM_NCMOUSEMOVE, WM_TIMER, WM_WINDOWPOSCHANGING
+    // and a registered (dispatcher) message.
+    const UINT kForwarded[] = { 0x000F, 0x000D, 0x00A0, 0x0113, 0x0046, 0xC123 };
+
+    struct Message {
+        HWND hwnd;
+        UINT msg;
+    };
+
+    // A mouse-heavy mix: for every 16 messages, 10 forwarded, 3 mouse
+    // moves, 2 WM_SETCURSOR and 1 WM_NCHITTEST, spread over the windows.
+    std::vector<Message> Mix(const std::vector<HWND>& windows, size_t count) {
+        static const UINT kPattern[16] = { 0x000F, WM_MOUSEMOVE, 0x00A0, WM_SETCURSOR, 0x0113, 0x000D, WM_MOUSEMOVE,
+                                           0xC123, WM_NCHITTEST, 0x0046, 0x000F, WM_SETCURSOR, 0x00A0, WM_MOUSEMOVE,
+                                           0x0113, 0xC123 };
+        std::vector<Message> out;
+        out.reserve(count);
+        for (size_t i = 0; i < count; ++i) out.push_back({ windows[(i / 8) % windows.size()], kPattern[i % 16] });
+        return out;
+    }
+
+    // ns per message, p50 over batches of 1000, calling each window's
+    // current WndProc as the system would.
+    uint64_t Time(FakeWindowSystem& sys, const std::vector<Message>& messages) {
+        std::vector<WNDPROC> procs;
+        for (const Message& m : messages) procs.push_back((WNDPROC)sys.Peek(m.hwnd, GWLP_WNDPROC));
+        std::vector<uint64_t> samples;
+        for (size_t begin = 0; begin + 1000 <= messages.size(); begin += 1000) {
+            uint64_t t0 = Bench::NowNs();
+            for (size_t i = begin; i < begin + 1000; ++i) procs[i](messages[i].hwnd, messages[i].msg, 0, 0);
+            samples.push_back((Bench::NowNs() - t0) / 1000);
+        }
+        return Bench::Summarize(samples).p50;
+    }
+
+    std::vector<Message> Repeat(const std::vector<HWND>& windows, UINT msg, size_t count) {
+        std::vector<Message> out;
+        for (size_t i = 0; i < count; ++i) out.push_back({ windows[(i / 8) % windows.size()], msg });
+        return out;
+    }
+
+    std::vector<Message> Forwarded(const std::vector<HWND>& windows, size_t count) {
+        std::vector<Message> out;
+        for (size_t i = 0; i < count; ++i) out.push_back({ windows[(i / 8) % windows.size()], kForwarded[i % 6] });
+        return out;
+    }
+
+    // Back-to-back compactions of a small table while reader threads look
+    // up entries that never leave it. A miss means a reader was still
+    // inside an array the writer had already handed back and rewritten;
+    // HookProc would then send the message to DefProc.
+    uint64_t CompactionMisses(int readers, uint64_t compactions, uint64_t& lookups) {
+        ProcTable table(16);
+        HWND keys[4];
+        for (size_t i = 0; i < 4; ++i) {
+            keys[i] = (HWND)(uintptr_t)(0x20000 + i * 4);
+            table.Set(keys[i], (WNDPROC)LegacyHook);
+        }
+        std::atomic<bool> stop{ false };
+        std::atomic<uint64_t> misses{ 0 }, done{ 0 };
+        std::vector<std::thread> pool;
+        for (int r = 0; r < readers; ++r) {
+            pool.emplace_back([&, r] {
+                uint64_t n = 0, missed = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    missed += table.Find(keys[(n + r) & 3]) != (WNDPROC)LegacyHook;
+                    ++n;
+                }
+                misses.fetch_add(missed);
+                done.fetch_add(n);
+            });
+        }
+        for (uint64_t i = 0; i < compactions; ++i) table.Compact();
+        stop = true;
+        for (std::thread& t : pool) t.join();
+        lookups = done.load();
+        return misses.load();
+    }
+}
+
+int main(int argc, char** argv) {
+    int children = (int)Bench::ArgInt(argc, argv, "--children", 64);
+    size_t count = (size_t)Bench::ArgInt(argc, argv, "--messages", 400000);
+    if (children < 1) children = 1;
+    uint64_t compactions = (uint64_t)Bench::ArgInt(argc, argv, "--compactions", 200000);
+    if (count < 1000) count = 1000;
+
+    FakeWindowSystem sys;
+    g_WindowSystem = &sys;
+    Bench::Scene scene = Bench::BuildScene(sys, 100, children);
+    g_Settings.SetPassthrough(true);
+    WorkerState state;
+    WorkerTick(state, 0);
+    WorkerTick(state, 10);
+
+    // The legacy hook on a second LS window, every window subclassed.
+    Bench::Session legacy = Bench::AddSession(sys, children, 3100);
+    std::vector<HWND> legacyWindows = legacy.lsChildren;
+    legacyWindows.insert(legacyWindows.begin(), legacy.lsWindow);
+    for (HWND hwnd : legacyWindows) {
+        g_LegacyProcs.Set(hwnd, (WNDPROC)sys.Peek(hwnd, GWLP_WNDPROC));
+        sys.SetLong(hwnd, GWLP_WNDPROC, (LONG_PTR)LegacyHook);
+    }
+
+    std::vector<HWND> windows = scene.lsChildren;
+    windows.insert(windows.begin(), scene.lsWindow);
+    WNDPROC hook = (WNDPROC)sys.Peek(scene.lsWindow, GWLP_WNDPROC);
+    size_t subclassed = 0;
+    for (HWND hwnd : windows) subclassed += (WNDPROC)sys.Peek(hwnd, GWLP_WNDPROC) == hook;
+    printf("bench_hookproc: %d LS children, %zu messages per case\n", children, count);
+    printf("subclassed windows     %zu of %zu\n", subclassed, windows.size());
+
+    // Same answers from both hooks.
+    int failures = 0;
+    for (UINT msg : { (UINT)WM_SETCURSOR, (UINT)WM_MOUSEMOVE, (UINT)WM_NCHITTEST, (UINT)0x000F }) {
+        if (hook(scene.lsWindow, msg, 0, 0) != LegacyHook(legacy.lsWindow, msg, 0, 0)) ++failures;
+    }
+
+    // Every LS window runs the hook, so hit-testing is fixed on all of them.
+    if (subclassed != windows.size()) ++failures;
+
+    struct Case {
+        const char* name;
+        std::vector<Message> current, previous;
+    };
+    Case cases[] = {
+        { "forwarded", Forwarded(windows, count), Forwarded(legacyWindows, count) },
+        { "WM_MOUSEMOVE", Repeat(windows, WM_MOUSEMOVE, count), Repeat(legacyWindows, WM_MOUSEMOVE, count) },
+        { "WM_SETCURSOR", Repeat(windows, WM_SETCURSOR, count), Repeat(legacyWindows, WM_SETCURSOR, count) },
+        { "WM_NCHITTEST", Repeat(windows, WM_NCHITTEST, count), Repeat(legacyWindows, WM_NCHITTEST, count) },
+        { "mix", Mix(windows, count), Mix(legacyWindows, count) },
+    };
+    printf("%-22s %10s %10s\n", "ns/message", "HookProc", "legacy");
+    for (Case& c : cases) {
+        uint64_t current = Time(sys, c.current);
+        uint64_t previous = Time(sys, c.previous);
+        printf("%-22s %10llu %10llu\n", c.name, (unsigned long long)current, (unsigned long long)previous);
+    }
+
+    uint64_t lookups = 0;
+    uint64_t misses = CompactionMisses(2, compactions, lookups);
+    printf("compaction stress      %llu compactions, %llu lookups, %llu misses\n", (unsigned long long)compactions,
+           (unsigned long long)lookups, (unsigned long long)misses);
+    if (misses) ++failures;
+
+    for (HWND hwnd : legacyWindows) sys.SetLong(hwnd, GWLP_WNDPROC, (LONG_PTR)g_LegacyProcs.Find(hwnd));
+    g_Settings.SetPassthrough(false);
+    WindowManager::RestoreAll();
+    printf("failures               %d\n", failures);
+    return failures ? 1 : 0;
+}
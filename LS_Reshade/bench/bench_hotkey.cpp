@@ -0,0 +1,280 @@
+// Compares hotkey detection driven by key events with the IsKeyDown polling
+// fallback. The worker loop runs on a virtual clock: it sleeps until
+// WorkerNextWake, and in event mode a key event wakes it early, as the
+// keyboard hook does on Windows.
+//
+//   bench_hotkey [--presses N] [--seed S]
+//
+// Reported per mode: press-to-toggle latency, presses seen, timer wakeups
+// per second while passthrough is off, and IsKeyDown calls per idle second. A chord
+// sequence, an injected event stream, press-to-bind capture and keys injected by
+// another program (which fire, unlike our own tagged input) are checked first.
+// A third run loses the key watch halfway, as when Windows removes a hook
+// that timed out, and must keep toggling by polling.
+#include "bench_common.hpp"
+#include "hotkey_engine.hpp"
+#include "worker.hpp"
+#include "window_manager.hpp"
+#include "focus_resolver.hpp"
+#include "settings.hpp"
+#include <random>
+
+namespace {
+    struct Input {
+        uint64_t at;
+        bool down;
+    };
+
+    struct Result {
+        std::vector<uint64_t> latencyMs;
+        uint64_t idleMs = 0;
+        uint64_t idleWakeups = 0;
+        uint64_t idleKeyPolls = 0;
+        size_t seenAfterLoss = 0;
+    };
+
+    // Ctrl+K then Ctrl+T, fed as an event stream with no worker involved.
+    bool CheckChords(FakeWindowSystem& sys) {
+        g_WindowSystem = &sys;
+        HotkeyEngine engine;
+        HotkeyBinding binding;
+        binding.chords[0] = { 'K', HotkeyChord::ModCtrl };
+        binding.chords[1] = { 'T', HotkeyChord::ModCtrl };
+        binding.length = 2;
+        binding.action = HotkeyTogglePassthrough;
+        engine.SetBindings(&binding, 1);
+
+        HotkeyAction action;
+        auto chord = [&](WORD vk, uint64_t at, bool injected) {
+            engine.Update(at);
+            engine.OnKey(VK_LCONTROL, true, injected);
+            engine.OnKey(vk, true, injected);
+            engine.OnKey(vk, false, injected);
+            engine.OnKey(VK_LCONTROL, false, injected);
+        };
+        chord('K', 0, false);
+        if (engine.PopAction(action)) return false;   // half a sequence
+        chord('T', 300, false);
+        if (!engine.PopAction(action)) return false;  // complete
+        chord('K', 1000, false);
+        chord('T', 2500, false);                      // too late
+        if (engine.PopAction(action)) return false;
+        chord('K', 3000, true);
+        chord('T', 3100, true);                       // synthetic input
+        return !engine.PopAction(action);
+    }
+
+    // Press-to-bind from key events and from the poller; the bound key must
+    // not fire while a capture takes it.
+    bool CheckCapture(FakeWindowSystem& sys) {
+        g_WindowSystem = &sys;
+        HotkeyEngine engine;
+        HotkeyBinding binding;
+        binding.chords[0] = { VK_HOME, 0 };
+        binding.length = 1;
+        binding.action = HotkeyTogglePassthrough;
+        engine.SetBindings(&binding, 1);
+
+        HotkeyChord chord;
+        HotkeyAction action;
+        engine.BeginCapture();
+        engine.OnKey(VK_LCONTROL, true, false);
+        engine.OnKey(VK_RMENU, true, false);                  // modifiers alone do not end it
+        if (engine.PollCapture(chord) != HotkeyEngine::CaptureWaiting) return false;
+        engine.OnKey('Q', true, true);                        // injected: ignored
+        engine.OnKey('Q', true, false);
+        engine.OnKey('Q', false, false);
+        engine.OnKey(VK_RMENU, false, false);
+        engine.OnKey(VK_LCONTROL, false, false);
+        if (engine.PollCapture(chord) != HotkeyEngine::CaptureDone) return false;
+        if (chord.vk != 'Q' || chord.mods != (HotkeyChord::ModCtrl | HotkeyChord::ModAlt)) return false;
+        if (engine.PollCapture(chord) != HotkeyEngine::CaptureIdle) return false;
+
+        engine.BeginCapture();
+        engine.OnKey(VK_HOME, true, false);                   // taken by the capture
+        engine.OnKey(VK_HOME, false, false);
+        if (engine.PopAction(action)) return false;
+        if (engine.PollCapture(chord) != HotkeyEngine::CaptureDone || chord.vk != VK_HOME) return false;
+        engine.BeginCapture();
+        engine.OnKey(VK_ESCAPE, true, false);
+        if (engine.PollCapture(chord) != HotkeyEngine::CaptureCancelled) return false;
+
+        // The poller samples every bindable key only while a capture waits.
+        engine.Start(false);
+        engine.Update(0);
+        uint64_t idlePolls = engine.GetStats().polls;
+        engine.BeginCapture();
+        sys.SetKey(VK_F1 + 6, true);
+        engine.Update(10);
+        uint64_t capturePolls = engine.GetStats().polls - idlePolls;
+        sys.SetKey(VK_F1 + 6, false);
+        engine.Update(20);
+        engine.Stop();
+        if (engine.PollCapture(chord) != HotkeyEngine::CaptureDone || chord.vk != VK_F1 + 6) return false;
+        printf("capture               events and polling ok; %llu IsKeyDown per polled capture tick, %llu idle\n",
+               (unsigned long long)capturePolls, (unsigned long long)idlePolls);
+        return true;
+    }
+
+    // Through the key watch: a key another program injects (a macro tool's
+    // SendInput, untagged) fires the binding; our own tagged repress of the
+    // same key does not.
+    bool CheckForeignInput(FakeWindowSystem& sys) {
+        g_WindowSystem = &sys;
+        HotkeyEngine engine;
+        HotkeyBinding binding;
+        binding.chords[0] = { VK_HOME, 0 };
+        binding.length = 1;
+        binding.action = HotkeyTogglePassthrough;
+        engine.SetBindings(&binding, 1);
+        engine.Start(true);
+        if (!engine.EventDriven()) return false;
+
+        HotkeyAction action;
+        engine.Update(0);
+        sys.InjectKey(VK_HOME, true, 0x1234);
+        sys.InjectKey(VK_HOME, false, 0x1234);
+        sys.PumpEvents();
+        bool foreignFired = engine.PopAction(action);
+
+        InputEvent repress[2];
+        repress[0].vk = VK_HOME;
+        repress[1].vk = VK_HOME;
+        repress[1].flags = KEYEVENTF_KEYUP;
+        engine.Update(100);
+        sys.SendInputs(repress, 2);
+        sys.PumpEvents();
+        bool ownFired = engine.PopAction(action);
+        uint64_t ignored = engine.GetStats().injected;
+        engine.Stop();
+        return foreignFired && !ownFired && ignored == 2;
+    }
+
+    Result Run(bool events, const std::vector<Input>& inputs, size_t loseAt = SIZE_MAX) {
+        FakeWindowSystem sys;
+        g_WindowSystem = &sys;
+        Bench::BuildScene(sys, 64, 8);
+        g_FocusResolver.Start();
+        g_Hotkeys.Start(events);
+        g_Settings.SetPassthrough(false);
+
+        Result r;
+        WorkerState state;
+        uint64_t now = 0;
+        bool active = WorkerTick(state, now);
+        bool expected = false;
+        uint64_t pressedAt = 0;
+
+        auto tick = [&](uint64_t at, bool byEvent) {
+            bool wasActive = active;
+            uint64_t polls = sys.Count(FakeWindowSystem::ApiIsKeyDown);
+            if (!wasActive) r.idleMs += at - now;
+            now = at;
+            active = WorkerTick(state, now);
+            if (!wasActive && !byEvent) {
+                ++r.idleWakeups;
+                r.idleKeyPolls += sys.Count(FakeWindowSystem::ApiIsKeyDown) - polls;
+            }
+            if (g_Settings.Read().inputPassthrough == expected) {
+                r.latencyMs.push_back(now - pressedAt);
+                expected = !expected;
+            }
+        };
+
+        expected = true;
+        size_t seenBeforeLoss = 0;
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            const Input& in = inputs[i];
+            for (;;) {
+                uint64_t wake = WorkerNextWake(now, active);
+                if (wake > in.at) break;
+                tick(wake, false);
+            }
+            if (i == loseAt) {
+                seenBeforeLoss = r.latencyMs.size();
+                sys.LoseKeyWatch();
+                tick(in.at, true); // the backend wakes the worker
+            }
+            sys.SetKey(VK_HOME, in.down);
+            if (in.down) pressedAt = in.at;
+            if (events && sys.PendingKeyEvents()) tick(in.at, true); // the event wakes the worker
+        }
+        // Let the last press be seen.
+        uint64_t wake = WorkerNextWake(now, active);
+        if (wake != kWorkerIdle) tick(wake, false);
+        if (loseAt < inputs.size()) r.seenAfterLoss = r.latencyMs.size() - seenBeforeLoss;
+
+        g_Hotkeys.Stop();
+        g_FocusResolver.Stop();
+        WindowManager::RestoreAll();
+        return r;
+    }
+
+    void Print(const char* label, const Result& r, int presses) {
+        Bench::Summary s = Bench::Summarize(r.latencyMs);
+        double idleSec = r.idleMs / 1000.0;
+        printf("%s\n", label);
+        printf("  press-to-toggle ms   p50 %llu  p99 %llu  max %llu  (%zu of %d presses seen)\n",
+               (unsigned long long)s.p50, (unsigned long long)s.p99, (unsigned long long)s.max, r.latencyMs.size(), presses);
+        printf("  timer wakeups/sec    %.2f  (passthrough off)\n", idleSec > 0 ? r.idleWakeups / idleSec : 0.0);
+        printf("  idle IsKeyDown/sec   %.2f\n", idleSec > 0 ? r.idleKeyPolls / idleSec : 0.0);
+    }
+}
+
+int main(int argc, char** argv) {
+    const int presses = (int)Bench::ArgInt(argc, argv, "--presses", 200);
+    const unsigned seed = (unsigned)Bench::ArgInt(argc, argv, "--seed", 1);
+
+    {
+        FakeWindowSystem sys;
+        if (!CheckChords(sys)) {
+            printf("error: chord sequence or injected-input filtering misbehaved\n");
+            return 1;
+        }
+        if (!CheckCapture(sys)) {
+            printf("error: press-to-bind capture misbehaved\n");
+            return 1;
+        }
+        if (!CheckForeignInput(sys)) {
+            printf("error: a foreign injected key was ignored or our own repress fired\n");
+            return 1;
+        }
+    }
+
+    SettingsValues config;
+    config.autoClickRepress = false;
+    config.hotkeyVk = VK_HOME;
+    g_Settings.SetValues(config);
+
+    // Presses 0.5-3 s apart, held 30-150 ms.
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> gap(500, 3000);
+    std::uniform_int_distribution<int> hold(30, 150);
+    std::vector<Input> inputs;
+    uint64_t t = 1000;
+    for (int i = 0; i < presses; ++i) {
+        t += gap(rng);
+        inputs.push_back({ t, true });
+        inputs.push_back({ t + hold(rng), false });
+    }
+
+    printf("bench_hotkey: %d presses over %.0f s of virtual time\n", presses, t / 1000.0);
+    Result polled = Run(false, inputs);
+    Result evented = Run(true, inputs);
+    Result lost = Run(true, inputs, (size_t)presses); // a press-release pair per two inputs
+    Print("polling (fallback)", polled, presses);
+    Print("key events", evented, presses);
+    Print("key events, hook lost halfway", lost, presses);
+    printf("  presses seen after   %zu of %d (polling)\n", lost.seenAfterLoss, presses - presses / 2);
+    // Polling can miss a tap that starts and ends between two polls; events cannot.
+    if (evented.latencyMs.size() != (size_t)presses) {
+        printf("error: toggles were missed\n");
+        return 1;
+    }
+    // After the loss it is the poller's job, with the poller's misses.
+    if (lost.seenAfterLoss * presses * 10 < (size_t)(presses - presses / 2) * polled.latencyMs.size() * 9) {
+        printf("error: hotkey stopped firing after the key watch was lost\n");
+        return 1;
+    }
+    return 0;
+}
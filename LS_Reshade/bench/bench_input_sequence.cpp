@@ -0,0 +1,138 @@
+// Drives WorkerTick on a virtual 1 ms clock with auto click & repress on and
+// reports the synthetic input timeline, the toggle latency against the old
+// fixed delays, SendInputs batching, and what a storm of hotkey toggles does
+// to in-flight sequences.
+//
+//   bench_input_sequence [--toggles N] [--seed S] [--hold MS]
+//
+// The hotkey is Ctrl+Alt+Home so the repress batches three keys.
+#include "bench_common.hpp"
+#include "worker.hpp"
+#include "input_scheduler.hpp"
+#include "input_sim.hpp"
+#include "focus_resolver.hpp"
+#include "settings.hpp"
+#include <random>
+
+namespace {
+    void PressHotkey(FakeWindowSystem& sys, bool down) {
+        sys.SetKey(VK_CONTROL, down);
+        sys.SetKey(VK_MENU, down);
+        sys.SetKey(VK_HOME, down);
+    }
+
+    bool AnyKeyHeld(FakeWindowSystem& sys) {
+        for (int vk = 0; vk < 256; ++vk) {
+            if (sys.IsKeyDown(vk)) return true;
+        }
+        return false;
+    }
+
+    const char* Describe(const InputEvent& ev) {
+        static char text[32];
+        if (ev.type == InputEvent::Mouse) return ev.flags & MOUSEEVENTF_LEFTDOWN ? "mouse down" : "mouse up";
+        snprintf(text, sizeof(text), "vk %02x %s", ev.vk, ev.flags & KEYEVENTF_KEYUP ? "up" : "down");
+        return text;
+    }
+}
+
+int main(int argc, char** argv) {
+    const int toggles = (int)Bench::ArgInt(argc, argv, "--toggles", 2000);
+    const unsigned seed = (unsigned)Bench::ArgInt(argc, argv, "--seed", 1);
+    const int hold = (int)Bench::ArgInt(argc, argv, "--hold", 40);
+
+    FakeWindowSystem sys;
+    g_WindowSystem = &sys;
+    Bench::Scene scene = Bench::BuildScene(sys, 16, 4);
+    g_FocusResolver.Start();
+    SettingsValues config;
+    config.autoClickRepress = true;
+    config.hotkeyCtrl = true;
+    config.hotkeyAlt = true;
+    config.hotkeyVk = VK_HOME;
+    g_Settings.SetValues(config);
+
+    WorkerState state;
+    uint64_t now = 1;
+
+    // --- One toggle each way, end to end ---
+    // The user is in the game, presses the hotkey and holds it for --hold ms.
+    sys.Focus(scene.target);
+    for (int pass = 0; pass < 2; ++pass) {
+        const bool on = pass == 0;
+        printf("%stoggle %s (user holds the hotkey for %d ms)\n", pass ? "\n" : "bench_input_sequence: ", on ? "ON" : "OFF", hold);
+        sys.TakeSentInputs();
+        sys.ResetCounters();
+        InputScheduler::Stats before = g_InputScheduler.GetStats();
+        PressHotkey(sys, true);
+        uint64_t pressedAt = now;
+        while (g_InputScheduler.NextDue() != InputScheduler::kIdle || now <= pressedAt + hold) {
+            if (now == pressedAt + hold) PressHotkey(sys, false);
+            WorkerTick(state, now);
+            for (const InputEvent& ev : sys.TakeSentInputs()) {
+                printf("  t+%4llu ms  %s\n", (unsigned long long)(now - pressedAt), Describe(ev));
+            }
+            ++now;
+        }
+        InputScheduler::Stats after = g_InputScheduler.GetStats();
+        printf("toggle latency        %llu ms (fixed delays: %u ms), %llu step timeouts\n",
+               (unsigned long long)after.lastMs, on ? InputSim::kFixedDelayOnMs : InputSim::kFixedDelayOffMs,
+               (unsigned long long)(after.timeouts - before.timeouts));
+        printf("SendInputs calls      %llu for %llu events (one call per event before)\n",
+               (unsigned long long)sys.Count(FakeWindowSystem::ApiSendInputs), (unsigned long long)(after.events - before.events));
+        if (g_Settings.Read().inputPassthrough != on) {
+            printf("error: passthrough did not end up %s\n", on ? "ON" : "OFF");
+            return 1;
+        }
+        if (AnyKeyHeld(sys)) {
+            printf("error: keys left down after the sequence\n");
+            return 1;
+        }
+        for (uint64_t end = now + 100; now < end; ++now) WorkerTick(state, now);
+    }
+    InputScheduler::Stats single = g_InputScheduler.GetStats();
+
+    // --- Toggle storm ---
+    // Presses arrive 20..700 ms apart, so many land while a sequence is still
+    // running. Each accepted toggle must cancel the previous sequence cleanly.
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> gap(20, 700);
+    int accepted = 0;
+    bool lastPassthrough = g_Settings.Read().inputPassthrough;
+    std::vector<uint64_t> samples;
+    for (int i = 0; i < toggles; ++i) {
+        uint64_t next = now + gap(rng);
+        uint64_t release = now + 30;
+        PressHotkey(sys, true);
+        for (; now < next; ++now) {
+            if (now == release) PressHotkey(sys, false);
+            uint64_t t = Bench::NowNs();
+            WorkerTick(state, now);
+            samples.push_back(Bench::NowNs() - t);
+            bool passthrough = g_Settings.Read().inputPassthrough;
+            if (passthrough != lastPassthrough) {
+                lastPassthrough = passthrough;
+                ++accepted;
+            }
+        }
+        sys.TakeSentInputs();
+    }
+    while (g_InputScheduler.NextDue() != InputScheduler::kIdle) WorkerTick(state, now++);
+
+    InputScheduler::Stats storm = g_InputScheduler.GetStats();
+    printf("\ntoggle storm: %d presses, %d accepted (the rest hit a guarded repress or had no valid focus)\n", toggles, accepted);
+    printf("sequences             %llu started, %llu cancelled mid-flight\n",
+           (unsigned long long)(storm.sequences - single.sequences), (unsigned long long)(storm.cancelled - single.cancelled));
+    printf("events/batch          %.2f\n", (double)(storm.events - single.events) / (storm.batches - single.batches));
+    uint64_t completed = storm.completed - single.completed;
+    if (completed) printf("mean toggle latency   %.1f ms over %llu completed sequences\n",
+                          (double)(storm.totalMs - single.totalMs) / completed, (unsigned long long)completed);
+    Bench::PrintSummary("tick ns", Bench::Summarize(samples));
+    if (AnyKeyHeld(sys)) {
+        printf("error: keys left down after the storm\n");
+        return 1;
+    }
+
+    g_FocusResolver.Stop();
+    return 0;
+}
@@ -0,0 +1,150 @@
+// Restore journal: the cost of an append to the mapped file, that a torn
+// last record is dropped on reopen, a simulated crash mid-passthrough (the
+// journal is left behind and the next load must put the LS windows back),
+// the O(changed) RestoreAll, and startup with a large stale journal.
+//
+//   bench_journal [--children N] [--records N]
+#include "bench_common.hpp"
+#include "restore_journal.hpp"
+#include "window_manager.hpp"
+#include "focus_resolver.hpp"
+#include "settings.hpp"
+#include "worker.hpp"
+#include <filesystem>
+#include <fstream>
+
+namespace {
+    std::filesystem::path TempJournal(const char* name) {
+        std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+        std::filesystem::remove(path);
+        return path;
+    }
+
+    // Whether every LS window has its original styles and proc again.
+    bool Restored(FakeWindowSystem& sys, const Bench::Scene& scene) {
+        if (sys.Peek(scene.lsWindow, GWL_EXSTYLE) != (WS_EX_LAYERED | WS_EX_TRANSPARENT | WS_EX_NOACTIVATE)) return false;
+        for (size_t i = 0; i < scene.lsChildren.size(); ++i) {
+            HWND hwnd = scene.lsChildren[i];
+            if (sys.Peek(hwnd, GWL_EXSTYLE) != ((i % 8 == 0) ? WS_EX_LAYERED : 0)) return false;
+            if (sys.Peek(hwnd, GWLP_WNDPROC) != (LONG_PTR)FakeWindowSystem::DefaultProc) return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    const int children = (int)Bench::ArgInt(argc, argv, "--children", 400);
+    const int records = (int)Bench::ArgInt(argc, argv, "--records", 200000);
+    int failures = 0;
+
+    // 1. Appends, and a torn append on reopen.
+    {
+        std::filesystem::path path = TempJournal("bench_journal_append.journal");
+        RestoreJournal journal;
+        journal.Open(path.wstring());
+        journal.Reset({ 1, 0 });
+        uint64_t t = Bench::NowNs();
+        for (int i = 0; i < records; ++i) journal.RecordRestyled((HWND)(uintptr_t)(0x10000 + i * 4), i, i);
+        uint64_t ns = Bench::NowNs() - t;
+        journal.Close();
+
+        // A crash halfway through the next record: fields written, no checksum.
+        {
+            std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+            file.seekp((std::streamoff)(RestoreJournal::kHeaderSize + (size_t)records * RestoreJournal::kRecordSize));
+            const char junk[20] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20 };
+            file.write(junk, sizeof(junk));
+        }
+        journal.Open(path.wstring());
+        size_t kept = journal.Records();
+        printf("append                %.1f ns per record (%d records, %.1f MB mapped)\n", (double)ns / records, records,
+               (RestoreJournal::kHeaderSize + (double)records * RestoreJournal::kRecordSize) / 1e6);
+        printf("torn append           %zu of %d records kept after reopen\n", kept, records);
+        if (kept != (size_t)records) ++failures;
+        journal.Close();
+        std::filesystem::remove(path);
+    }
+
+    FakeWindowSystem sys;
+    g_WindowSystem = &sys;
+    Bench::Scene scene = Bench::BuildScene(sys, 32, children);
+    sys.Focus(scene.target);
+    g_FocusResolver.Start();
+    SettingsValues config;
+    config.autoClickRepress = false;
+    g_Settings.SetValues(config);
+    std::filesystem::path path = TempJournal("bench_journal_session.journal");
+
+    // 2. Crash mid-passthrough, then the next load in the same process.
+    {
+        WindowManager::OpenJournal(path.wstring());
+        g_Settings.SetPassthrough(true);
+        WorkerState state;
+        WorkerTick(state, 0);
+        size_t journaled = g_Journal.Records();
+        if (Restored(sys, scene)) {
+            printf("error: passthrough did not change the LS windows\n");
+            return 1;
+        }
+        g_Journal.Close(); // the process "dies": nothing restored, file left as is
+
+        uint64_t t = Bench::NowNs();
+        WindowManager::OpenJournal(path.wstring());
+        uint64_t ns = Bench::NowNs() - t;
+        bool ok = Restored(sys, scene);
+        printf("crash recovery        %.1f us to replay %zu records for %d windows, windows %s\n", ns / 1e3,
+               journaled, children + 1, ok ? "restored" : "NOT restored");
+        if (!ok) ++failures;
+        g_Settings.SetPassthrough(false);
+        WindowManager::RestoreAll();
+    }
+
+    // 3. RestoreAll from the journal, with a quarter of the children gone.
+    {
+        g_Settings.SetPassthrough(true);
+        WorkerState state;
+        WorkerTick(state, 0);
+        for (size_t i = 0; i < scene.lsChildren.size(); i += 4) sys.RemoveWindow(scene.lsChildren[i]);
+        WorkerTick(state, 10);
+        std::vector<HWND> alive;
+        for (size_t i = 0; i < scene.lsChildren.size(); ++i) {
+            if (i % 4) alive.push_back(scene.lsChildren[i]);
+        }
+        size_t pending = g_Journal.Pending().size();
+        g_Settings.SetPassthrough(false);
+        uint64_t t = Bench::NowNs();
+        WindowManager::RestoreAll();
+        uint64_t ns = Bench::NowNs() - t;
+        bool ok = true;
+        for (HWND hwnd : alive) ok &= sys.Peek(hwnd, GWLP_WNDPROC) == (LONG_PTR)FakeWindowSystem::DefaultProc;
+        printf("RestoreAll            %.1f us for %zu journaled windows (%zu released), %s\n", ns / 1e3, pending,
+               scene.lsChildren.size() - alive.size(), ok ? "restored" : "NOT restored");
+        if (!ok || g_Journal.Records() != 0) ++failures;
+    }
+    g_Journal.Close();
+
+    // 4. Startup: an empty journal, and a large one left by a dead process.
+    {
+        uint64_t t = Bench::NowNs();
+        WindowManager::OpenJournal(path.wstring());
+        uint64_t emptyNs = Bench::NowNs() - t;
+        g_Journal.Close();
+
+        RestoreJournal old;
+        old.Open(path.wstring());
+        old.Reset({ sys.CurrentProcessId() + 1, 0 });
+        for (int i = 0; i < records; ++i) old.RecordSubclassed((HWND)(uintptr_t)(0x10000 + i * 4), nullptr);
+        old.Close();
+        t = Bench::NowNs();
+        WindowManager::OpenJournal(path.wstring());
+        uint64_t staleNs = Bench::NowNs() - t;
+        printf("startup               %.1f us with a clean journal, %.1f ms discarding %d stale records\n",
+               emptyNs / 1e3, staleNs / 1e6, records);
+        if (g_Journal.Records() != 0) ++failures;
+        g_Journal.Close();
+    }
+
+    std::filesystem::remove(path);
+    g_FocusResolver.Stop();
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,116 @@
+// Per-call Log() latency with several threads logging at once: the previous
+// synchronous logger (mutex, std::endl, flush per line) versus the async
+// ring-buffer Logger. Each thread logs in bursts of --burst messages and
+// between bursts sleeps for a millisecond, and on until the ring is at most
+// half full, so all threads together stay under the ring size and every
+// async record is accepted (checked): the latency is that of logging, not of
+// the ring-full drop path. A last run without pauses reports
+// only how many records the ring drops under a flood.
+//
+//   bench_logger [--threads T] [--messages M] [--burst B]
+#include "bench_common.hpp"
+#include "logger.hpp"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+namespace {
+    // The pre-ring Logger, kept here as the baseline.
+    struct SyncLogger {
+        std::ofstream file;
+        std::mutex mutex;
+
+        void Log(const std::string& message) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (file.is_open()) {
+                file << message << std::endl;
+                file.flush();
+            }
+        }
+    };
+
+    SyncLogger g_Sync;
+
+    void SyncLog(int thread, int i) {
+        char buffer[1024];
+        snprintf(buffer, sizeof(buffer), "worker %d: processed window %d style %08x", thread, i, i * 7);
+        g_Sync.Log(std::string(buffer));
+    }
+
+    void AsyncLog(int thread, int i) {
+        LOG_INFO("worker %d: processed window %d style %08x", thread, i, i * 7);
+    }
+
+    template<typename Fn>
+    void Run(const char* label, int threads, int messages, int burst, Fn fn) {
+        std::vector<std::vector<uint64_t>> perThread(threads);
+        std::vector<std::thread> pool;
+        uint64_t start = Bench::NowNs();
+        for (int t = 0; t < threads; ++t) {
+            pool.emplace_back([&, t] {
+                std::vector<uint64_t>& samples = perThread[t];
+                samples.reserve(messages);
+                for (int i = 0; i < messages; ++i) {
+                    if (burst && i && i % burst == 0) {
+                        do {
+                            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                        } while (Logger::Pending() > Logger::kRingRecords / 2);
+                    }
+                    uint64_t t0 = Bench::NowNs();
+                    fn(t, i);
+                    samples.push_back(Bench::NowNs() - t0);
+                }
+            });
+        }
+        for (auto& th : pool) th.join();
+        uint64_t elapsed = Bench::NowNs() - start;
+
+        std::vector<uint64_t> all;
+        for (auto& s : perThread) all.insert(all.end(), s.begin(), s.end());
+        printf("%s\n", label);
+        if (burst) {
+            Bench::PrintSummary("  call ns", Bench::Summarize(all));
+        } else {
+            printf("  calls/sec            %.0f\n", all.size() / (elapsed / 1e9));
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    const int threads = (int)Bench::ArgInt(argc, argv, "--threads", 4);
+    const int messages = (int)Bench::ArgInt(argc, argv, "--messages", 50000);
+    int burst = (int)Bench::ArgInt(argc, argv, "--burst", 64);
+    if (burst < 1) burst = 1;
+    std::filesystem::path dir = std::filesystem::temp_directory_path();
+
+    printf("bench_logger: %d threads x %d messages, bursts of %d\n", threads, messages, burst);
+
+    g_Sync.file.open(dir / "bench_logger_sync.log", std::ios::out | std::ios::trunc);
+    Run("sync (mutex + endl + flush)", threads, messages, burst, SyncLog);
+    g_Sync.file.close();
+
+    Logger::Init((dir / "bench_logger_async.log").wstring());
+    Run("async (MPSC ring + writer thread)", threads, messages, burst, AsyncLog);
+    const uint64_t paced = Logger::Dropped();
+    printf("  dropped              %llu\n", (unsigned long long)paced);
+
+    Run("async flood (no pauses)", threads, messages, 0, AsyncLog);
+    const uint64_t flooded = Logger::Dropped() - paced;
+    uint64_t closeStart = Bench::NowNs();
+    Logger::Close();
+    printf("  dropped              %llu of %llu   close+drain %.2f ms\n", (unsigned long long)flooded,
+           (unsigned long long)threads * messages, (Bench::NowNs() - closeStart) / 1e6);
+
+    int failures = 0;
+    if ((size_t)threads * burst > Logger::kRingRecords / 2) {
+        printf("note: %d threads x bursts of %d exceed half the ring (%zu); drops are expected\n",
+               threads, burst, Logger::kRingRecords);
+    } else if (paced) {
+        printf("FAILED: records dropped with the bursts under the ring size\n");
+        ++failures;
+    }
+    printf("failures               %d\n", failures);
+    return failures ? 1 : 0;
+}
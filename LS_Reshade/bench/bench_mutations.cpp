@@ -0,0 +1,157 @@
+// Worker time spent changing LS windows that belong to LS's UI thread. The
+// per-window SetWindowLongPtr / SetWindowPos calls the worker used to make
+// each wait for that thread; batched mutations are posted to it instead and
+// applied there. Cross-thread sends cost --send-us each (a responsive owner;
+// a busy one is far slower). A second thread plays the owner's message loop.
+// Last, the owner hangs: the flusher must give up on its batch without
+// making the style change itself, and only put the window procedure back.
+//
+//   bench_mutations [--children N] [--send-us US] [--rounds R]
+#include "bench_common.hpp"
+#include "window_manager.hpp"
+#include "window_mutations.hpp"
+#include "focus_resolver.hpp"
+#include "settings.hpp"
+#include "worker.hpp"
+#include <atomic>
+#include <thread>
+
+namespace {
+    // The pre-batching style fix, kept here as the baseline: three
+    // cross-thread calls per restyled window, made by the worker.
+    void LegacyPass(FakeWindowSystem& sys, const Bench::Scene& scene) {
+        std::vector<HWND> windows = scene.lsChildren;
+        windows.insert(windows.begin(), scene.lsWindow);
+        for (HWND hwnd : windows) {
+            LONG_PTR exStyle = sys.GetLong(hwnd, GWL_EXSTYLE);
+            LONG_PTR style = sys.GetLong(hwnd, GWL_STYLE);
+            LONG_PTR newExStyle = exStyle & ~(WS_EX_TRANSPARENT | WS_EX_NOACTIVATE | WS_EX_LAYERED);
+            if (newExStyle == exStyle) continue;
+            sys.SetLong(hwnd, GWL_EXSTYLE, newExStyle);
+            sys.SetLong(hwnd, GWL_STYLE, style);
+            sys.SetPos(hwnd, NULL, SWP_NOMOVE | SWP_NOSIZE | SWP_FRAMECHANGED | SWP_NOZORDER);
+        }
+    }
+
+    // Restores the scene's styles without counting, for the next round.
+    void Relayer(FakeWindowSystem& sys, const Bench::Scene& scene) {
+        sys.SetCrossThreadCost(0);
+        sys.SetLong(scene.lsWindow, GWL_EXSTYLE, WS_EX_LAYERED | WS_EX_TRANSPARENT | WS_EX_NOACTIVATE);
+        for (size_t i = 0; i < scene.lsChildren.size(); ++i) {
+            if (i % 8 == 0) sys.SetLong(scene.lsChildren[i], GWL_EXSTYLE, WS_EX_LAYERED);
+        }
+    }
+
+    LRESULT CALLBACK ProbeProc(HWND, UINT, WPARAM, LPARAM) { return 0; }
+
+    // Nothing delivers posted wakes any more: the owner is hung.
+    bool CheckHungOwner(FakeWindowSystem& sys, HWND hwnd) {
+        MutationDispatcher dispatcher;
+        const LONG_PTR exStyle = sys.Peek(hwnd, GWL_EXSTYLE);
+        const LONG_PTR proc = sys.Peek(hwnd, GWLP_WNDPROC);
+        WindowMutation m;
+        m.hwnd = hwnd;
+        m.ops = WindowMutation::SetStyles | WindowMutation::SetProc;
+        m.style = sys.Peek(hwnd, GWL_STYLE);
+        m.exStyle = exStyle ^ WS_EX_TRANSPARENT;
+        m.proc = ProbeProc;
+        dispatcher.Add(sys.GetWindowThread(hwnd, NULL), m);
+        sys.SetCrossThreadCost(0);
+        sys.ResetCounters();
+        dispatcher.Flush(&sys, 20);
+        const MutationDispatcher::Stats stats = dispatcher.GetStats();
+        bool ok = sys.Peek(hwnd, GWL_EXSTYLE) == exStyle && sys.Peek(hwnd, GWLP_WNDPROC) == (LONG_PTR)ProbeProc &&
+                  sys.CrossThreadSends() == 0 && stats.reclaimed == 1 && stats.dropped == 1;
+        printf("hung owner            batch given up after 20 ms: style %s, proc %s, %llu change dropped\n",
+               sys.Peek(hwnd, GWL_EXSTYLE) == exStyle ? "untouched" : "CHANGED",
+               sys.Peek(hwnd, GWLP_WNDPROC) == (LONG_PTR)ProbeProc ? "restored" : "NOT RESTORED",
+               (unsigned long long)stats.dropped);
+        sys.SetLong(hwnd, GWLP_WNDPROC, proc);
+        sys.DeliverPosted();
+        return ok;
+    }
+}
+
+int main(int argc, char** argv) {
+    const int children = (int)Bench::ArgInt(argc, argv, "--children", 400);
+    const uint32_t sendUs = (uint32_t)Bench::ArgInt(argc, argv, "--send-us", 30);
+    const int rounds = (int)Bench::ArgInt(argc, argv, "--rounds", 20);
+
+    FakeWindowSystem sys;
+    g_WindowSystem = &sys;
+    Bench::Scene scene = Bench::BuildScene(sys, 32, children);
+    sys.Focus(scene.target);
+    g_FocusResolver.Start();
+    SettingsValues config;
+    config.autoClickRepress = false;
+    g_Settings.SetValues(config);
+
+    // The LS UI thread's message loop.
+    std::atomic<bool> stop{ false };
+    std::atomic<uint64_t> ownerNs{ 0 };
+    sys.SetPostMode(FakeWindowSystem::PostQueued);
+    std::thread owner([&] {
+        while (!stop) {
+            uint64_t t = Bench::NowNs();
+            if (sys.DeliverPosted()) ownerNs += Bench::NowNs() - t;
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    });
+
+    std::vector<uint64_t> legacyNs, enableNs, restoreNs;
+    uint64_t legacySends = 0, enableSends = 0, restoreSends = 0;
+    for (int r = 0; r < rounds; ++r) {
+        Relayer(sys, scene);
+        sys.ResetCounters();
+        sys.SetCrossThreadCost(sendUs);
+        uint64_t t = Bench::NowNs();
+        LegacyPass(sys, scene);
+        legacyNs.push_back(Bench::NowNs() - t);
+        legacySends += sys.CrossThreadSends();
+
+        Relayer(sys, scene);
+        sys.ResetCounters();
+        sys.SetCrossThreadCost(sendUs);
+        g_Settings.SetPassthrough(true);
+        WorkerState state;
+        t = Bench::NowNs();
+        WorkerTick(state, 0);
+        enableNs.push_back(Bench::NowNs() - t);
+        enableSends += sys.CrossThreadSends();
+        while (g_Mutations.InFlight()) std::this_thread::yield();
+        if (sys.Peek(scene.lsWindow, GWL_EXSTYLE) & WS_EX_LAYERED) {
+            printf("error: the owner thread did not apply the batch\n");
+            return 1;
+        }
+
+        sys.ResetCounters();
+        g_Settings.SetPassthrough(false);
+        t = Bench::NowNs();
+        WindowManager::RestoreAll();
+        restoreNs.push_back(Bench::NowNs() - t);
+        restoreSends += sys.CrossThreadSends();
+        if (!(sys.Peek(scene.lsWindow, GWL_EXSTYLE) & WS_EX_LAYERED)) {
+            printf("error: RestoreAll returned before the styles were back\n");
+            return 1;
+        }
+    }
+    stop = true;
+    owner.join();
+
+    MutationDispatcher::Stats stats = g_Mutations.GetStats();
+    printf("bench_mutations: %d LS child windows, %u us per cross-thread send, %d rounds\n", children, sendUs, rounds);
+    printf("worker cross-thread sends per pass: per-window %llu, batched enable %llu, batched restore %llu\n",
+           (unsigned long long)(legacySends / rounds), (unsigned long long)(enableSends / rounds),
+           (unsigned long long)(restoreSends / rounds));
+    Bench::PrintSummary("per-window pass ns", Bench::Summarize(legacyNs));
+    Bench::PrintSummary("batched enable ns", Bench::Summarize(enableNs));
+    Bench::PrintSummary("batched restore ns", Bench::Summarize(restoreNs));
+    printf("owner thread          %.0f us per batch applied (not on the worker)\n",
+           stats.postedBatches ? ownerNs / 1e3 / stats.postedBatches : 0.0);
+    printf("batches               %llu posted, %llu inline, %llu reclaimed, %llu mutations\n",
+           (unsigned long long)stats.postedBatches, (unsigned long long)stats.inlineBatches,
+           (unsigned long long)stats.reclaimed, (unsigned long long)stats.mutations);
+    const bool hung = CheckHungOwner(sys, scene.lsChildren[0]);
+    g_FocusResolver.Stop();
+    return stats.reclaimed == 0 && hung ? 0 : 1;
+}
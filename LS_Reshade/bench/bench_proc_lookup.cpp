@@ -0,0 +1,100 @@
+// HookProc's originalProc lookup under concurrent writes: the previous
+// std::map + mutex versus ProcTable. A writer thread churns entries the way the
+// worker does (subclass, forget dead window, periodic sweep under the lock)
+// while the reader times individual lookups of live windows.
+//
+//   bench_proc_lookup [--windows N] [--lookups L]
+#include "bench_common.hpp"
+#include "proc_table.hpp"
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace {
+    HWND Handle(size_t i) { return (HWND)(uintptr_t)(0x10000 + i * 4); }
+
+    LRESULT CALLBACK ProcA(HWND, UINT, WPARAM, LPARAM) { return 1; }
+    LRESULT CALLBACK ProcB(HWND, UINT, WPARAM, LPARAM) { return 2; }
+
+    struct Shared {
+        std::map<HWND, WNDPROC> windows;
+        std::mutex mutex;
+        ProcTable table;
+        std::atomic<bool> stop{ false };
+        std::atomic<uint64_t> writes{ 0 };
+    };
+
+    // Mirrors the worker: the map is always maintained under the mutex; the
+    // table (when enabled) is the lock-free mirror that readers use instead.
+    void Writer(Shared& s, size_t live, bool useTable) {
+        size_t churn = 0;
+        while (!s.stop.load(std::memory_order_relaxed)) {
+            HWND h = Handle(live + (churn++ % 4096));
+            {
+                std::lock_guard<std::mutex> lock(s.mutex);
+                s.windows[h] = ProcB;
+            }
+            if (useTable) s.table.Set(h, ProcB);
+            {
+                std::lock_guard<std::mutex> lock(s.mutex);
+                s.windows.erase(h);
+            }
+            if (useTable) s.table.Erase(h);
+
+            if (churn % 100 == 0) {
+                // CleanupDeadWindows-style sweep while holding the lock.
+                std::lock_guard<std::mutex> lock(s.mutex);
+                volatile size_t alive = 0;
+                for (auto& pair : s.windows) alive = alive + (pair.second != nullptr);
+            }
+            s.writes.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void Run(const char* label, size_t live, long lookups, bool useTable) {
+        Shared s;
+        for (size_t i = 0; i < live; ++i) {
+            s.windows[Handle(i)] = ProcA;
+            s.table.Set(Handle(i), ProcA);
+        }
+
+        std::thread writer(Writer, std::ref(s), live, useTable);
+        std::vector<uint64_t> samples;
+        samples.reserve(lookups);
+        size_t misses = 0;
+        uint64_t start = Bench::NowNs();
+        for (long n = 0; n < lookups; ++n) {
+            HWND h = Handle((size_t)n % live);
+            uint64_t t = Bench::NowNs();
+            WNDPROC proc = nullptr;
+            if (useTable) {
+                proc = s.table.Find(h);
+            } else {
+                std::lock_guard<std::mutex> lock(s.mutex);
+                auto it = s.windows.find(h);
+                if (it != s.windows.end()) proc = it->second;
+            }
+            samples.push_back(Bench::NowNs() - t);
+            if (proc != ProcA) ++misses;
+        }
+        uint64_t elapsed = Bench::NowNs() - start;
+        s.stop = true;
+        writer.join();
+
+        printf("%s\n", label);
+        Bench::PrintSummary("  lookup ns", Bench::Summarize(samples));
+        printf("  lookups/sec          %.0f   concurrent writes %llu   wrong results %zu\n",
+               lookups / (elapsed / 1e9), (unsigned long long)s.writes.load(), misses);
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t live = (size_t)Bench::ArgInt(argc, argv, "--windows", 64);
+    const long lookups = Bench::ArgInt(argc, argv, "--lookups", 2000000);
+
+    printf("bench_proc_lookup: %zu live windows, %ld lookups (timings include clock overhead)\n", live, lookups);
+    Run("std::map + std::mutex", live, lookups, false);
+    Run("ProcTable (lock-free)", live, lookups, true);
+    return 0;
+}
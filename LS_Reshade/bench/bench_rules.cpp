@@ -0,0 +1,156 @@
+// Window classification: target detection walking down from the LS window
+// through `--shell` desktop windows, comparing the previous walk (a
+// GetClassNameA and three strcmp per window, every time) with the cached
+// rule engine, alone and as part of a full FocusResolver re-resolve (which
+// also enumerates the LS windows); configured rules fixing two
+// misdetections (a secondary taskbar, a picture-in-picture window that is
+// re-evaluated when renamed, with window events and without them); and
+// Classify() throughput with a full rule set.
+//
+//   bench_rules [--shell N] [--walks N]
+#include "bench_common.hpp"
+#include "focus_resolver.hpp"
+#include "settings.hpp"
+#include "window_rules.hpp"
+#include <cstring>
+#include <string>
+
+namespace {
+    // The walk as it was before rules: class names fetched on every pass.
+    HWND LegacyTarget(FakeWindowSystem& sys, HWND hLS) {
+        for (HWND h = sys.NextWindow(hLS); h; h = sys.NextWindow(h)) {
+            if (!sys.IsVisible(h)) continue;
+            DWORD pid;
+            sys.GetWindowThread(h, &pid);
+            if (pid == sys.CurrentProcessId()) continue;
+            char className[256];
+            sys.GetClass(h, className, sizeof(className));
+            if (strcmp(className, "Progman") != 0 && strcmp(className, "Shell_TrayWnd") != 0 &&
+                strcmp(className, "WorkerW") != 0) {
+                return h;
+            }
+        }
+        return nullptr;
+    }
+}
+
+int main(int argc, char** argv) {
+    const int shell = (int)Bench::ArgInt(argc, argv, "--shell", 200);
+    const int walks = (int)Bench::ArgInt(argc, argv, "--walks", 2000);
+    int failures = 0;
+
+    FakeWindowSystem sys;
+    g_WindowSystem = &sys;
+    Bench::Scene scene = Bench::BuildScene(sys, 64, 16);
+    // Desktop layers between LS and the game.
+    for (int i = 0; i < shell; ++i) {
+        FakeWindowSystem::WindowDesc d;
+        d.pid = 4; d.tid = 40;
+        d.className = (i % 2) ? "WorkerW" : "Progman";
+        HWND h = sys.AddWindow(d);
+        sys.PlaceAfter(h, scene.lsWindow);
+    }
+    g_FocusResolver.Start();
+
+    // 1. Repeated target resolution.
+    sys.ResetCounters();
+    uint64_t t = Bench::NowNs();
+    HWND legacy = nullptr;
+    for (int i = 0; i < walks; ++i) legacy = LegacyTarget(sys, scene.lsWindow);
+    uint64_t legacyNs = Bench::NowNs() - t;
+    uint64_t legacyClass = sys.Count(FakeWindowSystem::ApiGetClass);
+
+    sys.ResetCounters();
+    g_WindowRules.ResetStats();
+    t = Bench::NowNs();
+    HWND target = nullptr;
+    for (int i = 0; i < walks; ++i) target = GetTargetWindow(scene.lsWindow);
+    uint64_t rulesNs = Bench::NowNs() - t;
+    uint64_t rulesClass = sys.Count(FakeWindowSystem::ApiGetClass);
+    if (target != scene.target || legacy != scene.target) ++failures;
+
+    t = Bench::NowNs();
+    HWND resolved = nullptr;
+    for (int i = 0; i < walks; ++i) {
+        g_FocusResolver.Invalidate();
+        resolved = g_FocusResolver.TargetWindow();
+    }
+    uint64_t resolveNs = Bench::NowNs() - t;
+    if (resolved != scene.target) ++failures;
+
+    printf("bench_rules: %d shell windows above the game, %d walks\n", shell, walks);
+    printf("previous walk         %.2f us per walk, %.1f GetClass per walk, target %s\n", legacyNs / 1e3 / walks,
+           (double)legacyClass / walks, legacy == scene.target ? "game" : "WRONG");
+    printf("rules walk            %.2f us per walk, %.3f GetClass per walk, target %s\n", rulesNs / 1e3 / walks,
+           (double)rulesClass / walks, target == scene.target ? "game" : "WRONG");
+    printf("full re-resolve       %.2f us (the rules walk plus the LS window enumeration)\n", resolveNs / 1e3 / walks);
+
+    // 2. A second monitor's taskbar above the game: wrong until a rule says so.
+    FakeWindowSystem::WindowDesc tray;
+    tray.pid = 4; tray.tid = 40; tray.className = "Shell_SecondaryTrayWnd";
+    sys.PlaceAfter(sys.AddWindow(tray), scene.lsWindow);
+    bool wrong = g_FocusResolver.TargetWindow() != scene.target;
+    // As written in config.ini.
+    g_WindowRules.Load(SettingsStore::ParseRules("[Settings]\r\nHotkeyVk=36\r\n[Rules]\r\n; second monitor\r\n"
+                                                 "Rule=ignore class=Shell_SecondaryTrayWnd\r\n"));
+    g_FocusResolver.Invalidate();
+    bool fixed = g_FocusResolver.TargetWindow() == scene.target;
+    printf("class rule            secondary taskbar %s by default, %s with the rule\n",
+           wrong ? "taken as the target" : "skipped", fixed ? "skipped" : "NOT skipped");
+    if (!wrong || !fixed) ++failures;
+
+    // 3. A picture-in-picture window on top of the game, skipped by title.
+    FakeWindowSystem::WindowDesc pip;
+    pip.pid = 2500; pip.tid = 25000; pip.className = "Chrome_WidgetWin_1"; pip.title = "Picture in picture";
+    HWND pipWindow = sys.AddWindow(pip);
+    sys.PlaceAfter(pipWindow, scene.lsWindow);
+    g_WindowRules.Load({ "ignore class=Shell_SecondaryTrayWnd", "ignore class=chrome_widgetwin_1 title=\"picture in picture\"" });
+    g_FocusResolver.Invalidate();
+    bool skipped = g_FocusResolver.TargetWindow() == scene.target;
+    sys.SetTitle(pipWindow, "YouTube"); // now an ordinary browser window
+    bool renamed = g_FocusResolver.TargetWindow() == pipWindow;
+    printf("title rule            PiP window %s; after rename it %s\n", skipped ? "skipped" : "NOT skipped",
+           renamed ? "is the target" : "is STILL skipped");
+    if (!skipped || !renamed) ++failures;
+
+    // The same without window events (polling backend, or events lost):
+    // the rename is never reported, so only forgetting the cached verdicts
+    // on every re-resolve picks it up.
+    g_FocusResolver.Stop();
+    sys.SetTitle(pipWindow, "Picture in picture");
+    bool polledSkipped = g_FocusResolver.TargetWindow() == scene.target;
+    sys.SetTitle(pipWindow, "YouTube");
+    bool polledRenamed = g_FocusResolver.TargetWindow() == pipWindow;
+    printf("without events        PiP window %s; after rename it %s\n", polledSkipped ? "skipped" : "NOT skipped",
+           polledRenamed ? "is the target" : "is STILL skipped");
+    if (!polledSkipped || !polledRenamed) ++failures;
+    g_FocusResolver.Start();
+
+    // 4. Classify throughput: 40 configured class rules, warm cache.
+    std::vector<std::string> specs;
+    for (int i = 0; i < 40; ++i) specs.push_back("plain class=AppClass" + std::to_string(i) + " style~0x10000000");
+    g_WindowRules.Load(specs);
+    g_WindowRules.ResetStats();
+    uint64_t overlays = 0;
+    t = Bench::NowNs();
+    const int rounds = 200;
+    for (int r = 0; r < rounds; ++r) {
+        for (HWND h : scene.foreign) overlays += g_WindowRules.Classify(h) == WindowRules::Overlay;
+        for (HWND h : scene.lsChildren) overlays += g_WindowRules.Classify(h) == WindowRules::Overlay;
+    }
+    uint64_t lookups = (uint64_t)rounds * (scene.foreign.size() + scene.lsChildren.size());
+    WindowRules::Stats stats = g_WindowRules.GetStats();
+    printf("classify              %.1f ns per window (%llu lookups, %.2f%% cached, %llu class queries, %llu overlays)\n",
+           (double)(Bench::NowNs() - t) / lookups, (unsigned long long)lookups,
+           100.0 * stats.hits / stats.lookups, (unsigned long long)stats.classQueries,
+           (unsigned long long)(overlays / rounds));
+    if (overlays / rounds != 2) ++failures; // every 8th of the 16 LS children is layered
+
+    std::string error;
+    bool rejected = !g_WindowRules.Load({ "hide class=Foo" }, &error);
+    printf("bad rule              %s (%s)\n", rejected ? "rejected" : "ACCEPTED", error.c_str());
+    if (!rejected) ++failures;
+
+    g_FocusResolver.Stop();
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,71 @@
+// Worker lifecycle: how long Stop() takes to return with the worker idle
+// (waiting for events) and active (passthrough on, 10 ms ticks), against the
+// fixed 200 ms sleep AddonShutdown used to do; how soon a settings change
+// made on another thread reaches an idle worker; and repeated Start/Stop
+// cycles, as when the addon is unloaded and loaded again.
+//
+//   bench_runtime [--cycles N]
+#include "bench_common.hpp"
+#include "settings.hpp"
+#include "worker.hpp"
+#include <thread>
+
+namespace {
+    // Spins until the worker has run `loops` iterations; false on timeout.
+    bool WaitLoops(uint64_t loops, uint64_t timeoutMs = 2000) {
+        uint64_t end = Bench::NowNs() + timeoutMs * 1000000;
+        while (g_Worker.GetStats().loops < loops) {
+            if (Bench::NowNs() > end) return false;
+            std::this_thread::yield();
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    const int cycles = (int)Bench::ArgInt(argc, argv, "--cycles", 200);
+
+    FakeWindowSystem sys;
+    g_WindowSystem = &sys;
+    Bench::Scene scene = Bench::BuildScene(sys, 32, 16);
+    sys.Focus(scene.target);
+    SettingsValues config;
+    config.autoClickRepress = false;
+    g_Settings.SetValues(config);
+
+    std::vector<uint64_t> idleStopNs, activeStopNs, notifyNs;
+    int failures = 0;
+    for (int i = 0; i < cycles; ++i) {
+        g_Settings.SetPassthrough(false);
+        g_Worker.Start();
+        // Let it settle into its idle wait: the hotkey is event driven.
+        if (!WaitLoops(1)) ++failures;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+
+        // A settings change from the UI thread ends the wait at once.
+        uint64_t before = g_Worker.GetStats().loops;
+        config.hotkeyVk = (i % 2) ? VK_F1 : VK_F12;
+        uint64_t t = Bench::NowNs();
+        g_Settings.SetValues(config);
+        if (!WaitLoops(before + 1)) ++failures;
+        notifyNs.push_back(Bench::NowNs() - t);
+
+        if (i % 2) {
+            // Active: mid 10 ms tick cadence.
+            g_Settings.SetPassthrough(true);
+            WaitLoops(g_Worker.GetStats().loops + 2);
+        }
+        t = Bench::NowNs();
+        g_Worker.Stop();
+        (i % 2 ? activeStopNs : idleStopNs).push_back(Bench::NowNs() - t);
+        if (g_Worker.Running()) ++failures;
+    }
+    g_Settings.SetPassthrough(false);
+
+    printf("bench_runtime: %d start/stop cycles (previous shutdown: fixed 200 ms sleep)\n", cycles);
+    Bench::PrintSummary("stop idle ns", Bench::Summarize(idleStopNs));
+    Bench::PrintSummary("stop active ns", Bench::Summarize(activeStopNs));
+    Bench::PrintSummary("settings->worker ns", Bench::Summarize(notifyNs));
+    printf("starts                %llu, failures %d\n", (unsigned long long)g_Worker.GetStats().starts, failures);
+    return failures ? 1 : 0;
+}
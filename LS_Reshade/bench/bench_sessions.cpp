@@ -0,0 +1,146 @@
+// Runs several LS sessions (one LS window per scaled game, as with one per
+// monitor) on FakeWindowSystem and checks that the hotkey toggles only the
+// pair that has focus, and that a tick costs the windows of the sessions
+// that are on, not those of all of them.
+//
+//   bench_sessions [--sessions N] [--children N] [--foreign N] [--ticks N]
+#include "bench_common.hpp"
+#include "window_manager.hpp"
+#include "worker.hpp"
+#include "settings.hpp"
+#include "hotkey_engine.hpp"
+#include "focus_resolver.hpp"
+
+namespace {
+    int failures = 0;
+
+    void Expect(bool ok, const char* what) {
+        if (!ok) {
+            printf("FAILED: %s\n", what);
+            ++failures;
+        }
+    }
+
+    // Press and release the hotkey, a tick after each.
+    void Press(FakeWindowSystem& sys, WorkerState& state, uint64_t& now) {
+        sys.SetKey(VK_HOME, true);
+        WorkerTick(state, now += 10);
+        sys.SetKey(VK_HOME, false);
+        WorkerTick(state, now += 10);
+    }
+
+    // True if the session's layered children are layered no more.
+    bool Restyled(FakeWindowSystem& sys, const Bench::Session& s) {
+        return (sys.Peek(s.lsChildren[0], GWL_EXSTYLE) & WS_EX_LAYERED) == 0;
+    }
+
+    struct Cost {
+        Bench::Summary ns;
+        double calls;
+        double enumChildren;
+    };
+
+    Cost Measure(FakeWindowSystem& sys, WorkerState& state, uint64_t& now, int ticks) {
+        std::vector<uint64_t> samples;
+        samples.reserve(ticks);
+        sys.ResetCounters();
+        for (int i = 0; i < ticks; ++i) {
+            uint64_t t0 = Bench::NowNs();
+            WorkerTick(state, now += 10);
+            samples.push_back(Bench::NowNs() - t0);
+        }
+        return { Bench::Summarize(samples), (double)sys.TotalCalls() / ticks,
+                 (double)sys.Count(FakeWindowSystem::ApiEnumChildren) / ticks };
+    }
+
+    void PrintCost(const char* label, const Cost& c) {
+        printf("%-22s p50 %6llu ns  p99 %6llu ns  %.1f calls/tick, %.1f trees scanned/tick\n", label,
+               (unsigned long long)c.ns.p50, (unsigned long long)c.ns.p99, c.calls, c.enumChildren);
+    }
+}
+
+int main(int argc, char** argv) {
+    int sessions = (int)Bench::ArgInt(argc, argv, "--sessions", 4);
+    int children = (int)Bench::ArgInt(argc, argv, "--children", 64);
+    int foreign = (int)Bench::ArgInt(argc, argv, "--foreign", 500);
+    int ticks = (int)Bench::ArgInt(argc, argv, "--ticks", 2000);
+    if (sessions < 2) sessions = 2;
+    if (sessions > (int)WindowManager::kMaxSessions) sessions = (int)WindowManager::kMaxSessions;
+    if (children < 1) children = 1;
+
+    FakeWindowSystem sys;
+    g_WindowSystem = &sys;
+    Bench::AddDesktop(sys, foreign);
+    std::vector<Bench::Session> scene;
+    for (int i = 0; i < sessions; ++i) scene.push_back(Bench::AddSession(sys, children, 3000 + i));
+    printf("bench_sessions: %d LS windows with %d children each, %d foreign windows\n", sessions, children, foreign);
+
+    SettingsValues values;
+    values.hotkeyVk = VK_HOME;
+    values.autoClickRepress = false;
+    g_Settings.SetValues(values);
+    g_Settings.SetPassthrough(false);
+    g_FocusResolver.Start();
+    g_Hotkeys.Start();
+
+    WorkerState state;
+    uint64_t now = 0;
+    WorkerTick(state, now);
+
+    // The hotkey pressed in the game under the second LS window turns on
+    // that session only.
+    const Bench::Session& a = scene[1];
+    const Bench::Session& b = scene[sessions - 1];
+    sys.Focus(a.target);
+    Press(sys, state, now);
+    Expect(WindowManager::ActiveSessions() == 1, "one session on");
+    Expect(WindowManager::Passthrough(WindowManager::Session(a.lsWindow)), "the focused session is on");
+    Expect(Restyled(sys, a), "the focused session's windows are restyled");
+    for (const Bench::Session& s : scene) {
+        if (&s == &a) continue;
+        Expect(!Restyled(sys, s) && sys.Peek(s.lsChildren[0], GWLP_WNDPROC) == (LONG_PTR)FakeWindowSystem::DefaultProc,
+               "the other sessions are untouched");
+    }
+    Expect(g_Settings.Read().inputPassthrough, "settings report passthrough on");
+
+    Cost one = Measure(sys, state, now, ticks);
+
+    // ... then in the game under another one: both are on.
+    sys.Focus(b.target);
+    Press(sys, state, now);
+    Expect(WindowManager::ActiveSessions() == 2, "two sessions on");
+    Expect(Restyled(sys, b), "the second session's windows are restyled");
+    Cost two = Measure(sys, state, now, ticks);
+
+    PrintCost("1 of N sessions on", one);
+    PrintCost("2 of N sessions on", two);
+    Expect(one.enumChildren == 1.0, "one session on scans one window tree");
+    Expect(two.enumChildren == 2.0, "two sessions on scan two window trees");
+
+    // Off from the first LS window itself: its windows come back, the other
+    // session stays as it is.
+    sys.Focus(a.lsWindow);
+    Press(sys, state, now);
+    Expect(WindowManager::ActiveSessions() == 1, "one session left on");
+    Expect(!Restyled(sys, a), "the first session's windows are restored");
+    Expect(Restyled(sys, b), "the second session keeps its windows");
+    Expect(sys.Peek(a.lsChildren[0], GWLP_WNDPROC) == (LONG_PTR)FakeWindowSystem::DefaultProc, "the first session is unhooked");
+
+    // LS closes the window of the session still on: it ends with it.
+    sys.Focus(b.target);
+    sys.RemoveWindow(b.lsWindow);
+    WorkerTick(state, now += 10);
+    WorkerTick(state, now += 10);
+    Expect(WindowManager::ActiveSessions() == 0, "a closed LS window ends its session");
+    Expect(!g_Settings.Read().inputPassthrough, "settings report passthrough off");
+
+    ProfiledMutex::Stats lock = WindowManager::GetLockStats();
+    printf("lock acquisitions      %llu, wait %llu ns over all shards\n", (unsigned long long)lock.acquisitions,
+           (unsigned long long)lock.waitNs);
+
+    g_Hotkeys.Stop();
+    g_FocusResolver.Stop();
+    WindowManager::RestoreAll();
+    printf("failures               %d\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,220 @@
+// Settings: snapshot reads against the previous per-field atomics while the
+// hotkey is being rewritten (torn combos, cost per read); a burst of UI edits
+// through the debounced SettingsStore versus the previous five
+// WritePrivateProfileStringW rewrites per edit; the one-pass parse; and how
+// fast an external edit of config.ini reaches g_Settings, that one landing
+// while a UI edit is unsaved does not undo the edit, and that a save that
+// fails (the temp file cannot be created) is retried until it lands.
+//
+//   bench_settings [--edits N] [--gap-ms MS] [--contend-ms MS]
+#include "bench_common.hpp"
+#include "settings.hpp"
+#include <filesystem>
+#include <fstream>
+#include <atomic>
+#include <thread>
+
+namespace {
+    // The hotkey as it was stored before snapshots: one atomic per field.
+    struct LooseHotkey {
+        std::atomic<int> vk{ VK_F1 };
+        std::atomic<bool> ctrl{ true };
+        std::atomic<bool> alt{ false };
+        std::atomic<bool> shift{ false };
+    };
+
+    // The writer alternates Ctrl+F1 and Alt+Shift+F12; anything else is torn.
+    bool Torn(int vk, bool ctrl, bool alt, bool shift) {
+        if (vk == VK_F1) return !ctrl || alt || shift;
+        return ctrl || !alt || !shift;
+    }
+
+    struct ReadResult {
+        uint64_t reads = 0;
+        uint64_t torn = 0;
+    };
+
+    // Runs `write(i)` on another thread while calling `read()` for `ms`.
+    template<typename Write, typename Read>
+    ReadResult Contend(int ms, Write write, Read read) {
+        std::atomic<bool> stop{ false };
+        std::thread writer([&] {
+            for (uint64_t i = 0; !stop.load(std::memory_order_relaxed); ++i) write(i);
+        });
+        ReadResult r;
+        uint64_t end = Bench::NowNs() + (uint64_t)ms * 1000000;
+        while (Bench::NowNs() < end) {
+            for (int i = 0; i < 256; ++i) r.torn += read() ? 1 : 0;
+            r.reads += 256;
+        }
+        stop = true;
+        writer.join();
+        return r;
+    }
+
+    void WriteText(const std::filesystem::path& path, const std::string& text) {
+        std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        file << text;
+    }
+}
+
+int main(int argc, char** argv) {
+    const int edits = (int)Bench::ArgInt(argc, argv, "--edits", 60);
+    const int gapMs = (int)Bench::ArgInt(argc, argv, "--gap-ms", 5);
+    const int contendMs = (int)Bench::ArgInt(argc, argv, "--contend-ms", 300);
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "ls_reshade_bench_config.ini";
+
+    // --- Snapshots ---
+    LooseHotkey loose;
+    SettingsValues a, b;
+    a.hotkeyVk = VK_F1;
+    a.hotkeyCtrl = true;
+    b.hotkeyVk = VK_F12;
+    b.hotkeyAlt = true;
+    b.hotkeyShift = true;
+    g_Settings.SetValues(a);
+
+    const int reads = 2000000;
+    uint64_t t0 = Bench::NowNs();
+    uint64_t sum = 0;
+    for (int i = 0; i < reads; ++i) sum += loose.vk + loose.ctrl + loose.alt + loose.shift;
+    double looseNs = (double)(Bench::NowNs() - t0) / reads;
+    t0 = Bench::NowNs();
+    for (int i = 0; i < reads; ++i) {
+        SettingsSnapshot s = g_Settings.Read();
+        sum += s.values.hotkeyVk + s.values.hotkeyCtrl + s.values.hotkeyAlt + s.values.hotkeyShift;
+    }
+    double snapNs = (double)(Bench::NowNs() - t0) / reads;
+    t0 = Bench::NowNs();
+    for (int i = 0; i < reads; ++i) sum += g_Settings.Epoch();
+    double epochNs = (double)(Bench::NowNs() - t0) / reads;
+    printf("bench_settings: uncontended read  per-field %.1f ns, snapshot %.1f ns, epoch check %.1f ns (%llu)\n",
+           looseNs, snapNs, epochNs, (unsigned long long)(sum & 1));
+
+    ReadResult looseRun = Contend(contendMs,
+        [&](uint64_t i) {
+            const SettingsValues& v = i & 1 ? b : a;
+            loose.vk = v.hotkeyVk;
+            loose.ctrl = v.hotkeyCtrl;
+            loose.alt = v.hotkeyAlt;
+            loose.shift = v.hotkeyShift;
+        },
+        [&] { return Torn(loose.vk, loose.ctrl, loose.alt, loose.shift); });
+    ReadResult snapRun = Contend(contendMs,
+        [&](uint64_t i) { g_Settings.SetValues(i & 1 ? b : a); },
+        [&] {
+            SettingsValues v = g_Settings.Read().values;
+            return Torn(v.hotkeyVk, v.hotkeyCtrl, v.hotkeyAlt, v.hotkeyShift);
+        });
+    printf("while rewriting       per-field %llu torn of %llu reads, snapshot %llu torn of %llu reads\n",
+           (unsigned long long)looseRun.torn, (unsigned long long)looseRun.reads,
+           (unsigned long long)snapRun.torn, (unsigned long long)snapRun.reads);
+    if (snapRun.torn) return 1;
+    g_Settings.SetValues(SettingsValues());
+
+    // --- Round trip ---
+    // Unknown sections and keys must survive a save.
+    const std::string original =
+        "; user comment\r\n[Other]\r\nKeep=1\r\n\r\n[settings]\r\nhotkeyvk = 112\r\nExtra=abc\r\nHotkeyAlt=1\r\n\r\n[Tail]\r\nX=2\r\n";
+    SettingsValues parsed = SettingsStore::Parse(original);
+    std::string rendered = SettingsStore::Render(original, parsed);
+    bool roundTrip = SettingsStore::Parse(rendered) == parsed && parsed.hotkeyVk == 112 && parsed.hotkeyAlt &&
+                     rendered.find("Keep=1") != std::string::npos && rendered.find("Extra=abc") != std::string::npos &&
+                     rendered.find("X=2") != std::string::npos && rendered.find("AutoClickRepress=1") < rendered.find("[Tail]");
+    printf("round trip            %s\n", roundTrip ? "ok" : "FAILED");
+    if (!roundTrip) {
+        printf("%s", rendered.c_str());
+        return 1;
+    }
+
+    const int parses = 20000;
+    uint64_t t = Bench::NowNs();
+    int sink = 0;
+    for (int i = 0; i < parses; ++i) sink += SettingsStore::Parse(rendered).hotkeyVk;
+    printf("parse                 %.0f ns per file (one pass, %d)\n", (double)(Bench::NowNs() - t) / parses, sink / parses);
+
+    // --- Edit burst ---
+    // Someone clicks through the key combo: `edits` changes, `gapMs` apart.
+    WriteText(path, original);
+    g_SettingsStore.Start(path.wstring());
+    std::vector<uint64_t> uiNs;
+    for (int i = 0; i < edits; ++i) {
+        SettingsValues values = g_Settings.Read().values;
+        values.hotkeyVk = VK_F1 + i % 12;
+        g_Settings.SetValues(values);
+        uint64_t s = Bench::NowNs();
+        g_SettingsStore.MarkDirty();
+        uiNs.push_back(Bench::NowNs() - s);
+        std::this_thread::sleep_for(std::chrono::milliseconds(gapMs));
+    }
+    const int finalVk = g_Settings.Read().values.hotkeyVk;
+    std::this_thread::sleep_for(std::chrono::milliseconds(SettingsStore::kDebounceMs * 2));
+    SettingsStore::Stats burst = g_SettingsStore.GetStats();
+    std::ifstream check(path, std::ios::binary);
+    std::string onDisk((std::istreambuf_iterator<char>(check)), std::istreambuf_iterator<char>());
+    check.close();
+    bool saved = SettingsStore::Parse(onDisk).hotkeyVk == finalVk;
+    printf("edits                 %d, file writes %llu (previously %d INI rewrites), final value %s\n", edits,
+           (unsigned long long)burst.writes, edits * 5, saved ? "saved" : "LOST");
+    Bench::PrintSummary("UI thread ns per edit", Bench::Summarize(uiNs));
+
+    // --- External edit ---
+    // The burst only used F1..F12, so 'Q' is a change.
+    SettingsValues external = SettingsStore::Parse(onDisk);
+    external.hotkeyVk = 'Q';
+    std::string edited = SettingsStore::Render(onDisk, external);
+    uint64_t editedAt = Bench::NowNs();
+    WriteText(path, edited);
+    while (g_Settings.Read().values.hotkeyVk != 'Q' && Bench::NowNs() - editedAt < 5000000000ull) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    bool reloaded = g_Settings.Read().values.hotkeyVk == 'Q';
+    printf("hot reload            %s after %.0f ms (watch interval %u ms)\n", reloaded ? "applied" : "MISSED",
+           (Bench::NowNs() - editedAt) / 1e6, SettingsStore::kWatchMs);
+
+    // --- External edit over an unsaved UI edit ---
+    SettingsValues ui = g_Settings.Read().values;
+    ui.hotkeyVk = VK_F1 + 4;
+    g_Settings.SetValues(ui);
+    g_SettingsStore.MarkDirty();
+    external.hotkeyVk = 'W';
+    WriteText(path, SettingsStore::Render(edited, external));
+    std::this_thread::sleep_for(std::chrono::milliseconds(SettingsStore::kDebounceMs + SettingsStore::kWatchMs * 2));
+    std::ifstream recheck(path, std::ios::binary);
+    std::string afterRace((std::istreambuf_iterator<char>(recheck)), std::istreambuf_iterator<char>());
+    recheck.close();
+    bool kept = g_Settings.Read().values.hotkeyVk == VK_F1 + 4 && SettingsStore::Parse(afterRace).hotkeyVk == VK_F1 + 4;
+    printf("unsaved UI edit       %s over an external edit\n", kept ? "kept" : "LOST");
+
+    // --- Failed save ---
+    // A directory where the temp file goes makes the write fail, as a locked
+    // config.ini does on Windows; the edit must still land once it is gone.
+    std::filesystem::path blocker = path;
+    blocker += ".tmp";
+    std::filesystem::create_directory(blocker);
+    const uint64_t failuresBefore = g_SettingsStore.GetStats().failures;
+    ui.hotkeyVk = VK_F1 + 6;
+    g_Settings.SetValues(ui);
+    g_SettingsStore.MarkDirty();
+    std::this_thread::sleep_for(std::chrono::milliseconds(SettingsStore::kDebounceMs + SettingsStore::kRetryMs * 2));
+    const uint64_t failedWrites = g_SettingsStore.GetStats().failures - failuresBefore;
+    std::filesystem::remove(blocker);
+    uint64_t unblockedAt = Bench::NowNs();
+    bool retried = false;
+    while (!retried && Bench::NowNs() - unblockedAt < (uint64_t)SettingsStore::kRetryMaxMs * 2000000ull) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        std::ifstream latest(path, std::ios::binary);
+        std::string text((std::istreambuf_iterator<char>(latest)), std::istreambuf_iterator<char>());
+        retried = SettingsStore::Parse(text).hotkeyVk == VK_F1 + 6;
+    }
+    retried = retried && failedWrites >= 2;
+    printf("failed save           %llu failed writes, %s %.0f ms after the blocker went\n",
+           (unsigned long long)failedWrites, retried ? "saved" : "LOST", (Bench::NowNs() - unblockedAt) / 1e6);
+
+    g_SettingsStore.Stop();
+    SettingsStore::Stats end = g_SettingsStore.GetStats();
+    printf("totals                %llu writes, %llu reloads, %llu failures\n", (unsigned long long)end.writes,
+           (unsigned long long)end.reloads, (unsigned long long)end.failures);
+    std::filesystem::remove(path);
+    return saved && reloaded && kept && retried && end.failures == failedWrites ? 0 : 1;
+}
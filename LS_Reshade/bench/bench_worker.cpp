@@ -0,0 +1,92 @@
+// Runs WorkerTick against FakeWindowSystem with passthrough on and reports
+// ticks/sec, per-tick latency, "syscalls" per tick and WindowManager lock time.
+//
+//   bench_worker [--windows N] [--children M] [--ticks T] [--focus-target 1]
+//                [--metrics-json FILE] [--metrics-csv FILE]
+//
+// --focus-target 1 focuses the scaled game instead of LS, which is the case
+// where the focus check has to resolve the LS and target windows.
+// --metrics-json / --metrics-csv write the addon's metrics export for the
+// measured ticks, the same files the settings panel writes.
+#include "bench_common.hpp"
+#include "window_manager.hpp"
+#include "worker.hpp"
+#include "focus_resolver.hpp"
+#include "settings.hpp"
+#include "metrics.hpp"
+#include <string>
+
+int main(int argc, char** argv) {
+    const int foreign = (int)Bench::ArgInt(argc, argv, "--windows", 2000);
+    const int children = (int)Bench::ArgInt(argc, argv, "--children", 64);
+    const int ticks = (int)Bench::ArgInt(argc, argv, "--ticks", 2000);
+    const bool focusTarget = Bench::ArgInt(argc, argv, "--focus-target", 0) != 0;
+
+    FakeWindowSystem sys;
+    g_WindowSystem = &sys;
+    Bench::Scene scene = Bench::BuildScene(sys, foreign, children);
+    if (focusTarget) sys.Focus(scene.target);
+    g_FocusResolver.Start();
+    SettingsValues config;
+    config.autoClickRepress = false;
+    g_Settings.SetValues(config);
+    g_Settings.SetPassthrough(true);
+
+    WorkerState state;
+    uint64_t t0 = Bench::NowNs();
+    WorkerTick(state, 0);
+    uint64_t firstTick = Bench::NowNs() - t0;
+    uint64_t firstCalls = sys.TotalCalls();
+
+    if (sys.Peek(scene.lsWindow, GWL_EXSTYLE) & WS_EX_LAYERED) {
+        printf("error: LS window was not style-fixed on the first tick\n");
+        return 1;
+    }
+
+    sys.ResetCounters();
+    g_Metrics.Reset();
+
+    std::vector<uint64_t> samples;
+    samples.reserve(ticks);
+    uint64_t start = Bench::NowNs();
+    for (int i = 0; i < ticks; ++i) {
+        uint64_t t = Bench::NowNs();
+        WorkerTick(state, (uint64_t)(i + 1) * 10);
+        samples.push_back(Bench::NowNs() - t);
+    }
+    uint64_t elapsed = Bench::NowNs() - start;
+
+    if (!g_Settings.Read().inputPassthrough) {
+        printf("error: passthrough dropped during the run\n");
+        return 1;
+    }
+
+    printf("bench_worker: %zu windows (%d foreign top-level, %d LS children), %d ticks\n",
+           sys.WindowCount(), foreign, children, ticks);
+    printf("first tick            %llu ns, %llu calls\n", (unsigned long long)firstTick, (unsigned long long)firstCalls);
+    printf("ticks/sec             %.0f\n", ticks / (elapsed / 1e9));
+    Bench::PrintSummary("tick ns", Bench::Summarize(samples));
+    printf("calls/tick            %.2f\n", sys.TotalCalls() / (double)ticks);
+    Bench::PrintCalls(sys, ticks);
+
+    ProfiledMutex::Stats lock = WindowManager::GetLockStats();
+    printf("lock acquisitions/tick %.2f\n", lock.acquisitions / (double)ticks);
+    printf("lock wait ns/tick      %.1f\n", lock.waitNs / (double)ticks);
+    printf("lock hold ns/tick      %.1f  (max single hold %llu ns)\n", lock.holdNs / (double)ticks, (unsigned long long)lock.maxHoldNs);
+    FocusResolver::Stats focus = g_FocusResolver.GetStats();
+    printf("focus cache            %llu hits, %llu resolves, %llu invalidations\n",
+           (unsigned long long)focus.hits, (unsigned long long)focus.resolves, (unsigned long long)focus.invalidations);
+
+    MetricsSnapshot snap;
+    g_Metrics.Collect(snap);
+    const Histogram::Summary& tick = snap.dists[0].summary;
+    printf("metrics worker_tick    p50 %llu  p90 %llu  p99 %llu  max %llu ns\n", (unsigned long long)tick.p50,
+           (unsigned long long)tick.p90, (unsigned long long)tick.p99, (unsigned long long)tick.max);
+    const char* json = Bench::ArgStr(argc, argv, "--metrics-json", nullptr);
+    const char* csv = Bench::ArgStr(argc, argv, "--metrics-csv", nullptr);
+    if (json && !Metrics::ExportJson(snap, std::wstring(json, json + strlen(json)))) printf("error: could not write %s\n", json);
+    if (csv && !Metrics::ExportCsv(snap, std::wstring(csv, csv + strlen(csv)))) printf("error: could not write %s\n", csv);
+
+    g_FocusResolver.Stop();
+    return 0;
+}
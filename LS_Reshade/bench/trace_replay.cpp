@@ -0,0 +1,228 @@
+// Event traces on the fake backend. `record` runs a scripted session (a
+// 1000 Hz mouse over the overlay, 10 ms worker ticks, a hotkey toggle on and
+// off) with the trace recorder on. `replay` feeds a trace, recorded here or
+// with Start Trace in the addon, back into the worker and the hook on a
+// virtual clock, re-recording it, and prints recorded against replayed
+// counts and timings; replaying one trace with two builds compares them.
+// `dump` prints the records.
+//
+//   trace_replay record FILE [--seconds S] [--children N] [--records N]
+//   trace_replay replay FILE [--out FILE] [--children N]
+//   trace_replay dump FILE [--limit N]
+#include "bench_common.hpp"
+#include "trace_recorder.hpp"
+#include "window_manager.hpp"
+#include "focus_resolver.hpp"
+#include "hotkey_engine.hpp"
+#include "input_scheduler.hpp"
+#include "settings.hpp"
+#include "worker.hpp"
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+
+namespace {
+    const char* const kKindNames[TraceKindCount] = {
+        "?", "tick", "refresh", "hook", "mutations", "key", "toggle", "input", "window_event",
+    };
+
+    std::wstring Wide(const char* s) { return std::filesystem::path(s).wstring(); }
+
+    struct KindStats {
+        uint64_t count = 0;
+        std::vector<uint64_t> values; // ns, for the timed kinds
+    };
+
+    void Collect(const std::vector<TraceRecord>& records, KindStats (&out)[TraceKindCount]) {
+        for (const TraceRecord& r : records) {
+            KindStats& k = out[r.kind];
+            ++k.count;
+            if (r.kind == TraceTick || r.kind == TraceHook || r.kind == TraceMutations) k.values.push_back(r.value);
+        }
+    }
+
+    // A session on the fake: the worker and the hook, as on Windows.
+    struct Session {
+        FakeWindowSystem sys;
+        Bench::Scene scene;
+        WorkerState state;
+
+        explicit Session(int children) {
+            g_WindowSystem = &sys;
+            scene = Bench::BuildScene(sys, 200, children);
+            g_Settings.SetValues(SettingsValues());
+            g_Settings.SetPassthrough(false);
+            g_FocusResolver.Start();
+            g_Hotkeys.Start();
+        }
+        ~Session() {
+            g_InputScheduler.CancelAll();
+            g_Hotkeys.Stop();
+            g_FocusResolver.Stop();
+            g_Settings.SetPassthrough(false);
+            WindowManager::RestoreAll();
+        }
+    };
+
+    int Record(const char* path, int seconds, int children, size_t records) {
+        Session s(children);
+        if (!g_Trace.Start(Wide(path), records)) {
+            printf("error: could not map %s\n", path);
+            return 1;
+        }
+        const WORD vk = (WORD)SettingsValues().hotkeyVk;
+        const uint64_t end = (uint64_t)seconds * 1000;
+        for (uint64_t ms = 0; ms < end; ++ms) {
+            // Press the hotkey half a second in and half a second before the end.
+            if (ms == 500 || ms + 500 == end) s.sys.SetKey(vk, true);
+            if (ms == 550 || ms + 450 == end) s.sys.SetKey(vk, false);
+            // Every 10 ms, and early for the next input step, as the worker wakes.
+            if (ms % 10 == 0 || g_InputScheduler.NextDue() <= ms) WorkerTick(s.state, ms);
+            HWND over = (ms % 4 == 0) ? s.scene.lsWindow : s.scene.lsChildren[(ms / 4) % s.scene.lsChildren.size()];
+            s.sys.Dispatch(over, WM_NCHITTEST);
+            s.sys.Dispatch(over, WM_SETCURSOR);
+            s.sys.Dispatch(over, WM_MOUSEMOVE);
+        }
+        uint64_t written = g_Trace.Written();
+        g_Trace.Stop();
+        printf("trace_replay record: %d s, %zu windows, %llu events (ring of %zu) -> %s\n", seconds,
+               s.sys.WindowCount(), (unsigned long long)written, g_Trace.Capacity(), path);
+        return 0;
+    }
+
+    int Replay(const char* path, const char* outPath, int children) {
+        std::vector<TraceRecord> recorded;
+        uint64_t lost = 0;
+        if (!TraceRecorder::Load(Wide(path), recorded, &lost)) {
+            printf("error: %s is not a trace\n", path);
+            return 1;
+        }
+        std::filesystem::path out = outPath ? std::filesystem::path(outPath)
+                                            : std::filesystem::temp_directory_path() / "trace_replay.trace";
+
+        Session s(children);
+        // Recorded handles map to the scene's LS windows in order of first use.
+        std::unordered_map<uint32_t, HWND> windows;
+        auto map = [&](uint32_t hwnd) {
+            auto it = windows.find(hwnd);
+            if (it != windows.end()) return it->second;
+            size_t n = windows.size();
+            HWND mapped;
+            if (n == 0) {
+                mapped = s.scene.lsWindow;
+            } else if (n - 1 < s.scene.lsChildren.size()) {
+                mapped = s.scene.lsChildren[n - 1];
+            } else {
+                FakeWindowSystem::WindowDesc c;
+                c.pid = s.sys.CurrentProcessId(); c.tid = 2; c.parent = s.scene.lsWindow; c.className = "Static";
+                mapped = s.sys.AddWindow(c);
+            }
+            windows.emplace(hwnd, mapped);
+            return mapped;
+        };
+
+        if (!g_Trace.Start(out.wstring())) {
+            printf("error: could not map %s\n", out.string().c_str());
+            return 1;
+        }
+        // The ring may have cut the trace mid-session: start from the
+        // passthrough state of its first tick.
+        for (const TraceRecord& r : recorded) {
+            if (r.kind != TraceTick) continue;
+            g_Settings.SetPassthrough((r.flags & 1) != 0);
+            break;
+        }
+        s.sys.ResetCounters();
+        uint64_t ticks = 0;
+        uint64_t start = Bench::NowNs();
+        for (const TraceRecord& r : recorded) {
+            switch (r.kind) {
+            case TraceKey:
+                // Our own SendInput shows up again as the replayed worker sends it.
+                if (!(r.flags & 2)) s.sys.SetKey(r.small, (r.flags & 1) != 0);
+                break;
+            case TraceTick:
+                WorkerTick(s.state, r.arg);
+                ++ticks;
+                break;
+            case TraceHook:
+                s.sys.Dispatch(map(r.hwnd), r.small);
+                break;
+            default:
+                break; // outcomes, compared below
+            }
+        }
+        uint64_t elapsed = Bench::NowNs() - start;
+        g_Trace.Stop();
+
+        std::vector<TraceRecord> replayed;
+        TraceRecorder::Load(out.wstring(), replayed);
+        KindStats before[TraceKindCount], after[TraceKindCount];
+        Collect(recorded, before);
+        Collect(replayed, after);
+
+        printf("trace_replay: %zu events (%llu lost), %zu LS windows, replayed in %.1f ms\n", recorded.size(),
+               (unsigned long long)lost, windows.size(), elapsed / 1e6);
+        printf("%-14s %10s %10s %12s %12s %12s %12s\n", "kind", "recorded", "replayed", "rec p50 ns", "rep p50 ns",
+               "rec p99 ns", "rep p99 ns");
+        for (int k = 1; k < TraceKindCount; ++k) {
+            if (!before[k].count && !after[k].count) continue;
+            printf("%-14s %10llu %10llu", kKindNames[k], (unsigned long long)before[k].count,
+                   (unsigned long long)after[k].count);
+            if (!before[k].values.empty() || !after[k].values.empty()) {
+                Bench::Summary b = Bench::Summarize(before[k].values), a = Bench::Summarize(after[k].values);
+                printf(" %12llu %12llu %12llu %12llu", (unsigned long long)b.p50, (unsigned long long)a.p50,
+                       (unsigned long long)b.p99, (unsigned long long)a.p99);
+            }
+            printf("\n");
+        }
+        if (ticks) {
+            printf("calls/tick            %.2f\n", s.sys.TotalCalls() / (double)ticks);
+            Bench::PrintCalls(s.sys, (double)ticks);
+        }
+        if (outPath) printf("replay trace -> %s\n", outPath);
+        else std::filesystem::remove(out);
+
+        // The same input must lead to the same toggles.
+        if (before[TraceToggle].count != after[TraceToggle].count) {
+            printf("error: replay toggled %llu times, the trace %llu\n", (unsigned long long)after[TraceToggle].count,
+                   (unsigned long long)before[TraceToggle].count);
+            return 1;
+        }
+        return 0;
+    }
+
+    int Dump(const char* path, long limit) {
+        std::vector<TraceRecord> records;
+        uint64_t lost = 0;
+        if (!TraceRecorder::Load(Wide(path), records, &lost)) {
+            printf("error: %s is not a trace\n", path);
+            return 1;
+        }
+        printf("# %zu events, %llu lost\n# seq ns kind hwnd small arg flags value\n", records.size(), (unsigned long long)lost);
+        for (size_t i = 0; i < records.size() && (limit < 0 || (long)i < limit); ++i) {
+            const TraceRecord& r = records[i];
+            printf("%u %llu %s 0x%x %u %u %u %llu\n", r.seq, (unsigned long long)r.ns, kKindNames[r.kind], r.hwnd,
+                   r.small, r.arg, r.flags, (unsigned long long)r.value);
+        }
+        return 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        printf("usage: trace_replay record|replay|dump FILE [options]\n");
+        return 2;
+    }
+    const std::string mode = argv[1];
+    const char* path = argv[2];
+    const int children = (int)Bench::ArgInt(argc, argv, "--children", 64);
+    if (mode == "record") {
+        return Record(path, (int)Bench::ArgInt(argc, argv, "--seconds", 5), children,
+                      (size_t)Bench::ArgInt(argc, argv, "--records", (long)TraceRecorder::kDefaultRecords));
+    }
+    if (mode == "replay") return Replay(path, Bench::ArgStr(argc, argv, "--out", nullptr), children);
+    if (mode == "dump") return Dump(path, Bench::ArgInt(argc, argv, "--limit", -1));
+    printf("unknown mode %s\n", argv[1]);
+    return 2;
+}
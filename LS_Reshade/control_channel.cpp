@@ -0,0 +1,247 @@
+#include "control_channel.hpp"
+#include <chrono>
+#include <filesystem>
+#include <new>
+#include <thread>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+ControlChannel g_Control;
+
+namespace {
+    // How clients in the serving process wake the worker (POSIX stand-in).
+    std::atomic<void (*)()> s_localWake{ nullptr };
+
+    // Client wait: yield this many times, then sleep, doubling up to the
+    // longest sleep; ring the worker again every kReringMs.
+    const uint32_t kWaitSpins = 64;
+    const auto kFirstSleep = std::chrono::microseconds(50);
+    const auto kLongestSleep = std::chrono::microseconds(2000);
+    const auto kReringEvery = std::chrono::milliseconds(100);
+
+    uint64_t SteadyMs() {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    DWORD CurrentPid() {
+#ifdef _WIN32
+        return ::GetCurrentProcessId();
+#else
+        return (DWORD)getpid();
+#endif
+    }
+}
+
+bool ControlChannel::Open(const std::wstring& path) {
+    Close();
+    if (!m_file.Open(path, true) || !m_file.Map(sizeof(Mailbox))) {
+        m_file.Close();
+        return false;
+    }
+    // Taken over as it is: a client of a previous session that is still
+    // waiting times out.
+    Mailbox* box = new (m_file.Data()) Mailbox();
+    box->version = kVersion;
+    box->slotCount = (uint16_t)kSlots;
+    box->serverPid = CurrentPid();
+    box->serverThread.store(m_serverThread, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    box->magic = kMagic;
+    m_box = box;
+    for (Held& h : m_held) h = Held();
+    m_stalled = false;
+    return true;
+}
+
+void ControlChannel::Close() {
+    if (m_box) m_box->serverThread.store(0, std::memory_order_release);
+    m_box = nullptr;
+    m_file.Close();
+}
+
+void ControlChannel::SetServer(DWORD threadId, void (*wake)()) {
+    m_serverThread = threadId;
+    s_localWake.store(wake, std::memory_order_release);
+    if (m_box) m_box->serverThread.store(threadId, std::memory_order_release);
+}
+
+ControlChannel::Stats ControlChannel::GetStats() const {
+    Stats s;
+    s.served = m_box ? m_box->served.load(std::memory_order_relaxed) : 0;
+    s.abandoned = m_abandoned.load(std::memory_order_relaxed);
+    s.recovered = m_recovered.load(std::memory_order_relaxed);
+    return s;
+}
+
+bool ControlChannel::Take(uint64_t entry, Slot*& slot) {
+    uint32_t index = (uint32_t)entry;
+    if (index >= kSlots) return false;
+    slot = &m_box->slots[index];
+    uint32_t queued = SlotQueued;
+    if (!slot->state.compare_exchange_strong(queued, SlotServing, std::memory_order_acquire)) {
+        m_abandoned.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    if (slot->ticket != (uint32_t)(entry >> 32)) {
+        // A stale entry of a withdrawn request; the slot's own entry is
+        // still queued.
+        slot->state.store(SlotQueued, std::memory_order_release);
+        m_abandoned.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+void ControlChannel::Finish(Slot& slot) {
+    slot.state.store(SlotDone, std::memory_order_release);
+    m_box->served.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool ControlChannel::Recover() {
+    const uint64_t now = SteadyMs();
+    // Slots: the same request (state and ticket) seen for kAbandonMs.
+    for (size_t i = 0; i < kSlots; ++i) {
+        Slot& slot = m_box->slots[i];
+        uint32_t state = slot.state.load(std::memory_order_acquire);
+        Held& held = m_held[i];
+        if (state == SlotFree || state == SlotServing) {
+            held.key = 0;
+            continue;
+        }
+        const uint64_t key = (uint64_t)state << 32 | slot.ticket;
+        if (key != held.key) {
+            held = { key, now };
+            continue;
+        }
+        if (now - held.sinceMs < kAbandonMs) continue;
+        if (slot.state.compare_exchange_strong(state, SlotFree, std::memory_order_acq_rel)) {
+            m_recovered.fetch_add(1, std::memory_order_relaxed);
+        }
+        held.key = 0;
+    }
+
+    // The queue: its oldest cell claimed but not published for kStallMs.
+    size_t position;
+    if (!m_box->queue.Stalled(position)) {
+        m_stalled = false;
+        return false;
+    }
+    if (!m_stalled || position != m_stallPosition) {
+        m_stalled = true;
+        m_stallPosition = position;
+        m_stallSinceMs = now;
+        return false;
+    }
+    if (now - m_stallSinceMs < kStallMs) return false;
+    m_box->queue.Skip();
+    m_stalled = false;
+    m_recovered.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+// --- Client ---
+
+bool ControlClient::Connect(const std::wstring& path) {
+    Disconnect();
+    std::error_code ec;
+    if (!std::filesystem::exists(std::filesystem::path(path), ec)) return false; // not created by a client
+    if (!m_file.Open(path, true) || m_file.OpenedSize() < sizeof(ControlChannel::Mailbox) ||
+        !m_file.Map(sizeof(ControlChannel::Mailbox))) {
+        m_file.Close();
+        return false;
+    }
+    ControlChannel::Mailbox* box = (ControlChannel::Mailbox*)m_file.Data();
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (box->magic != ControlChannel::kMagic || box->version != ControlChannel::kVersion ||
+        box->slotCount != ControlChannel::kSlots) {
+        m_file.Close();
+        return false;
+    }
+    m_box = box;
+    return true;
+}
+
+void ControlClient::Disconnect() {
+    m_box = nullptr;
+    m_file.Close();
+}
+
+void ControlClient::Ring() {
+#ifdef _WIN32
+    // The worker's event wait returns for any message to its thread.
+    ::PostThreadMessageW(m_box->serverThread.load(std::memory_order_acquire), WM_NULL, 0, 0);
+#else
+    if (m_box->serverPid != CurrentPid()) return; // served on the worker's next tick
+    if (void (*wake)() = s_localWake.load(std::memory_order_acquire)) wake();
+#endif
+}
+
+ControlResult ControlClient::Send(const ControlRequest& request, ControlReply& reply, uint32_t timeoutMs) {
+    typedef ControlChannel C;
+    if (!m_box || m_box->serverThread.load(std::memory_order_acquire) == 0) return ControlNoServer;
+
+    C::Slot* slot = nullptr;
+    uint32_t index = 0;
+    for (; index < C::kSlots; ++index) {
+        uint32_t free = C::SlotFree;
+        if (m_box->slots[index].state.compare_exchange_strong(free, C::SlotClaimed, std::memory_order_acquire)) {
+            slot = &m_box->slots[index];
+            break;
+        }
+    }
+    if (!slot) {
+        Ring(); // lets the worker free the slots of dead clients
+        return ControlBusy;
+    }
+    slot->request = request;
+    uint32_t ticket = m_box->tickets.fetch_add(1, std::memory_order_relaxed) + 1;
+    slot->ticket = ticket;
+    slot->state.store(C::SlotQueued, std::memory_order_release);
+    if (!m_box->queue.TryPush([&](uint64_t& e) { e = (uint64_t)ticket << 32 | index; })) {
+        // Only our own entry could make it Serving, and it was never queued.
+        slot->state.store(C::SlotFree, std::memory_order_release);
+        Ring();
+        return ControlBusy;
+    }
+    Ring();
+
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point now = Clock::now();
+    Clock::time_point deadline = now + std::chrono::milliseconds(timeoutMs);
+    Clock::time_point rering = now + kReringEvery;
+    bool serving = false;
+    auto sleep = kFirstSleep;
+    for (uint32_t spins = 0;; ++spins) {
+        uint32_t state = slot->state.load(std::memory_order_acquire);
+        if (state == C::SlotDone) break;
+        // Freed or reused after the worker took us for dead.
+        if ((state != C::SlotQueued && state != C::SlotServing) || slot->ticket != ticket) return ControlTimeout;
+        if (spins < kWaitSpins) {
+            std::this_thread::yield();
+            continue;
+        }
+        now = Clock::now();
+        if (now >= deadline) {
+            if (serving) return ControlTimeout; // the worker frees the slot once it is done
+            // Withdraw it unless the worker already took it.
+            uint32_t queued = C::SlotQueued;
+            if (slot->state.compare_exchange_strong(queued, C::SlotFree, std::memory_order_acq_rel)) {
+                return ControlTimeout;
+            }
+            serving = true; // being served: give it one more timeout
+            deadline = now + std::chrono::milliseconds(timeoutMs);
+        }
+        if (now >= rering) {
+            Ring();
+            rering = now + kReringEvery;
+        }
+        std::this_thread::sleep_for(sleep);
+        if (sleep < kLongestSleep) sleep *= 2;
+    }
+    if (slot->ticket != ticket) return ControlTimeout;
+    reply = slot->reply;
+    slot->state.store(C::SlotFree, std::memory_order_release);
+    return (ControlResult)reply.result;
+}
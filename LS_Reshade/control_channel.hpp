@@ -0,0 +1,201 @@
+#pragma once
+#include "platform.hpp"
+#include "mapped_file.hpp"
+#include "metrics.hpp"
+#include "mpsc_ring.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// --- Control Channel ---
+// Lets other processes (macro pads, scripts, the ls_control tool) toggle
+// passthrough, change the hotkey settings and read the state and metrics.
+// The channel is a mailbox in a shared memory-mapped file (control.mailbox
+// next to config.ini): a client claims a request slot, queues its index on a
+// lock-free ring and wakes the worker, which serves the queue on its next
+// tick and writes the reply into the slot. No thread is added and nothing
+// polls: on Windows the wake is a thread message to the worker, which its
+// event wait already returns for. The POSIX stand-in (the fake backend) can
+// only wake the worker from inside the serving process; requests from other
+// processes wait for its next tick.
+//
+// A client may be killed at any point. The worker frees what it leaves
+// behind: a queue cell claimed but never published (which would block every
+// request behind it) after kStallMs, and a slot the same request has held
+// for kAbandonMs. Clients wait with a backoff that sleeps, ring again while
+// they wait, and give up after at most twice their timeout, even if the
+// request is still being served.
+//
+// The mailbox holds std::atomic and size_t fields, so clients must be built
+// from this header for the same architecture as the addon.
+
+enum ControlCommand : uint32_t {
+    ControlGetState = 1,
+    ControlToggle,         // as the hotkey does (the focused LS window), including auto click & repress
+    ControlSetPassthrough, // arg: 0 off, 1 on; toggles only if the focused LS window's state differs
+    ControlSetConfig,      // hotkeyVk, mods, autoClickRepress
+    ControlGetMetrics,
+};
+
+enum ControlResult : uint32_t {
+    ControlOk = 0,
+    ControlRefused,  // toggle not possible now (no valid focus, or our own input is running)
+    ControlInvalid,  // unknown command or bad argument
+    ControlBusy,     // every slot or the queue is taken
+    ControlTimeout,  // nobody served the request in time
+    ControlNoServer, // no mailbox, or no addon serving it
+};
+
+struct ControlRequest {
+    uint32_t command;
+    uint32_t arg;
+    int32_t hotkeyVk;
+    uint8_t mods; // HotkeyChord::Mods
+    uint8_t autoClickRepress;
+    uint8_t reserved[2];
+};
+
+struct ControlState {
+    uint64_t epoch; // settings epoch: changes with every published change
+    int32_t hotkeyVk;
+    uint8_t mods;
+    uint8_t autoClickRepress;
+    uint8_t passthrough;    // on for any LS window
+    uint8_t activeSessions; // LS windows with passthrough on
+};
+
+struct ControlMetrics {
+    struct Dist {
+        uint64_t count, p50, p99, max;
+    };
+    double seconds; // since the last reset
+    Dist dists[MetricsSnapshot::kDists];     // in MetricsSnapshot order
+    uint64_t counts[MetricsSnapshot::kCounts];
+};
+
+struct ControlReply {
+    uint32_t result; // ControlResult
+    uint32_t reserved;
+    ControlState state; // after the command
+    ControlMetrics metrics; // ControlGetMetrics only
+};
+
+class ControlChannel {
+public:
+    static const uint32_t kMagic = 0x4352534C; // "LSRC"
+    static const uint16_t kVersion = 1;
+    static const size_t kSlots = 16;
+    // A claimed queue cell is published right after; one that is not after
+    // this long belongs to a dead client and is skipped.
+    static const uint32_t kStallMs = 1000;
+    // A slot held this long by one request that is neither served nor
+    // collected belongs to a dead client and is freed.
+    static const uint32_t kAbandonMs = 10000;
+
+    struct Stats {
+        uint64_t served;
+        uint64_t abandoned; // requests whose client gave up first
+        uint64_t recovered; // queue cells and slots freed after dead clients
+    };
+
+    // Serves `handler(const ControlRequest&, ControlReply&)` for every queued
+    // request; the reply is zeroed first. Worker thread only.
+    template<typename Handler>
+    size_t Serve(Handler&& handler);
+
+    // Creates or takes over the mailbox at `path`.
+    bool Open(const std::wstring& path);
+    void Close();
+    bool IsOpen() const { return m_box != nullptr; }
+    // The thread that serves the mailbox (0 when none) and, for clients in
+    // this process, how to wake it.
+    void SetServer(DWORD threadId, void (*wake)());
+    Stats GetStats() const;
+
+    // --- Shared layout ---
+    enum SlotState : uint32_t { SlotFree, SlotClaimed, SlotQueued, SlotServing, SlotDone };
+
+    struct Slot {
+        std::atomic<uint32_t> state;
+        uint32_t ticket; // matches the queued entry; a reused slot gets a new one
+        ControlRequest request;
+        ControlReply reply;
+    };
+
+    struct Mailbox {
+        uint32_t magic; // stored last when the mailbox is set up
+        uint16_t version;
+        uint16_t slotCount;
+        uint32_t serverPid;
+        std::atomic<uint32_t> serverThread;
+        std::atomic<uint32_t> tickets;
+        std::atomic<uint64_t> served;
+        Slot slots[kSlots];
+        // ticket << 32 | slot. Twice the slots: entries of abandoned requests
+        // stay queued until the next Serve skips them.
+        MpscRing<uint64_t, kSlots * 2> queue;
+    };
+
+private:
+    bool Take(uint64_t entry, Slot*& slot);
+    void Finish(Slot& slot);
+    // Frees what dead clients left behind; true if the queue moved past a
+    // stalled cell (serve again).
+    bool Recover();
+
+    MappedFile m_file;
+    Mailbox* m_box = nullptr;
+    DWORD m_serverThread = 0;
+    std::atomic<uint64_t> m_abandoned{ 0 };
+    std::atomic<uint64_t> m_recovered{ 0 };
+
+    // Worker thread only: what Recover saw, and since when.
+    struct Held {
+        uint64_t key; // state << 32 | ticket; 0 while free or being served
+        uint64_t sinceMs;
+    };
+    Held m_held[kSlots] = {};
+    bool m_stalled = false;
+    size_t m_stallPosition = 0;
+    uint64_t m_stallSinceMs = 0;
+};
+
+extern ControlChannel g_Control;
+
+// The client side: maps the mailbox of a running addon and sends requests.
+// Any number of clients, in any processes, may share one mailbox.
+class ControlClient {
+public:
+    bool Connect(const std::wstring& path);
+    void Disconnect();
+    // Sends one request and waits up to `timeoutMs` for its reply (twice
+    // that if the worker has started on it by then).
+    ControlResult Send(const ControlRequest& request, ControlReply& reply, uint32_t timeoutMs = 1000);
+
+private:
+    void Ring();
+
+    MappedFile m_file;
+    ControlChannel::Mailbox* m_box = nullptr;
+};
+
+template<typename Handler>
+size_t ControlChannel::Serve(Handler&& handler) {
+    if (!m_box) return 0;
+    size_t n = 0;
+    uint64_t entry;
+    for (;;) {
+        if (!m_box->queue.TryPop([&](uint64_t& e) { entry = e; })) {
+            if (Recover()) continue;
+            break;
+        }
+        Slot* slot;
+        if (!Take(entry, slot)) continue;
+        slot->reply = ControlReply();
+        handler((const ControlRequest&)slot->request, slot->reply);
+        Finish(*slot);
+        ++n;
+    }
+    return n;
+}
@@ -0,0 +1,64 @@
+#include "cursor_manager.hpp"
+
+CursorManager g_Cursor;
+
+void CursorManager::Enforce(IWindowSystem* sys) {
+    Count(m_enforced);
+    uint32_t stale = m_stale.exchange(0, std::memory_order_relaxed);
+    // Before, every message made three calls: SetCursor, GetCursorInfo and
+    // ClipCursor.
+    uint64_t calls = 0;
+    if (stale & StaleShape) {
+        sys->SetArrowCursor();
+        ++calls;
+    }
+    if (stale & StaleVisibility) {
+        ++calls;
+        if (!sys->IsCursorShowing()) {
+            while (sys->ShowCursor(true) < 0) ++calls;
+            ++calls;
+        }
+    }
+    if (stale & StaleClip) {
+        sys->ReleaseCursorClip();
+        ++calls;
+    }
+    Count(m_calls, calls);
+    if (calls < 3) Count(m_avoided, 3 - calls);
+}
+
+void CursorManager::Revalidate(IWindowSystem* sys) {
+    Count(m_revalidated);
+    CursorState state = sys->QueryCursor();
+    uint64_t calls = 1;
+    uint32_t stale = 0;
+    if (!state.arrow) stale |= StaleShape;
+    if (!state.showing) stale |= StaleVisibility;
+    if (state.clipped) {
+        sys->ReleaseCursorClip();
+        ++calls;
+        Count(m_reclips);
+    } else {
+        Count(m_avoided); // the unconditional ClipCursor(NULL)
+    }
+    if (stale) m_stale.fetch_or(stale, std::memory_order_relaxed);
+    Count(m_calls, calls);
+}
+
+CursorManager::Stats CursorManager::GetStats() const {
+    Stats s;
+    s.enforced = m_enforced.load(std::memory_order_relaxed);
+    s.revalidated = m_revalidated.load(std::memory_order_relaxed);
+    s.calls = m_calls.load(std::memory_order_relaxed);
+    s.avoided = m_avoided.load(std::memory_order_relaxed);
+    s.reclips = m_reclips.load(std::memory_order_relaxed);
+    return s;
+}
+
+void CursorManager::ResetStats() {
+    m_enforced = 0;
+    m_revalidated = 0;
+    m_calls = 0;
+    m_avoided = 0;
+    m_reclips = 0;
+}
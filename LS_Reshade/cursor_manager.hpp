@@ -0,0 +1,50 @@
+#pragma once
+#include "window_system.hpp"
+#include <atomic>
+#include <cstdint>
+
+// Keeps the cursor usable while passthrough is on without touching it on
+// every mouse message. It remembers which of shape, visibility and clip are
+// known to be right; HookProc fixes only the ones marked stale, and the
+// worker's periodic Revalidate() reads the cursor once and marks whatever
+// the game (or anything else) changed. A re-clip is released by the worker
+// directly, since clipping is system-wide.
+class CursorManager {
+public:
+    struct Stats {
+        uint64_t enforced;    // mouse messages handled by Enforce()
+        uint64_t revalidated; // worker checks
+        uint64_t calls;       // cursor API calls made
+        uint64_t avoided;     // calls the per-message path would have made
+        uint64_t reclips;     // clips found and released by the worker
+    };
+
+    // On WM_SETCURSOR / WM_MOUSEMOVE with passthrough on (window thread).
+    void Enforce(IWindowSystem* sys);
+    // Once per active worker tick.
+    void Revalidate(IWindowSystem* sys);
+    // Forget everything, e.g. when passthrough turns on.
+    void Invalidate() { m_stale.store(StaleAll, std::memory_order_relaxed); }
+
+    Stats GetStats() const;
+    void ResetStats();
+
+private:
+    enum Stale : uint32_t {
+        StaleShape = 1 << 0,
+        StaleVisibility = 1 << 1,
+        StaleClip = 1 << 2,
+        StaleAll = StaleShape | StaleVisibility | StaleClip,
+    };
+
+    void Count(std::atomic<uint64_t>& counter, uint64_t n = 1) { counter.fetch_add(n, std::memory_order_relaxed); }
+
+    std::atomic<uint32_t> m_stale{ StaleAll };
+    std::atomic<uint64_t> m_enforced{ 0 };
+    std::atomic<uint64_t> m_revalidated{ 0 };
+    std::atomic<uint64_t> m_calls{ 0 };
+    std::atomic<uint64_t> m_avoided{ 0 };
+    std::atomic<uint64_t> m_reclips{ 0 };
+};
+
+extern CursorManager g_Cursor;
@@ -0,0 +1,742 @@
+#include "fake_window_system.hpp"
+#include <chrono>
+#include <cstring>
+
+namespace {
+    const char* const kApiNames[FakeWindowSystem::ApiCount] = {
+        "GetWindowThread", "EnumTopLevel", "EnumChildren", "EnumThreadTopLevel", "NextWindow",
+        "IsAlive", "IsVisible", "GetClass", "GetTitle", "GetProcessName",
+        "GetLong", "SetLong", "SetPos", "ApplyMutations",
+        "WatchEvents", "PumpEvents", "WatchKeys", "WaitEvents", "PostWake",
+        "GetForeground", "SetForeground", "BringToTop", "AttachInput",
+        "CallProc", "DefProc", "IsKeyDown", "SendInputs",
+        "SetArrowCursor", "IsCursorShowing", "QueryCursor", "ShowCursor", "ReleaseCursorClip",
+    };
+
+    // Handle layout: [generation:16][slot+1:16]. Slot 0xFFFF is never handed out.
+    // Set while a posted message runs, so the handler sees its window's thread.
+    thread_local DWORD t_ownerThread = 0;
+
+    HWND MakeHandle(uint32_t slot, uint16_t generation) {
+        return (HWND)(uintptr_t)(((uintptr_t)generation << 16) | (slot + 1));
+    }
+}
+
+const char* FakeWindowSystem::ApiName(Api api) {
+    return api < ApiCount ? kApiNames[api] : "?";
+}
+
+FakeWindowSystem::FakeWindowSystem(DWORD processId, DWORD threadId)
+    : m_processId(processId), m_threadId(threadId) {}
+
+LRESULT CALLBACK FakeWindowSystem::DefaultProc(HWND, UINT msg, WPARAM, LPARAM) {
+    return msg == WM_NCHITTEST ? HTCLIENT : 0;
+}
+
+FakeWindowSystem::Window* FakeWindowSystem::Lookup(HWND hwnd) {
+    uintptr_t v = (uintptr_t)hwnd;
+    if (v == 0 || v > 0xFFFFFFFFu) return nullptr;
+    uint32_t slot = (uint32_t)(v & 0xFFFF) - 1;
+    if (slot >= m_windows.size()) return nullptr;
+    Window& w = m_windows[slot];
+    if (!w.alive || w.generation != (uint16_t)(v >> 16)) return nullptr;
+    return &w;
+}
+
+void FakeWindowSystem::Unlink(HWND hwnd, Window& w) {
+    if (w.parent) return;
+    if (w.zPrev) Lookup(w.zPrev)->zNext = w.zNext;
+    else if (m_zTop == hwnd) m_zTop = w.zNext;
+    if (w.zNext) Lookup(w.zNext)->zPrev = w.zPrev;
+    w.zPrev = w.zNext = nullptr;
+}
+
+void FakeWindowSystem::LinkAfter(HWND hwnd, Window& w, HWND after) {
+    if (w.parent) return;
+    Window* a = after ? Lookup(after) : nullptr;
+    if (!a || a->parent) {
+        w.zPrev = nullptr;
+        w.zNext = m_zTop;
+        if (m_zTop) Lookup(m_zTop)->zPrev = hwnd;
+        m_zTop = hwnd;
+        return;
+    }
+    w.zPrev = after;
+    w.zNext = a->zNext;
+    if (a->zNext) Lookup(a->zNext)->zPrev = hwnd;
+    a->zNext = hwnd;
+}
+
+void FakeWindowSystem::CollectDescendants(const Window& w, std::vector<HWND>& out) {
+    for (HWND c : w.children) {
+        out.push_back(c);
+        if (Window* cw = Lookup(c)) CollectDescendants(*cw, out);
+    }
+}
+
+void FakeWindowSystem::Emit(WindowEvent event, HWND hwnd) {
+    EventProc proc;
+    void* ctx;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        proc = m_eventProc;
+        ctx = m_eventCtx;
+    }
+    if (proc) proc(event, hwnd, ctx);
+}
+
+// --- Simulation control ---
+
+HWND FakeWindowSystem::AddWindow(const WindowDesc& desc) {
+    HWND hwnd = AddWindowLocked(desc);
+    if (hwnd && !desc.parent && (desc.style & WS_VISIBLE)) Emit(WindowEventZOrder, hwnd);
+    return hwnd;
+}
+
+HWND FakeWindowSystem::AddWindowLocked(const WindowDesc& desc) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint32_t slot;
+    if (!m_freeSlots.empty()) {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    } else {
+        if (m_windows.size() >= 0xFFFE) return nullptr;
+        slot = (uint32_t)m_windows.size();
+        m_windows.emplace_back();
+    }
+    Window& w = m_windows[slot];
+    uint16_t generation = (uint16_t)(w.generation + 1);
+    w = Window();
+    w.alive = true;
+    w.generation = generation;
+    w.pid = desc.pid;
+    w.tid = desc.tid;
+    w.style = desc.style;
+    w.exStyle = desc.exStyle;
+    w.proc = desc.proc ? desc.proc : DefaultProc;
+    w.className = desc.className ? desc.className : "";
+    w.title = desc.title ? desc.title : "";
+    HWND hwnd = MakeHandle(slot, generation);
+
+    Window* parent = desc.parent ? Lookup(desc.parent) : nullptr;
+    if (parent) {
+        w.parent = desc.parent;
+        parent->children.push_back(hwnd);
+    } else {
+        LinkAfter(hwnd, w, nullptr);
+    }
+    ++m_liveCount;
+    return hwnd;
+}
+
+void FakeWindowSystem::RemoveWindow(HWND hwnd) {
+    std::vector<HWND> doomed;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Window* w = Lookup(hwnd);
+        if (!w) return;
+        CollectDescendants(*w, doomed);
+        doomed.push_back(hwnd);
+    }
+    // Children are destroyed before their parent, each one's current
+    // procedure sees WM_NCDESTROY while the handle is still valid.
+    for (HWND h : doomed) Dispatch(h, WM_NCDESTROY);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (HWND h : doomed) {
+            Window* w = Lookup(h);
+            if (!w) continue;
+            if (w->parent) {
+                if (Window* p = Lookup(w->parent)) {
+                    auto& siblings = p->children;
+                    for (size_t i = 0; i < siblings.size(); ++i) {
+                        if (siblings[i] == h) { siblings.erase(siblings.begin() + i); break; }
+                    }
+                }
+            } else {
+                Unlink(h, *w);
+            }
+            if (m_foreground == h) m_foreground = nullptr;
+            w->alive = false;
+            w->children.clear();
+            m_freeSlots.push_back((uint32_t)(((uintptr_t)h & 0xFFFF) - 1));
+            --m_liveCount;
+        }
+    }
+    for (HWND h : doomed) Emit(WindowEventDestroy, h);
+}
+
+void FakeWindowSystem::PlaceAfter(HWND hwnd, HWND after) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Window* w = Lookup(hwnd);
+        if (!w || w->parent || hwnd == after) return;
+        Unlink(hwnd, *w);
+        LinkAfter(hwnd, *w, after);
+    }
+    Emit(WindowEventZOrder, hwnd);
+}
+
+void FakeWindowSystem::Focus(HWND hwnd) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_foreground = Lookup(hwnd) ? hwnd : nullptr;
+    }
+    Emit(WindowEventForeground, hwnd);
+}
+
+void FakeWindowSystem::SetTitle(HWND hwnd, const char* title) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Window* w = Lookup(hwnd);
+        if (!w) return;
+        w->title = title ? title : "";
+    }
+    Emit(WindowEventNameChange, hwnd);
+}
+
+void FakeWindowSystem::SetProcessName(DWORD pid, const char* name) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& p : m_processNames) {
+        if (p.first == pid) { p.second = name; return; }
+    }
+    m_processNames.emplace_back(pid, name);
+}
+
+void FakeWindowSystem::SetKey(int vk, bool down) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_keys[vk & 0xFF] = down;
+    if (m_keyProc && m_keysLive) {
+        m_pendingKeys.push_back({ (WORD)(vk & 0xFF), down, false });
+        m_wakeCv.notify_all();
+    }
+}
+
+void FakeWindowSystem::InjectKey(int vk, bool down, uintptr_t extraInfo) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_keys[vk & 0xFF] = down;
+    if (m_keyProc && m_keysLive) {
+        m_pendingKeys.push_back({ (WORD)(vk & 0xFF), down, extraInfo == kInputSignature });
+        m_wakeCv.notify_all();
+    }
+}
+
+void FakeWindowSystem::LoseKeyWatch() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_keysLive = false;
+    m_pendingKeys.clear();
+    m_wakePending = true; // the backend wakes the watcher to start polling
+    m_wakeCv.notify_all();
+}
+
+size_t FakeWindowSystem::PendingKeyEvents() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pendingKeys.size();
+}
+
+void FakeWindowSystem::SetGameCursor(bool hidden, bool clipped) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_cursorDisplay = hidden ? -1 : 0;
+    m_cursorClipped = clipped;
+    m_cursorArrow = false;
+}
+
+LRESULT FakeWindowSystem::Dispatch(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+    WNDPROC proc;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Window* w = Lookup(hwnd);
+        if (!w) return 0;
+        proc = w->proc;
+    }
+    return proc(hwnd, msg, wParam, lParam);
+}
+
+LONG_PTR FakeWindowSystem::Peek(HWND hwnd, int index) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Window* w = Lookup(hwnd);
+    if (!w) return 0;
+    switch (index) {
+        case GWLP_WNDPROC: return (LONG_PTR)w->proc;
+        case GWL_STYLE: return w->style;
+        case GWL_EXSTYLE: return w->exStyle;
+    }
+    return 0;
+}
+
+bool FakeWindowSystem::IsCursorClipped() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_cursorClipped;
+}
+
+CursorState FakeWindowSystem::PeekCursor() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    CursorState state;
+    state.showing = m_cursorDisplay >= 0;
+    state.arrow = m_cursorArrow;
+    state.clipped = m_cursorClipped;
+    return state;
+}
+
+size_t FakeWindowSystem::DeliverPosted() {
+    std::vector<HWND> posted;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        posted.swap(m_posted);
+    }
+    for (HWND hwnd : posted) DeliverWake(hwnd);
+    return posted.size();
+}
+
+void FakeWindowSystem::DeliverWake(HWND hwnd) {
+    WNDPROC proc;
+    DWORD tid;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Window* w = Lookup(hwnd);
+        if (!w) return; // a posted message dies with its window
+        proc = w->proc;
+        tid = w->tid;
+    }
+    DWORD self = t_ownerThread;
+    t_ownerThread = tid;
+    proc(hwnd, kWakeMessage, 0, 0);
+    t_ownerThread = self;
+}
+
+std::vector<InputEvent> FakeWindowSystem::TakeSentInputs() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<InputEvent> out;
+    out.swap(m_sentInputs);
+    return out;
+}
+
+size_t FakeWindowSystem::WindowCount() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_liveCount;
+}
+
+uint64_t FakeWindowSystem::TotalCalls() const {
+    uint64_t total = 0;
+    for (int i = 0; i < ApiCount; ++i) total += Count((Api)i);
+    return total;
+}
+
+void FakeWindowSystem::ResetCounters() {
+    for (auto& c : m_counts) c.store(0, std::memory_order_relaxed);
+    m_crossThreadSends.store(0, std::memory_order_relaxed);
+}
+
+void FakeWindowSystem::SendFrom(const Window& w) {
+    if (w.tid == CurrentThreadId()) return;
+    m_crossThreadSends.fetch_add(1, std::memory_order_relaxed);
+    uint32_t us = m_crossThreadCostUs.load(std::memory_order_relaxed);
+    if (!us) return;
+    auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(us);
+    while (std::chrono::steady_clock::now() < until) {}
+}
+
+// --- IWindowSystem ---
+
+DWORD FakeWindowSystem::CurrentThreadId() {
+    return t_ownerThread ? t_ownerThread : m_threadId;
+}
+
+DWORD FakeWindowSystem::GetWindowThread(HWND hwnd, DWORD* pid) {
+    Bump(ApiGetWindowThread);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Window* w = Lookup(hwnd);
+    if (pid) *pid = w ? w->pid : 0;
+    return w ? w->tid : 0;
+}
+
+void FakeWindowSystem::EnumTopLevel(EnumProc proc, void* ctx) {
+    Bump(ApiEnumTopLevel);
+    std::vector<HWND> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        snapshot.reserve(m_liveCount);
+        for (HWND h = m_zTop; h; h = Lookup(h)->zNext) snapshot.push_back(h);
+    }
+    for (HWND h : snapshot) {
+        if (!proc(h, ctx)) break;
+    }
+}
+
+void FakeWindowSystem::EnumChildren(HWND parent, EnumProc proc, void* ctx) {
+    Bump(ApiEnumChildren);
+    std::vector<HWND> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Window* w = Lookup(parent);
+        if (!w) return;
+        CollectDescendants(*w, snapshot);
+    }
+    for (HWND h : snapshot) {
+        if (!proc(h, ctx)) break;
+    }
+}
+
+void FakeWindowSystem::EnumThreadTopLevel(DWORD tid, EnumProc proc, void* ctx) {
+    Bump(ApiEnumThreadTopLevel);
+    std::vector<HWND> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (HWND h = m_zTop; h; h = Lookup(h)->zNext) {
+            if (Lookup(h)->tid == tid) snapshot.push_back(h);
+        }
+    }
+    for (HWND h : snapshot) {
+        if (!proc(h, ctx)) break;
+    }
+}
+
+HWND FakeWindowSystem::NextWindow(HWND hwnd) {
+    Bump(ApiNextWindow);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Window* w = Lookup(hwnd);
+    if (!w) return nullptr;
+    if (!w->parent) return w->zNext;
+    Window* p = Lookup(w->parent);
+    auto& siblings = p->children;
+    for (size_t i = 0; i + 1 < siblings.size(); ++i) {
+        if (siblings[i] == hwnd) return siblings[i + 1];
+    }
+    return nullptr;
+}
+
+bool FakeWindowSystem::IsAlive(HWND hwnd) {
+    Bump(ApiIsAlive);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return Lookup(hwnd) != nullptr;
+}
+
+bool FakeWindowSystem::IsVisible(HWND hwnd) {
+    Bump(ApiIsVisible);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (Window* w = Lookup(hwnd); w; w = w->parent ? Lookup(w->parent) : nullptr) {
+        if (!(w->style & WS_VISIBLE)) return false;
+        if (!w->parent) return true;
+    }
+    return false;
+}
+
+int FakeWindowSystem::GetClass(HWND hwnd, char* buffer, int size) {
+    Bump(ApiGetClass);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Window* w = Lookup(hwnd);
+    if (!w || size <= 0) {
+        if (size > 0) buffer[0] = '\0';
+        return 0;
+    }
+    int n = (int)w->className.size();
+    if (n > size - 1) n = size - 1;
+    memcpy(buffer, w->className.data(), n);
+    buffer[n] = '\0';
+    return n;
+}
+
+int FakeWindowSystem::GetTitle(HWND hwnd, char* buffer, int size) {
+    Bump(ApiGetTitle);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Window* w = Lookup(hwnd);
+    if (size <= 0) return 0;
+    int n = w ? (int)w->title.size() : 0;
+    if (n > size - 1) n = size - 1;
+    if (n) memcpy(buffer, w->title.data(), n);
+    buffer[n] = '\0';
+    return n;
+}
+
+int FakeWindowSystem::GetProcessName(DWORD pid, char* buffer, int size) {
+    Bump(ApiGetProcessName);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (size <= 0) return 0;
+    std::string name = "process" + std::to_string(pid) + ".exe";
+    for (const auto& p : m_processNames) {
+        if (p.first == pid) name = p.second;
+    }
+    int n = (int)name.size();
+    if (n > size - 1) n = size - 1;
+    memcpy(buffer, name.data(), n);
+    buffer[n] = '\0';
+    return n;
+}
+
+LONG_PTR FakeWindowSystem::GetLong(HWND hwnd, int index) {
+    Bump(ApiGetLong);
+    return Peek(hwnd, index);
+}
+
+LONG_PTR FakeWindowSystem::SetLong(HWND hwnd, int index, LONG_PTR value) {
+    Bump(ApiSetLong);
+    LONG_PTR prev = 0;
+    bool visibilityChanged = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Window* w = Lookup(hwnd);
+        if (!w) return 0;
+        if (index != GWLP_WNDPROC) SendFrom(*w);
+        switch (index) {
+            case GWLP_WNDPROC: prev = (LONG_PTR)w->proc; w->proc = (WNDPROC)value; break;
+            case GWL_STYLE: prev = w->style; w->style = value; break;
+            case GWL_EXSTYLE: prev = w->exStyle; w->exStyle = value; break;
+        }
+        visibilityChanged = index == GWL_STYLE && ((prev ^ value) & WS_VISIBLE);
+    }
+    if (visibilityChanged) Emit(WindowEventVisibility, hwnd);
+    return prev;
+}
+
+bool FakeWindowSystem::SetPos(HWND hwnd, HWND insertAfter, UINT flags) {
+    Bump(ApiSetPos);
+    bool reordered = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Window* w = Lookup(hwnd);
+        if (!w) return false;
+        SendFrom(*w);
+        if (!(flags & SWP_NOZORDER) && !w->parent) {
+            Unlink(hwnd, *w);
+            if (insertAfter == HWND_TOPMOST) {
+                w->exStyle |= WS_EX_TOPMOST;
+                LinkAfter(hwnd, *w, nullptr);
+            } else {
+                LinkAfter(hwnd, *w, insertAfter);
+            }
+            reordered = true;
+        }
+    }
+    if (reordered) Emit(WindowEventZOrder, hwnd);
+    return true;
+}
+
+void FakeWindowSystem::ApplyMutations(const WindowMutation* mutations, size_t count) {
+    Bump(ApiApplyMutations);
+    for (size_t i = 0; i < count; ++i) {
+        const WindowMutation& m = mutations[i];
+        if (m.ops & WindowMutation::SetStyles) {
+            SetLong(m.hwnd, GWL_EXSTYLE, m.exStyle);
+            SetLong(m.hwnd, GWL_STYLE, m.style);
+        }
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const WindowMutation& m = mutations[i];
+        if (m.ops & WindowMutation::Reposition) SetPos(m.hwnd, m.insertAfter, m.swpFlags);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const WindowMutation& m = mutations[i];
+        if (!(m.ops & WindowMutation::Activate)) continue;
+        DWORD foreThread = GetWindowThread(GetForeground(), NULL);
+        DWORD curThread = CurrentThreadId();
+        if (foreThread != curThread) {
+            AttachInput(foreThread, curThread, true);
+            BringToTop(m.hwnd);
+            SetForeground(m.hwnd);
+            AttachInput(foreThread, curThread, false);
+        } else {
+            SetForeground(m.hwnd);
+        }
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const WindowMutation& m = mutations[i];
+        if (m.ops & WindowMutation::SetProc) SetLong(m.hwnd, GWLP_WNDPROC, (LONG_PTR)m.proc);
+    }
+}
+
+bool FakeWindowSystem::WatchEvents(EventProc proc, void* ctx) {
+    Bump(ApiWatchEvents);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_eventProc = proc;
+    m_eventCtx = ctx;
+    return true;
+}
+
+void FakeWindowSystem::UnwatchEvents() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_eventProc = nullptr;
+    m_eventCtx = nullptr;
+}
+
+void FakeWindowSystem::PumpEvents() {
+    // Window events are delivered synchronously as the simulated state
+    // changes; key events queue up like hook messages until now.
+    Bump(ApiPumpEvents);
+    std::vector<KeyRecord> keys;
+    KeyProc proc;
+    void* ctx;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_pendingKeys.empty()) return;
+        keys.swap(m_pendingKeys);
+        proc = m_keyProc;
+        ctx = m_keyCtx;
+    }
+    if (!proc) return;
+    for (const KeyRecord& k : keys) proc(k.vk, k.down, k.injected, ctx);
+}
+
+bool FakeWindowSystem::WatchKeys(KeyProc proc, void* ctx) {
+    Bump(ApiWatchKeys);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_keyProc = proc;
+    m_keyCtx = ctx;
+    m_keysLive = true;
+    m_pendingKeys.clear();
+    return true;
+}
+
+void FakeWindowSystem::UnwatchKeys() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_keyProc = nullptr;
+    m_keyCtx = nullptr;
+    m_keysLive = false;
+    m_pendingKeys.clear();
+}
+
+bool FakeWindowSystem::KeysLive() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_keysLive;
+}
+
+void FakeWindowSystem::WaitEvents(DWORD timeoutMs) {
+    Bump(ApiWaitEvents);
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto ready = [this] { return m_wakePending || !m_pendingKeys.empty(); };
+    if (timeoutMs == kWaitForever) m_wakeCv.wait(lock, ready);
+    else m_wakeCv.wait_for(lock, std::chrono::milliseconds(timeoutMs), ready);
+    m_wakePending = false;
+}
+
+void FakeWindowSystem::Wake() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_wakePending = true;
+    m_wakeCv.notify_all();
+}
+
+bool FakeWindowSystem::PostWake(HWND hwnd) {
+    Bump(ApiPostWake);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!Lookup(hwnd)) return false;
+        if (m_postMode == PostQueued) {
+            m_posted.push_back(hwnd);
+            return true;
+        }
+    }
+    DeliverWake(hwnd);
+    return true;
+}
+
+HWND FakeWindowSystem::GetForeground() {
+    Bump(ApiGetForeground);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_foreground;
+}
+
+bool FakeWindowSystem::SetForeground(HWND hwnd) {
+    Bump(ApiSetForeground);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!Lookup(hwnd)) return false;
+        m_foreground = hwnd;
+    }
+    Emit(WindowEventForeground, hwnd);
+    return true;
+}
+
+bool FakeWindowSystem::BringToTop(HWND hwnd) {
+    Bump(ApiBringToTop);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Window* w = Lookup(hwnd);
+        if (!w) return false;
+        if (w->parent) return true;
+        Unlink(hwnd, *w);
+        LinkAfter(hwnd, *w, nullptr);
+    }
+    Emit(WindowEventZOrder, hwnd);
+    return true;
+}
+
+bool FakeWindowSystem::AttachInput(DWORD, DWORD, bool) {
+    Bump(ApiAttachInput);
+    return true;
+}
+
+LRESULT FakeWindowSystem::CallProc(WNDPROC proc, HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+    Bump(ApiCallProc);
+    return proc ? proc(hwnd, msg, wParam, lParam) : 0;
+}
+
+LRESULT FakeWindowSystem::DefProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+    Bump(ApiDefProc);
+    return DefaultProc(hwnd, msg, wParam, lParam);
+}
+
+bool FakeWindowSystem::IsKeyDown(int vk) {
+    Bump(ApiIsKeyDown);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_keys[vk & 0xFF];
+}
+
+UINT FakeWindowSystem::SendInputs(const InputEvent* events, UINT count) {
+    Bump(ApiSendInputs);
+    HWND activated = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (UINT i = 0; i < count; ++i) {
+            const InputEvent& ev = events[i];
+            if (ev.type == InputEvent::Keyboard) {
+                bool down = !(ev.flags & KEYEVENTF_KEYUP);
+                m_keys[ev.vk & 0xFF] = down;
+                if (m_keyProc && m_keysLive) m_pendingKeys.push_back({ (WORD)(ev.vk & 0xFF), down, true });
+            }
+            if (ev.type == InputEvent::Mouse && (ev.flags & MOUSEEVENTF_LEFTDOWN)) activated = HitTopLevel();
+            m_sentInputs.push_back(ev);
+        }
+        if (m_keyProc && !m_pendingKeys.empty()) m_wakeCv.notify_all();
+        if (activated == m_foreground) activated = nullptr;
+        if (activated) m_foreground = activated;
+    }
+    if (activated) Emit(WindowEventForeground, activated);
+    return count;
+}
+
+HWND FakeWindowSystem::HitTopLevel() {
+    for (HWND h = m_zTop; h; h = Lookup(h)->zNext) {
+        Window* w = Lookup(h);
+        if ((w->style & WS_VISIBLE) && !(w->exStyle & WS_EX_TRANSPARENT)) return h;
+    }
+    return nullptr;
+}
+
+void FakeWindowSystem::SetArrowCursor() {
+    Bump(ApiSetArrowCursor);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_cursorArrow = true;
+}
+
+bool FakeWindowSystem::IsCursorShowing() {
+    Bump(ApiIsCursorShowing);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_cursorDisplay >= 0;
+}
+
+CursorState FakeWindowSystem::QueryCursor() {
+    Bump(ApiQueryCursor);
+    return PeekCursor();
+}
+
+int FakeWindowSystem::ShowCursor(bool show) {
+    Bump(ApiShowCursor);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return show ? ++m_cursorDisplay : --m_cursorDisplay;
+}
+
+void FakeWindowSystem::ReleaseCursorClip() {
+    Bump(ApiReleaseCursorClip);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_cursorClipped = false;
+}
@@ -0,0 +1,209 @@
+#pragma once
+#include "window_system.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Deterministic in-memory window system for benchmarks and offline replay.
+// Simulates HWNDs (with generation bits, so freed slots get new handles),
+// parent/child trees, top-level z-order, owning process/thread, styles,
+// window procedures, key state, the cursor and the foreground window.
+// Every IWindowSystem call is counted so callers can report "syscalls".
+// A synthetic left click activates the topmost visible top-level window that
+// is not WS_EX_TRANSPARENT; the cursor position is not modelled.
+class FakeWindowSystem : public IWindowSystem {
+public:
+    enum Api {
+        ApiGetWindowThread, ApiEnumTopLevel, ApiEnumChildren, ApiEnumThreadTopLevel, ApiNextWindow,
+        ApiIsAlive, ApiIsVisible, ApiGetClass, ApiGetTitle, ApiGetProcessName,
+        ApiGetLong, ApiSetLong, ApiSetPos, ApiApplyMutations,
+        ApiWatchEvents, ApiPumpEvents, ApiWatchKeys, ApiWaitEvents, ApiPostWake,
+        ApiGetForeground, ApiSetForeground, ApiBringToTop, ApiAttachInput,
+        ApiCallProc, ApiDefProc, ApiIsKeyDown, ApiSendInputs,
+        ApiSetArrowCursor, ApiIsCursorShowing, ApiQueryCursor, ApiShowCursor, ApiReleaseCursorClip,
+        ApiCount
+    };
+    static const char* ApiName(Api api);
+
+    struct WindowDesc {
+        DWORD pid = 0;
+        DWORD tid = 0;
+        HWND parent = nullptr;
+        LONG_PTR style = WS_VISIBLE;
+        LONG_PTR exStyle = 0;
+        const char* className = "FakeWindow";
+        const char* title = "";
+        WNDPROC proc = nullptr; // nullptr = DefaultProc
+    };
+
+    explicit FakeWindowSystem(DWORD processId = 1000, DWORD threadId = 1);
+
+    // --- Simulation control (not counted) ---
+    // Top-level windows are inserted at the top of the z-order.
+    HWND AddWindow(const WindowDesc& desc);
+    // Destroys the window and its descendants, delivering WM_NCDESTROY to each.
+    void RemoveWindow(HWND hwnd);
+    void PlaceAfter(HWND hwnd, HWND after);
+    void Focus(HWND hwnd);
+    // Renames a window (emits WindowEventNameChange).
+    void SetTitle(HWND hwnd, const char* title);
+    void SetProcessName(DWORD pid, const char* name);
+    // Physical key change; queued for the key watcher until PumpEvents.
+    void SetKey(int vk, bool down);
+    // Synthetic key from another program (SendInput with `extraInfo`).
+    void InjectKey(int vk, bool down, uintptr_t extraInfo);
+    // The key watch stops reporting, as a removed hook would, until the
+    // next WatchKeys. Wakes the watcher.
+    void LoseKeyWatch();
+    size_t PendingKeyEvents();
+    // The game takes the cursor: its own shape, optionally hidden and clipped.
+    void SetGameCursor(bool hidden, bool clipped);
+    LRESULT Dispatch(HWND hwnd, UINT msg, WPARAM wParam = 0, LPARAM lParam = 0);
+    LONG_PTR Peek(HWND hwnd, int index);
+    bool IsCursorClipped();
+    CursorState PeekCursor();
+    std::vector<InputEvent> TakeSentInputs();
+    // Posted wake messages are dispatched inside PostWake by default, as if
+    // the owner thread were idle; with PostQueued they wait for
+    // DeliverPosted(). Either way they run with CurrentThreadId() reporting
+    // the window's thread.
+    enum PostMode { PostImmediate, PostQueued };
+    void SetPostMode(PostMode mode) { m_postMode = mode; }
+    size_t DeliverPosted();
+    // Style and position changes made on a window owned by another thread;
+    // on Win32 each one waits for that thread to handle a sent message.
+    uint64_t CrossThreadSends() const { return m_crossThreadSends.load(std::memory_order_relaxed); }
+    // Makes each cross-thread send take `us` microseconds, the time a
+    // responsive owner thread needs to answer it.
+    void SetCrossThreadCost(uint32_t us) { m_crossThreadCostUs = us; }
+    size_t WindowCount();
+
+    uint64_t Count(Api api) const { return m_counts[api].load(std::memory_order_relaxed); }
+    uint64_t TotalCalls() const;
+    void ResetCounters();
+
+    static LRESULT CALLBACK DefaultProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
+
+    // --- IWindowSystem ---
+    DWORD CurrentProcessId() override { return m_processId; }
+    DWORD CurrentThreadId() override;
+    DWORD GetWindowThread(HWND hwnd, DWORD* pid) override;
+
+    void EnumTopLevel(EnumProc proc, void* ctx) override;
+    void EnumChildren(HWND parent, EnumProc proc, void* ctx) override;
+    void EnumThreadTopLevel(DWORD tid, EnumProc proc, void* ctx) override;
+    HWND NextWindow(HWND hwnd) override;
+    bool IsAlive(HWND hwnd) override;
+    bool IsVisible(HWND hwnd) override;
+    int GetClass(HWND hwnd, char* buffer, int size) override;
+    int GetTitle(HWND hwnd, char* buffer, int size) override;
+    int GetProcessName(DWORD pid, char* buffer, int size) override;
+
+    LONG_PTR GetLong(HWND hwnd, int index) override;
+    LONG_PTR SetLong(HWND hwnd, int index, LONG_PTR value) override;
+    bool SetPos(HWND hwnd, HWND insertAfter, UINT flags) override;
+    void ApplyMutations(const WindowMutation* mutations, size_t count) override;
+
+    bool WatchEvents(EventProc proc, void* ctx) override;
+    void UnwatchEvents() override;
+    void PumpEvents() override;
+    bool WatchKeys(KeyProc proc, void* ctx) override;
+    void UnwatchKeys() override;
+    bool KeysLive() override;
+    void WaitEvents(DWORD timeoutMs) override;
+    void Wake() override;
+    bool PostWake(HWND hwnd) override;
+    UINT WakeMessage() override { return kWakeMessage; }
+
+    HWND GetForeground() override;
+    bool SetForeground(HWND hwnd) override;
+    bool BringToTop(HWND hwnd) override;
+    bool AttachInput(DWORD from, DWORD to, bool attach) override;
+
+    LRESULT CallProc(WNDPROC proc, HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) override;
+    LRESULT DefProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) override;
+
+    bool IsKeyDown(int vk) override;
+    UINT SendInputs(const InputEvent* events, UINT count) override;
+
+    void SetArrowCursor() override;
+    bool IsCursorShowing() override;
+    CursorState QueryCursor() override;
+    int ShowCursor(bool show) override;
+    void ReleaseCursorClip() override;
+
+private:
+    static const UINT kWakeMessage = 0xC0DE; // in the RegisterWindowMessage range
+
+    struct KeyRecord {
+        WORD vk;
+        bool down;
+        bool injected;
+    };
+
+    struct Window {
+        bool alive = false;
+        uint16_t generation = 0;
+        DWORD pid = 0;
+        DWORD tid = 0;
+        HWND parent = nullptr;
+        HWND zPrev = nullptr; // top-level z-order links
+        HWND zNext = nullptr;
+        LONG_PTR style = 0;
+        LONG_PTR exStyle = 0;
+        WNDPROC proc = nullptr;
+        std::string className;
+        std::string title;
+        std::vector<HWND> children;
+    };
+
+    Window* Lookup(HWND hwnd);
+    void Bump(Api api) { m_counts[api].fetch_add(1, std::memory_order_relaxed); }
+    void Unlink(HWND hwnd, Window& w);
+    void LinkAfter(HWND hwnd, Window& w, HWND after);
+    void CollectDescendants(const Window& w, std::vector<HWND>& out);
+    HWND AddWindowLocked(const WindowDesc& desc);
+    // Topmost window a click would land on; call with m_mutex held.
+    HWND HitTopLevel();
+    // Runs the wake message on `hwnd` as its owner thread.
+    void DeliverWake(HWND hwnd);
+    // Counts (and charges for) a style or position change on window `w`;
+    // call with m_mutex held.
+    void SendFrom(const Window& w);
+    // Delivers synchronously to the watcher; call without m_mutex held.
+    void Emit(WindowEvent event, HWND hwnd);
+
+    DWORD m_processId;
+    DWORD m_threadId;
+
+    std::mutex m_mutex;
+    std::vector<Window> m_windows;
+    std::vector<uint32_t> m_freeSlots;
+    size_t m_liveCount = 0;
+    std::vector<std::pair<DWORD, std::string>> m_processNames;
+    HWND m_zTop = nullptr;
+    HWND m_foreground = nullptr;
+    bool m_keys[256] = {};
+    int m_cursorDisplay = 0;
+    bool m_cursorClipped = false;
+    bool m_cursorArrow = true;
+    std::vector<InputEvent> m_sentInputs;
+    PostMode m_postMode = PostImmediate;
+    std::vector<HWND> m_posted;
+    std::atomic<uint64_t> m_crossThreadSends{ 0 };
+    std::atomic<uint32_t> m_crossThreadCostUs{ 0 };
+    EventProc m_eventProc = nullptr;
+    void* m_eventCtx = nullptr;
+    KeyProc m_keyProc = nullptr;
+    void* m_keyCtx = nullptr;
+    std::vector<KeyRecord> m_pendingKeys;
+    bool m_keysLive = false;
+    bool m_wakePending = false;
+    std::condition_variable m_wakeCv;
+
+    std::atomic<uint64_t> m_counts[ApiCount] = {};
+};
@@ -0,0 +1,144 @@
+#include "focus_resolver.hpp"
+#include "window_rules.hpp"
+#include "trace_recorder.hpp"
+#include <algorithm>
+
+FocusResolver g_FocusResolver;
+
+void GetLSWindows(std::vector<HWND>& out) {
+    out.clear();
+    struct Ctx { IWindowSystem* sys; std::vector<HWND>* out; } ctx = { g_WindowSystem, &out };
+    g_WindowSystem->EnumTopLevel([](HWND hwnd, void* p) -> bool {
+        Ctx* ctx = (Ctx*)p;
+        DWORD pid;
+        ctx->sys->GetWindowThread(hwnd, &pid);
+        if (pid == ctx->sys->CurrentProcessId() && ctx->sys->IsVisible(hwnd)) ctx->out->push_back(hwnd);
+        return true;
+    }, &ctx);
+}
+
+HWND GetTargetWindow(HWND hLS) {
+    if (!hLS) return nullptr;
+    IWindowSystem* sys = g_WindowSystem;
+    HWND hCurr = sys->NextWindow(hLS);
+    while (hCurr) {
+        if (sys->IsVisible(hCurr)) {
+            DWORD pid;
+            sys->GetWindowThread(hCurr, &pid);
+            // Shell windows and whatever the rules exclude are skipped;
+            // the verdict is cached per window.
+            if (pid != sys->CurrentProcessId() && g_WindowRules.Classify(hCurr) != WindowRules::Ignore) {
+                return hCurr;
+            }
+        }
+        hCurr = sys->NextWindow(hCurr);
+    }
+    return nullptr;
+}
+
+void FocusResolver::Start() {
+    m_watching = g_WindowSystem->WatchEvents(OnEvent, this);
+    Invalidate();
+}
+
+void FocusResolver::Stop() {
+    if (m_watching) g_WindowSystem->UnwatchEvents();
+    m_watching = false;
+    Invalidate();
+}
+
+void FocusResolver::OnEvent(WindowEvent event, HWND hwnd, void* ctx) {
+    FocusResolver* self = (FocusResolver*)ctx;
+    g_Trace.Record(TraceWindowEvent, 0, 0, (uint16_t)event, 0, hwnd);
+    // Renames matter only when a title rule may now classify differently.
+    bool reclassified = g_WindowRules.OnWindowEvent(event, hwnd);
+    if (event == WindowEventNameChange && !reclassified) return;
+    self->m_invalidations.fetch_add(1, std::memory_order_relaxed);
+    self->Invalidate();
+}
+
+void FocusResolver::Validate() {
+    uint32_t epoch = m_epoch.load(std::memory_order_acquire);
+    if (m_watching && epoch == m_cachedEpoch) {
+        m_hits.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    m_resolves.fetch_add(1, std::memory_order_relaxed);
+    // No destroy events: a handle reused since the last pass would keep
+    // its old verdict.
+    if (!m_watching) g_WindowRules.ForgetWindows();
+    IWindowSystem* sys = g_WindowSystem;
+    m_foreground = sys->GetForeground();
+    DWORD forePid = 0;
+    sys->GetWindowThread(m_foreground, &forePid);
+    m_foregroundIsOurs = forePid == sys->CurrentProcessId();
+    // LS/target pairs are resolved lazily: the common case (LS focused)
+    // never walks.
+    m_pairsResolved = false;
+    m_cachedEpoch = epoch;
+}
+
+bool FocusResolver::HasValidFocus() {
+    Validate();
+    return m_foregroundIsOurs || FocusedPair() != nullptr;
+}
+
+const std::vector<FocusResolver::Pair>& FocusResolver::Pairs() {
+    Validate();
+    if (!m_pairsResolved) {
+        IWindowSystem* sys = g_WindowSystem;
+        GetLSWindows(m_lsWindows);
+        // Pins of LS windows that are gone or hidden go with them.
+        m_pins.erase(std::remove_if(m_pins.begin(), m_pins.end(), [&](const Pair& pin) {
+            return std::find(m_lsWindows.begin(), m_lsWindows.end(), pin.lsWindow) == m_lsWindows.end();
+        }), m_pins.end());
+        m_pairs.clear();
+        for (HWND hLS : m_lsWindows) {
+            HWND target = nullptr;
+            for (const Pair& pin : m_pins) {
+                if (pin.lsWindow == hLS && sys->IsVisible(pin.target)) target = pin.target;
+            }
+            m_pairs.push_back({ hLS, target ? target : GetTargetWindow(hLS) });
+        }
+        m_pairsResolved = true;
+    }
+    return m_pairs;
+}
+
+void FocusResolver::Pin(HWND lsWindow, HWND target) {
+    Unpin(lsWindow);
+    if (lsWindow && target) m_pins.push_back({ lsWindow, target });
+}
+
+void FocusResolver::Unpin(HWND lsWindow) {
+    m_pins.erase(std::remove_if(m_pins.begin(), m_pins.end(), [&](const Pair& pin) {
+        return !lsWindow || pin.lsWindow == lsWindow;
+    }), m_pins.end());
+    m_pairsResolved = false;
+}
+
+const FocusResolver::Pair* FocusResolver::FocusedPair() {
+    const std::vector<Pair>& pairs = Pairs();
+    if (!m_foreground) return nullptr;
+    for (const Pair& pair : pairs) {
+        if (pair.lsWindow == m_foreground || pair.target == m_foreground) return &pair;
+    }
+    return m_foregroundIsOurs && !pairs.empty() ? &pairs.front() : nullptr;
+}
+
+HWND FocusResolver::LSWindow() {
+    const Pair* pair = FocusedPair();
+    if (!pair && !m_pairs.empty()) pair = &m_pairs.front();
+    return pair ? pair->lsWindow : nullptr;
+}
+
+HWND FocusResolver::TargetWindow() {
+    const Pair* pair = FocusedPair();
+    if (!pair && !m_pairs.empty()) pair = &m_pairs.front();
+    return pair ? pair->target : nullptr;
+}
+
+FocusResolver::Stats FocusResolver::GetStats() const {
+    return { m_hits.load(std::memory_order_relaxed), m_resolves.load(std::memory_order_relaxed),
+             m_invalidations.load(std::memory_order_relaxed) };
+}
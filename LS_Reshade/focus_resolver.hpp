@@ -0,0 +1,80 @@
+#pragma once
+#include "platform.hpp"
+#include "window_system.hpp"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// --- Helper Functions for Window Detection ---
+// Uncached: a full EnumWindows / z-order walk per call.
+// Every LS window: the visible top-level windows of this process, topmost
+// first. LS opens one per scaled game (one per monitor).
+void GetLSWindows(std::vector<HWND>& out);
+HWND GetTargetWindow(HWND hLS);
+
+// Caches the LS windows, their targets and the foreground window. The cache is
+// dropped only by foreground, z-order, visibility and destroy events from the
+// window system, so while nothing moves the focus check is a single compare.
+// If the backend cannot deliver events every query re-resolves, with the
+// window rules' per-window cache dropped.
+class FocusResolver {
+public:
+    // An LS window and the window it scales (nullptr if none is found).
+    struct Pair {
+        HWND lsWindow;
+        HWND target;
+    };
+
+    struct Stats {
+        uint64_t hits;
+        uint64_t resolves;
+        uint64_t invalidations;
+    };
+
+    // Installs the event watch on the calling thread (the worker).
+    void Start();
+    void Stop();
+
+    // True when the foreground window belongs to this process or is a
+    // window LS is scaling (the condition for enabling/keeping passthrough).
+    bool HasValidFocus();
+    const std::vector<Pair>& Pairs();
+    // The pair whose LS window or target is the foreground window; the
+    // topmost pair when another window of ours is. nullptr if none.
+    const Pair* FocusedPair();
+    // Of the focused pair, else of the topmost one.
+    HWND LSWindow();
+    HWND TargetWindow();
+
+    // Keeps `lsWindow` paired with `target` while it stays visible, instead
+    // of walking the z-order below it: once its overlay is raised, other LS
+    // windows and their games may sit right below it. For the sessions that
+    // are on. Unpin(nullptr) drops every pin.
+    void Pin(HWND lsWindow, HWND target);
+    void Unpin(HWND lsWindow);
+
+    void Invalidate() { m_epoch.fetch_add(1, std::memory_order_release); }
+    Stats GetStats() const;
+
+private:
+    static void OnEvent(WindowEvent event, HWND hwnd, void* ctx);
+    // Refreshes the cache if any event arrived since it was filled.
+    void Validate();
+
+    std::atomic<uint32_t> m_epoch{ 1 };
+    std::atomic<uint64_t> m_invalidations{ 0 };
+    uint32_t m_cachedEpoch = 0;
+    bool m_watching = false;
+
+    HWND m_foreground = nullptr;
+    bool m_foregroundIsOurs = false;
+    bool m_pairsResolved = false;
+    std::vector<HWND> m_lsWindows;
+    std::vector<Pair> m_pairs;
+    std::vector<Pair> m_pins;
+
+    std::atomic<uint64_t> m_hits{ 0 };
+    std::atomic<uint64_t> m_resolves{ 0 };
+};
+
+extern FocusResolver g_FocusResolver;
@@ -0,0 +1,177 @@
+#include "hotkey_engine.hpp"
+#include "key_catalog.hpp"
+#include "logger.hpp"
+#include "trace_recorder.hpp"
+
+HotkeyEngine g_Hotkeys;
+
+namespace {
+    // The hook reports left/right modifiers; bindings use the generic ones.
+    WORD Normalize(WORD vk) {
+        switch (vk) {
+            case VK_LSHIFT: case VK_RSHIFT: return VK_SHIFT;
+            case VK_LCONTROL: case VK_RCONTROL: return VK_CONTROL;
+            case VK_LMENU: case VK_RMENU: return VK_MENU;
+            default: return vk;
+        }
+    }
+
+    bool IsModifier(WORD vk) {
+        return vk == VK_SHIFT || vk == VK_CONTROL || vk == VK_MENU;
+    }
+}
+
+void HotkeyEngine::Start(bool allowEvents) {
+    m_eventDriven = allowEvents && g_WindowSystem->WatchKeys(KeyThunk, this);
+    m_keysLost = false;
+    LOG_INFO("Hotkeys: %s", m_eventDriven ? "keyboard hook" : "polling");
+}
+
+void HotkeyEngine::Stop() {
+    if (m_eventDriven) g_WindowSystem->UnwatchKeys();
+    m_eventDriven = false;
+}
+
+void HotkeyEngine::KeyThunk(WORD vk, bool down, bool injected, void* ctx) {
+    ((HotkeyEngine*)ctx)->OnKey(vk, down, injected);
+}
+
+void HotkeyEngine::SetBindings(const HotkeyBinding* bindings, size_t count) {
+    m_bindingCount = count < kMaxBindings ? count : kMaxBindings;
+    // Modifiers first, so a chord pressed between two polls sees them.
+    m_pollCount = 0;
+    m_pollKeys[m_pollCount++] = VK_CONTROL;
+    m_pollKeys[m_pollCount++] = VK_MENU;
+    m_pollKeys[m_pollCount++] = VK_SHIFT;
+    for (size_t i = 0; i < m_bindingCount; ++i) {
+        m_bindings[i] = bindings[i];
+        m_progress[i] = 0;
+        for (uint8_t c = 0; c < m_bindings[i].length; ++c) {
+            WORD vk = m_bindings[i].chords[c].vk;
+            bool seen = false;
+            for (size_t k = 0; k < m_pollCount; ++k) seen |= m_pollKeys[k] == vk;
+            if (!seen) m_pollKeys[m_pollCount++] = vk;
+        }
+    }
+    if (m_bindingCount == 0) m_pollCount = 0;
+}
+
+void HotkeyEngine::Update(uint64_t nowMs) {
+    m_now = nowMs;
+    if (m_eventDriven && m_keysLost == g_WindowSystem->KeysLive()) {
+        m_keysLost = !m_keysLost;
+        if (m_keysLost) LOG_WARN("Hotkeys: keyboard hook stopped reporting, polling until it does again");
+        else LOG_INFO("Hotkeys: keyboard hook reporting again");
+    }
+    if (!EventDriven()) Poll();
+}
+
+void HotkeyEngine::Poll() {
+    for (size_t i = 0; i < m_pollCount; ++i) PollKey(m_pollKeys[i]);
+    m_polls.fetch_add(m_pollCount, std::memory_order_relaxed);
+    // A capture can take any key, so sample them all while one waits.
+    if ((m_capture.load(std::memory_order_acquire) >> 16) == CaptureWaiting) {
+        PollKey(VK_CONTROL);
+        PollKey(VK_MENU);
+        PollKey(VK_SHIFT);
+        for (uint8_t vk : KeyCatalog::kBindable) PollKey(vk);
+        m_polls.fetch_add(3 + KeyCatalog::kBindable.size(), std::memory_order_relaxed);
+    }
+}
+
+void HotkeyEngine::PollKey(WORD vk) {
+    bool down = g_WindowSystem->IsKeyDown(vk);
+    if (down != m_down[vk]) OnKey(vk, down, false);
+}
+
+uint8_t HotkeyEngine::CurrentMods() const {
+    return (m_down[VK_CONTROL] ? HotkeyChord::ModCtrl : 0) |
+           (m_down[VK_MENU] ? HotkeyChord::ModAlt : 0) |
+           (m_down[VK_SHIFT] ? HotkeyChord::ModShift : 0);
+}
+
+void HotkeyEngine::OnKey(WORD vk, bool down, bool injected) {
+    m_events.fetch_add(1, std::memory_order_relaxed);
+    g_Trace.Record(TraceKey, 0, 0, vk, (down ? 1 : 0) | (injected ? 2 : 0));
+    if (injected) {
+        m_injected.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    vk = Normalize(vk) & 0xFF;
+    bool wasDown = m_down[vk];
+    m_down[vk] = down;
+    // Only fresh presses of non-modifier keys advance bindings; releases and
+    // auto-repeat do not.
+    if (!down || wasDown || IsModifier(vk)) return;
+
+    const uint8_t mods = CurrentMods();
+    if (Capture(vk, mods)) return;
+    for (size_t i = 0; i < m_bindingCount; ++i) {
+        const HotkeyBinding& b = m_bindings[i];
+        if (b.length == 0) continue;
+        uint8_t& progress = m_progress[i];
+        if (progress > 0) {
+            const HotkeyChord& expected = b.chords[progress];
+            if (m_now - m_lastChord[i] > kChordTimeoutMs || expected.vk != vk || expected.mods != mods) progress = 0;
+        }
+        const HotkeyChord& chord = b.chords[progress];
+        if (chord.vk != vk || chord.mods != mods) continue;
+        m_lastChord[i] = m_now;
+        if (++progress == b.length) {
+            progress = 0;
+            Push(b.action);
+        }
+    }
+}
+
+void HotkeyEngine::Push(HotkeyAction action) {
+    m_fired.fetch_add(1, std::memory_order_relaxed);
+    if (m_queueTail - m_queueHead == kQueueSize) return; // worker is not draining
+    m_queue[m_queueTail++ % kQueueSize] = action;
+}
+
+bool HotkeyEngine::Capture(WORD vk, uint8_t mods) {
+    uint32_t waiting = (uint32_t)CaptureWaiting << 16;
+    if (m_capture.load(std::memory_order_relaxed) != waiting) return false;
+    uint32_t result;
+    if (vk == VK_ESCAPE && mods == 0) result = (uint32_t)CaptureCancelled << 16;
+    else if (KeyCatalog::Bindable(vk)) result = (uint32_t)CaptureDone << 16 | (uint32_t)mods << 8 | vk;
+    else return true; // swallowed, still waiting
+    // The UI may have cancelled in the meantime.
+    m_capture.compare_exchange_strong(waiting, result, std::memory_order_release, std::memory_order_relaxed);
+    return true;
+}
+
+void HotkeyEngine::BeginCapture() {
+    m_capture.store((uint32_t)CaptureWaiting << 16, std::memory_order_release);
+}
+
+void HotkeyEngine::CancelCapture() {
+    m_capture.store(0, std::memory_order_release);
+}
+
+HotkeyEngine::CaptureState HotkeyEngine::PollCapture(HotkeyChord& chord) {
+    uint32_t c = m_capture.load(std::memory_order_acquire);
+    CaptureState state = (CaptureState)(c >> 16);
+    if (state != CaptureDone && state != CaptureCancelled) return state;
+    // Reported once; a new capture begun meanwhile is left alone.
+    if (!m_capture.compare_exchange_strong(c, 0, std::memory_order_acq_rel)) return CaptureWaiting;
+    chord.vk = (WORD)(c & 0xFF);
+    chord.mods = (uint8_t)(c >> 8);
+    return state;
+}
+
+bool HotkeyEngine::PopAction(HotkeyAction& action) {
+    if (m_queueHead == m_queueTail) return false;
+    action = m_queue[m_queueHead++ % kQueueSize];
+    return true;
+}
+
+HotkeyEngine::Stats HotkeyEngine::GetStats() const {
+    Stats s;
+    s.events = m_events.load(std::memory_order_relaxed);
+    s.injected = m_injected.load(std::memory_order_relaxed);
+    s.fired = m_fired.load(std::memory_order_relaxed);
+    s.polls = m_polls.load(std::memory_order_relaxed);
+    return s;
+}
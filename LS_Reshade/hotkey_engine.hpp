@@ -0,0 +1,115 @@
+#pragma once
+#include "platform.hpp"
+#include "window_system.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+enum HotkeyAction : uint8_t {
+    HotkeyTogglePassthrough,
+};
+
+// One key press with an exact modifier set.
+struct HotkeyChord {
+    enum Mods : uint8_t { ModCtrl = 1 << 0, ModAlt = 1 << 1, ModShift = 1 << 2 };
+    WORD vk;
+    uint8_t mods;
+};
+
+// Fires `action` when its chords are pressed in order, each within
+// kChordTimeoutMs of the previous one. Most bindings are a single chord.
+struct HotkeyBinding {
+    static const size_t kMaxChords = 4;
+    HotkeyChord chords[kMaxChords];
+    uint8_t length;
+    HotkeyAction action;
+};
+
+// Turns key transitions into hotkey actions. Transitions come from the
+// window system's keyboard hook (delivered by PumpEvents), or, where no hook
+// is available or it stopped reporting (KeysLive), from sampling IsKeyDown
+// once per Update. Both may see the same transition; it counts once. Edges are taken
+// from the transitions themselves, so a press released between two worker
+// ticks still fires. Our own SendInputs input is ignored when the source can
+// tell; keys other programs inject count as typed, as they do when polling.
+// Single-threaded: everything runs on the worker thread, except the capture
+// calls, which the settings UI makes.
+class HotkeyEngine {
+public:
+    static const uint32_t kChordTimeoutMs = 1000;
+    static const size_t kMaxBindings = 8;
+
+    enum CaptureState : uint8_t { CaptureIdle, CaptureWaiting, CaptureDone, CaptureCancelled };
+
+    struct Stats {
+        uint64_t events;   // transitions fed in
+        uint64_t injected; // ignored synthetic transitions
+        uint64_t fired;
+        uint64_t polls;    // IsKeyDown calls made by the fallback
+    };
+
+    // Installs the key watch on the calling thread; falls back to polling
+    // if it fails or `allowEvents` is false.
+    void Start(bool allowEvents = true);
+    void Stop();
+    // False while polling, including while the key watch is not live.
+    bool EventDriven() const { return m_eventDriven && !m_keysLost; }
+
+    void SetBindings(const HotkeyBinding* bindings, size_t count);
+
+    // Sets the time used for chord timeouts; checks the key watch is live
+    // and polls when not event driven. Call before PumpEvents each tick.
+    void Update(uint64_t nowMs);
+    // Feeds one key transition (from the hook, the poller, or a test).
+    void OnKey(WORD vk, bool down, bool injected);
+    bool PopAction(HotkeyAction& action);
+
+    // Press-to-bind: the next fresh press of a bindable key, with the
+    // modifiers held at the time, is captured instead of matched against
+    // the bindings. Escape without modifiers cancels. Any thread.
+    void BeginCapture();
+    void CancelCapture();
+    // CaptureDone fills `chord`; Done and Cancelled are reported once, then
+    // the state is back to Idle.
+    CaptureState PollCapture(HotkeyChord& chord);
+
+    Stats GetStats() const;
+
+private:
+    static void KeyThunk(WORD vk, bool down, bool injected, void* ctx);
+    void Poll();
+    void PollKey(WORD vk);
+    // True if the press was taken by a capture in progress.
+    bool Capture(WORD vk, uint8_t mods);
+    uint8_t CurrentMods() const;
+    void Push(HotkeyAction action);
+
+    bool m_eventDriven = false;
+    bool m_keysLost = false;
+    uint64_t m_now = 0;
+    bool m_down[256] = {};
+
+    HotkeyBinding m_bindings[kMaxBindings];
+    uint8_t m_progress[kMaxBindings] = {};
+    uint64_t m_lastChord[kMaxBindings] = {};
+    size_t m_bindingCount = 0;
+
+    // Keys the poller samples: bound keys plus the three modifiers.
+    WORD m_pollKeys[kMaxBindings * HotkeyBinding::kMaxChords + 3];
+    size_t m_pollCount = 0;
+
+    static const size_t kQueueSize = 16;
+    HotkeyAction m_queue[kQueueSize];
+    size_t m_queueHead = 0;
+    size_t m_queueTail = 0;
+
+    // CaptureState << 16 | mods << 8 | vk
+    std::atomic<uint32_t> m_capture{ 0 };
+
+    std::atomic<uint64_t> m_events{ 0 };
+    std::atomic<uint64_t> m_injected{ 0 };
+    std::atomic<uint64_t> m_fired{ 0 };
+    std::atomic<uint64_t> m_polls{ 0 };
+};
+
+extern HotkeyEngine g_Hotkeys;
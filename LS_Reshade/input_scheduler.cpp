@@ -0,0 +1,259 @@
+#include "input_scheduler.hpp"
+#include "logger.hpp"
+#include "trace_recorder.hpp"
+#include <cstring>
+
+InputScheduler g_InputScheduler;
+
+// --- InputSequence ---
+
+InputSequence& InputSequence::Wait(uint32_t ms, bool guarded) {
+    return WaitUntil(0, ms, ms, guarded);
+}
+
+InputSequence& InputSequence::WaitUntil(uint8_t until, uint32_t minMs, uint32_t timeoutMs, bool guarded) {
+    if (stepCount == kMaxSteps) return *this;
+    Step& step = steps[stepCount++];
+    step.minMs = minMs;
+    step.timeoutMs = timeoutMs < minMs ? minMs : timeoutMs;
+    step.until = until;
+    step.first = eventCount;
+    step.count = 0;
+    step.guarded = guarded;
+    return *this;
+}
+
+InputSequence& InputSequence::Key(WORD vk, bool down) {
+    if (stepCount == 0) Wait(0);
+    if (eventCount == kMaxEvents) return *this;
+    InputEvent& ev = events[eventCount++];
+    ev.type = InputEvent::Keyboard;
+    ev.vk = vk;
+    ev.flags = down ? 0 : KEYEVENTF_KEYUP;
+    steps[stepCount - 1].count++;
+    return *this;
+}
+
+InputSequence& InputSequence::Mouse(DWORD flags) {
+    if (stepCount == 0) Wait(0);
+    if (eventCount == kMaxEvents) return *this;
+    InputEvent& ev = events[eventCount++];
+    ev.type = InputEvent::Mouse;
+    ev.vk = 0;
+    ev.flags = flags;
+    steps[stepCount - 1].count++;
+    return *this;
+}
+
+// --- TimerWheel ---
+
+void TimerWheel::Schedule(uint64_t due, uint32_t id) {
+    m_slots[due & (kSlots - 1)].push_back({ due, id });
+}
+
+void TimerWheel::Advance(uint64_t now, std::vector<uint32_t>& expired) {
+    if (now <= m_now) return;
+    // One revolution visits every slot, so larger jumps need no more work.
+    uint64_t last = now - m_now > kSlots ? m_now + kSlots : now;
+    for (uint64_t t = m_now + 1; t <= last; ++t) {
+        std::vector<Entry>& slot = m_slots[t & (kSlots - 1)];
+        for (size_t i = 0; i < slot.size();) {
+            if (slot[i].due <= now) {
+                expired.push_back(slot[i].id);
+                slot[i] = slot.back();
+                slot.pop_back();
+            } else {
+                ++i;
+            }
+        }
+    }
+    m_now = now;
+}
+
+// --- InputScheduler ---
+
+InputScheduler::Active* InputScheduler::Lookup(Handle handle) {
+    size_t slot = (size_t)(handle & 0xFF) - 1;
+    if (handle == 0 || slot >= kMaxActive) return nullptr;
+    Active& a = m_active[slot];
+    if (!a.live || a.generation != (uint16_t)(handle >> 8)) return nullptr;
+    return &a;
+}
+
+InputScheduler::Handle InputScheduler::Start(const InputSequence& seq) {
+    if (seq.stepCount == 0) return 0;
+    for (size_t slot = 0; slot < kMaxActive; ++slot) {
+        Active& a = m_active[slot];
+        if (a.live) continue;
+        a.seq = seq;
+        a.next = 0;
+        a.live = true;
+        a.generation++;
+        memset(a.keys, 0, sizeof(a.keys));
+        a.mouseLeft = false;
+        m_sequences.fetch_add(1, std::memory_order_relaxed);
+
+        a.started = m_wheel.Now();
+        a.stepStart = a.started;
+        Run(slot);
+        return MakeHandle(slot, a.generation);
+    }
+    LOG_WARN("Input scheduler full, sequence dropped");
+    return 0;
+}
+
+bool InputScheduler::Satisfied(const InputSequence& seq, uint8_t until) {
+    IWindowSystem* sys = g_WindowSystem;
+    if (until & InputSequence::UntilKeyDown) {
+        if (!sys->IsKeyDown(seq.watchVk)) return false;
+    }
+    if (until & InputSequence::UntilKeysUp) {
+        if (sys->IsKeyDown(seq.watchVk)) return false;
+        if ((seq.watchMods & InputSequence::ModCtrl) && sys->IsKeyDown(VK_CONTROL)) return false;
+        if ((seq.watchMods & InputSequence::ModAlt) && sys->IsKeyDown(VK_MENU)) return false;
+        if ((seq.watchMods & InputSequence::ModShift) && sys->IsKeyDown(VK_SHIFT)) return false;
+    }
+    if (until & InputSequence::UntilForeground) {
+        DWORD pid = 0;
+        HWND fg = sys->GetForeground();
+        if (!fg) return false;
+        sys->GetWindowThread(fg, &pid);
+        if (pid != sys->CurrentProcessId()) return false;
+    }
+    return true;
+}
+
+void InputScheduler::Run(size_t slot) {
+    Active& a = m_active[slot];
+    const uint64_t now = m_wheel.Now();
+    for (;;) {
+        const InputSequence::Step& step = a.seq.steps[a.next];
+        uint64_t elapsed = now - a.stepStart;
+        if (elapsed < step.minMs) {
+            a.due = a.stepStart + step.minMs;
+            m_wheel.Schedule(a.due, MakeHandle(slot, a.generation));
+            return;
+        }
+        bool met = step.until == 0 || Satisfied(a.seq, step.until);
+        if (!met && elapsed < step.timeoutMs) {
+            uint64_t deadline = a.stepStart + step.timeoutMs;
+            a.due = now + kPollMs < deadline ? now + kPollMs : deadline;
+            m_wheel.Schedule(a.due, MakeHandle(slot, a.generation));
+            return;
+        }
+        if (!met) m_timeouts.fetch_add(1, std::memory_order_relaxed);
+
+        const InputEvent* events = a.seq.events + step.first;
+        for (uint8_t i = 0; i < step.count; ++i) {
+            if (events[i].type == InputEvent::Keyboard) {
+                a.keys[events[i].vk & 0xFF] = !(events[i].flags & KEYEVENTF_KEYUP);
+            } else if (events[i].flags & MOUSEEVENTF_LEFTDOWN) {
+                a.mouseLeft = true;
+            } else if (events[i].flags & MOUSEEVENTF_LEFTUP) {
+                a.mouseLeft = false;
+            }
+        }
+        if (step.count) Send(events, step.count);
+
+        if (++a.next == a.seq.stepCount) {
+            a.live = false;
+            m_completed.fetch_add(1, std::memory_order_relaxed);
+            m_lastMs.store(now - a.started, std::memory_order_relaxed);
+            m_totalMs.fetch_add(now - a.started, std::memory_order_relaxed);
+            return;
+        }
+        a.stepStart = now;
+    }
+}
+
+void InputScheduler::Release(Active& a) {
+    // Keys first and modifiers last, the order a user would lift them.
+    static const WORD kModifiers[] = { VK_SHIFT, VK_MENU, VK_CONTROL };
+    InputEvent events[256 + 1];
+    UINT count = 0;
+    for (int vk = 0; vk < 256; ++vk) {
+        if (!a.keys[vk] || vk == VK_SHIFT || vk == VK_MENU || vk == VK_CONTROL) continue;
+        events[count].type = InputEvent::Keyboard;
+        events[count].vk = (WORD)vk;
+        events[count].flags = KEYEVENTF_KEYUP;
+        ++count;
+    }
+    for (WORD vk : kModifiers) {
+        if (!a.keys[vk]) continue;
+        events[count].type = InputEvent::Keyboard;
+        events[count].vk = vk;
+        events[count].flags = KEYEVENTF_KEYUP;
+        ++count;
+    }
+    if (a.mouseLeft) {
+        events[count].type = InputEvent::Mouse;
+        events[count].vk = 0;
+        events[count].flags = MOUSEEVENTF_LEFTUP;
+        ++count;
+    }
+    if (count) Send(events, count);
+}
+
+void InputScheduler::Send(const InputEvent* events, UINT count) {
+    g_Trace.Record(TraceInput, 0, count, events[0].vk, (uint8_t)events[0].type);
+    g_WindowSystem->SendInputs(events, count);
+    m_batches.fetch_add(1, std::memory_order_relaxed);
+    m_events.fetch_add(count, std::memory_order_relaxed);
+}
+
+void InputScheduler::Cancel(Handle handle) {
+    Active* a = Lookup(handle);
+    if (!a) return;
+    Release(*a);
+    a->live = false; // its wheel entry goes stale and is skipped
+    m_cancelled.fetch_add(1, std::memory_order_relaxed);
+}
+
+void InputScheduler::CancelAll() {
+    for (size_t slot = 0; slot < kMaxActive; ++slot) {
+        if (m_active[slot].live) Cancel(MakeHandle(slot, m_active[slot].generation));
+    }
+}
+
+void InputScheduler::Advance(uint64_t nowMs) {
+    m_expired.clear();
+    m_wheel.Advance(nowMs, m_expired);
+    for (uint32_t id : m_expired) {
+        Active* a = Lookup(id);
+        if (a && a->due <= nowMs) Run((size_t)(id & 0xFF) - 1);
+    }
+}
+
+uint64_t InputScheduler::NextDue() const {
+    uint64_t due = kIdle;
+    for (const Active& a : m_active) {
+        if (a.live && a.due < due) due = a.due;
+    }
+    return due;
+}
+
+bool InputScheduler::Running(Handle handle) const {
+    size_t slot = (size_t)(handle & 0xFF) - 1;
+    if (handle == 0 || slot >= kMaxActive) return false;
+    return m_active[slot].live && m_active[slot].generation == (uint16_t)(handle >> 8);
+}
+
+bool InputScheduler::Guarded() const {
+    for (const Active& a : m_active) {
+        if (a.live && a.seq.steps[a.next].guarded) return true;
+    }
+    return false;
+}
+
+InputScheduler::Stats InputScheduler::GetStats() const {
+    Stats s;
+    s.sequences = m_sequences.load(std::memory_order_relaxed);
+    s.cancelled = m_cancelled.load(std::memory_order_relaxed);
+    s.completed = m_completed.load(std::memory_order_relaxed);
+    s.timeouts = m_timeouts.load(std::memory_order_relaxed);
+    s.batches = m_batches.load(std::memory_order_relaxed);
+    s.events = m_events.load(std::memory_order_relaxed);
+    s.lastMs = m_lastMs.load(std::memory_order_relaxed);
+    s.totalMs = m_totalMs.load(std::memory_order_relaxed);
+    return s;
+}
@@ -0,0 +1,150 @@
+#pragma once
+#include "platform.hpp"
+#include "window_system.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A short script of synthetic input. Each step waits, then sends its events
+// in a single SendInputs call. A step waits at least `minMs`, then until its
+// `until` conditions all hold or `timeoutMs` passes since the previous step.
+struct InputSequence {
+    enum Until : uint8_t {
+        UntilKeysUp = 1 << 0,     // watched key and modifiers are all up
+        UntilKeyDown = 1 << 1,    // watched key is seen down
+        UntilForeground = 1 << 2, // foreground window belongs to this process
+    };
+    enum Mods : uint8_t { ModCtrl = 1 << 0, ModAlt = 1 << 1, ModShift = 1 << 2 };
+
+    struct Step {
+        uint32_t minMs;
+        uint32_t timeoutMs;
+        uint8_t until;
+        uint8_t first; // index into events
+        uint8_t count;
+        bool guarded;  // hotkey edges are ignored while this step is pending
+    };
+    static const size_t kMaxSteps = 16;
+    static const size_t kMaxEvents = 32;
+
+    Step steps[kMaxSteps];
+    InputEvent events[kMaxEvents];
+    uint8_t stepCount = 0;
+    uint8_t eventCount = 0;
+    // Key the Until conditions look at.
+    WORD watchVk = 0;
+    uint8_t watchMods = 0;
+
+    // Begins a new step that fires `ms` after the previous one.
+    InputSequence& Wait(uint32_t ms, bool guarded = false);
+    // Begins a new step that fires once `until` holds, bounded by the times.
+    InputSequence& WaitUntil(uint8_t until, uint32_t minMs, uint32_t timeoutMs, bool guarded = false);
+    // Append to the current step (starting one with no delay if needed).
+    InputSequence& Key(WORD vk, bool down);
+    InputSequence& Mouse(DWORD flags);
+};
+
+// Hashed timer wheel with 1 ms ticks. Timers further out than one revolution
+// stay in their slot and are skipped until their due time comes round.
+class TimerWheel {
+public:
+    static const uint64_t kSlots = 256;
+
+    explicit TimerWheel(uint64_t now = 0) : m_now(now), m_slots(kSlots) {}
+
+    uint64_t Now() const { return m_now; }
+    // `due` must be later than Now().
+    void Schedule(uint64_t due, uint32_t id);
+    // Moves the clock to `now` and appends the ids of every expired timer.
+    void Advance(uint64_t now, std::vector<uint32_t>& expired);
+
+private:
+    struct Entry {
+        uint64_t due;
+        uint32_t id;
+    };
+
+    uint64_t m_now;
+    std::vector<std::vector<Entry>> m_slots;
+};
+
+// Runs input sequences on the worker thread. The scheduler has no clock of
+// its own: time only moves when Advance() is called, so the worker passes
+// real milliseconds and benchmarks pass a virtual clock. Cancelling a
+// sequence drops its unsent steps and releases any key or button it still
+// holds.
+class InputScheduler {
+public:
+    typedef uint32_t Handle; // 0 = none
+    static const uint64_t kIdle = ~0ull;
+
+    struct Stats {
+        uint64_t sequences;
+        uint64_t cancelled;
+        uint64_t completed;
+        uint64_t timeouts; // steps that fired without their condition
+        uint64_t batches;  // SendInputs calls
+        uint64_t events;
+        uint64_t lastMs;   // start-to-finish time of the last completed sequence
+        uint64_t totalMs;
+    };
+
+    // How often a step waiting on a condition re-checks it.
+    static const uint32_t kPollMs = 2;
+
+    // Starts `seq` at the current time; a first step that is already ready
+    // fires immediately.
+    Handle Start(const InputSequence& seq);
+    // No-op for finished or stale handles.
+    void Cancel(Handle handle);
+    void CancelAll();
+    // Fires every step due at or before `nowMs`.
+    void Advance(uint64_t nowMs);
+
+    uint64_t Now() const { return m_wheel.Now(); }
+    // Due time of the earliest pending step, or kIdle.
+    uint64_t NextDue() const;
+    bool Running(Handle handle) const;
+    // True while a running sequence waits on a guarded step.
+    bool Guarded() const;
+    Stats GetStats() const;
+
+private:
+    static const size_t kMaxActive = 8;
+
+    struct Active {
+        InputSequence seq;
+        uint64_t started = 0;
+        uint64_t stepStart = 0;
+        uint64_t due = 0;
+        uint16_t generation = 0;
+        uint8_t next = 0;
+        bool live = false;
+        bool keys[256] = {};
+        bool mouseLeft = false;
+    };
+
+    static Handle MakeHandle(size_t slot, uint16_t generation) { return ((Handle)generation << 8) | (Handle)(slot + 1); }
+    Active* Lookup(Handle handle);
+    // Fires the steps of `slot` that are ready and schedules the next check.
+    void Run(size_t slot);
+    static bool Satisfied(const InputSequence& seq, uint8_t until);
+    void Release(Active& a);
+    void Send(const InputEvent* events, UINT count);
+
+    TimerWheel m_wheel;
+    Active m_active[kMaxActive];
+    std::vector<uint32_t> m_expired;
+
+    std::atomic<uint64_t> m_sequences{ 0 };
+    std::atomic<uint64_t> m_cancelled{ 0 };
+    std::atomic<uint64_t> m_completed{ 0 };
+    std::atomic<uint64_t> m_timeouts{ 0 };
+    std::atomic<uint64_t> m_batches{ 0 };
+    std::atomic<uint64_t> m_events{ 0 };
+    std::atomic<uint64_t> m_lastMs{ 0 };
+    std::atomic<uint64_t> m_totalMs{ 0 };
+};
+
+extern InputScheduler g_InputScheduler;
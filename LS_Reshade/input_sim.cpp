@@ -0,0 +1,41 @@
+#include "input_sim.hpp"
+
+namespace InputSim {
+    void AppendClick(InputSequence& seq, uint32_t holdMs) {
+        seq.Mouse(MOUSEEVENTF_LEFTDOWN);
+        seq.Wait(holdMs);
+        seq.Mouse(MOUSEEVENTF_LEFTUP);
+    }
+
+    void AppendCombo(InputSequence& seq, int vk, bool ctrl, bool alt, bool shift) {
+        if (ctrl) seq.Key(VK_CONTROL, true);
+        if (alt) seq.Key(VK_MENU, true);
+        if (shift) seq.Key(VK_SHIFT, true);
+        seq.Key((WORD)vk, true);
+
+        // Hold for at least a frame so a per-frame key poll sees the press.
+        seq.WaitUntil(InputSequence::UntilKeyDown, 20, 150, true);
+        seq.Key((WORD)vk, false);
+        if (shift) seq.Key(VK_SHIFT, false);
+        if (alt) seq.Key(VK_MENU, false);
+        if (ctrl) seq.Key(VK_CONTROL, false);
+        seq.WaitUntil(InputSequence::UntilKeysUp, 0, 200, true);
+    }
+
+    InputSequence ToggleSequence(bool on, int vk, bool ctrl, bool alt, bool shift) {
+        InputSequence seq;
+        seq.watchVk = (WORD)vk;
+        seq.watchMods = (ctrl ? InputSequence::ModCtrl : 0) | (alt ? InputSequence::ModAlt : 0) | (shift ? InputSequence::ModShift : 0);
+        if (on) {
+            // The user lets go of the hotkey and WindowManager brings LS forward.
+            seq.WaitUntil(InputSequence::UntilKeysUp | InputSequence::UntilForeground, 0, 250);
+            AppendClick(seq, 20);
+            seq.WaitUntil(InputSequence::UntilForeground, 0, 200);
+            AppendCombo(seq, vk, ctrl, alt, shift);
+        } else {
+            seq.WaitUntil(InputSequence::UntilKeysUp, 0, 450);
+            AppendClick(seq, 20);
+        }
+        return seq;
+    }
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include "platform.hpp"
+#include "input_scheduler.hpp"
+
+// --- Input Simulation Helper ---
+// Builders only; the sequences are played by g_InputScheduler.
+namespace InputSim {
+    // End-to-end time of the old fixed-delay toggle scripts, for comparison.
+    const uint32_t kFixedDelayOnMs = 850;
+    const uint32_t kFixedDelayOffMs = 700;
+
+    // Left button down, `holdMs`, up.
+    void AppendClick(InputSequence& seq, uint32_t holdMs);
+    // Modifiers and key down in one batch, held until the key is seen down,
+    // then all up in one batch and guarded until they are seen up, so the
+    // synthetic press is not taken for the hotkey.
+    void AppendCombo(InputSequence& seq, int vk, bool ctrl, bool alt, bool shift);
+    // The auto click & repress script run after a passthrough toggle. Each
+    // step waits on what it needs (hotkey released, LS in the foreground,
+    // key state) with the old fixed delay as its timeout.
+    InputSequence ToggleSequence(bool on, int vk, bool ctrl, bool alt, bool shift);
+}
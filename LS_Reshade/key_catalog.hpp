@@ -0,0 +1,130 @@
+#pragma once
+#include "platform.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// --- Key Catalog ---
+// Display names for all 256 virtual-key codes, built at compile time, so a
+// label is a table lookup. Codes Windows leaves unassigned read "VK 0xNN".
+namespace KeyCatalog {
+    enum Flags : uint8_t {
+        Named = 1 << 0,    // a key Windows defines
+        Modifier = 1 << 1, // Ctrl, Alt or Shift (either side): part of a chord, not its key
+        Mouse = 1 << 2,    // a mouse button; the keyboard hook never reports it
+    };
+
+    struct Key {
+        char name[20];
+        uint8_t flags;
+    };
+
+    namespace detail {
+        struct Entry {
+            uint8_t vk;
+            const char* name;
+            uint8_t flags;
+        };
+
+        constexpr Entry kNamed[] = {
+            { 0x01, "Left Mouse", Mouse }, { 0x02, "Right Mouse", Mouse }, { 0x03, "Cancel", 0 },
+            { 0x04, "Middle Mouse", Mouse }, { 0x05, "Mouse 4", Mouse }, { 0x06, "Mouse 5", Mouse },
+            { 0x08, "Backspace", 0 }, { 0x09, "Tab", 0 }, { 0x0C, "Clear", 0 }, { 0x0D, "Enter", 0 },
+            { 0x10, "Shift", Modifier }, { 0x11, "Ctrl", Modifier }, { 0x12, "Alt", Modifier },
+            { 0x13, "Pause", 0 }, { 0x14, "Caps Lock", 0 },
+            { 0x15, "IME Kana", 0 }, { 0x16, "IME On", 0 }, { 0x17, "IME Junja", 0 }, { 0x18, "IME Final", 0 },
+            { 0x19, "IME Kanji", 0 }, { 0x1A, "IME Off", 0 }, { 0x1B, "Escape", 0 }, { 0x1C, "IME Convert", 0 },
+            { 0x1D, "IME Nonconvert", 0 }, { 0x1E, "IME Accept", 0 }, { 0x1F, "IME Mode", 0 },
+            { 0x20, "Space", 0 }, { 0x21, "Page Up", 0 }, { 0x22, "Page Down", 0 }, { 0x23, "End", 0 },
+            { 0x24, "Home", 0 }, { 0x25, "Left", 0 }, { 0x26, "Up", 0 }, { 0x27, "Right", 0 }, { 0x28, "Down", 0 },
+            { 0x29, "Select", 0 }, { 0x2A, "Print", 0 }, { 0x2B, "Execute", 0 }, { 0x2C, "Print Screen", 0 },
+            { 0x2D, "Insert", 0 }, { 0x2E, "Delete", 0 }, { 0x2F, "Help", 0 },
+            { 0x5B, "Left Win", 0 }, { 0x5C, "Right Win", 0 }, { 0x5D, "Menu", 0 }, { 0x5F, "Sleep", 0 },
+            { 0x6A, "Num *", 0 }, { 0x6B, "Num +", 0 }, { 0x6C, "Num Separator", 0 }, { 0x6D, "Num -", 0 },
+            { 0x6E, "Num .", 0 }, { 0x6F, "Num /", 0 },
+            { 0x90, "Num Lock", 0 }, { 0x91, "Scroll Lock", 0 },
+            { 0xA0, "Left Shift", Modifier }, { 0xA1, "Right Shift", Modifier }, { 0xA2, "Left Ctrl", Modifier },
+            { 0xA3, "Right Ctrl", Modifier }, { 0xA4, "Left Alt", Modifier }, { 0xA5, "Right Alt", Modifier },
+            { 0xA6, "Browser Back", 0 }, { 0xA7, "Browser Forward", 0 }, { 0xA8, "Browser Refresh", 0 },
+            { 0xA9, "Browser Stop", 0 }, { 0xAA, "Browser Search", 0 }, { 0xAB, "Browser Favorites", 0 },
+            { 0xAC, "Browser Home", 0 }, { 0xAD, "Volume Mute", 0 }, { 0xAE, "Volume Down", 0 },
+            { 0xAF, "Volume Up", 0 }, { 0xB0, "Next Track", 0 }, { 0xB1, "Previous Track", 0 },
+            { 0xB2, "Stop Media", 0 }, { 0xB3, "Play/Pause", 0 }, { 0xB4, "Mail", 0 }, { 0xB5, "Select Media", 0 },
+            { 0xB6, "Launch App 1", 0 }, { 0xB7, "Launch App 2", 0 },
+            { 0xBA, ";", 0 }, { 0xBB, "=", 0 }, { 0xBC, ",", 0 }, { 0xBD, "-", 0 }, { 0xBE, ".", 0 },
+            { 0xBF, "/", 0 }, { 0xC0, "`", 0 }, { 0xDB, "[", 0 }, { 0xDC, "\\", 0 }, { 0xDD, "]", 0 },
+            { 0xDE, "'", 0 }, { 0xDF, "OEM 8", 0 }, { 0xE2, "OEM 102", 0 }, { 0xE5, "IME Process", 0 },
+            { 0xF6, "Attn", 0 }, { 0xF7, "CrSel", 0 }, { 0xF8, "ExSel", 0 }, { 0xF9, "Erase EOF", 0 },
+            { 0xFA, "Play", 0 }, { 0xFB, "Zoom", 0 }, { 0xFD, "PA1", 0 }, { 0xFE, "OEM Clear", 0 },
+        };
+
+        constexpr void Set(Key& key, const char* prefix, const char* suffix, uint8_t flags) {
+            size_t n = 0;
+            for (const char* p = prefix; *p && n + 1 < sizeof(key.name); ++p) key.name[n++] = *p;
+            for (const char* p = suffix; *p && n + 1 < sizeof(key.name); ++p) key.name[n++] = *p;
+            key.name[n] = '\0';
+            key.flags = flags;
+        }
+
+        constexpr std::array<Key, 256> Build() {
+            std::array<Key, 256> keys{};
+            const char hex[] = "0123456789ABCDEF";
+            for (int vk = 0; vk < 256; ++vk) {
+                const char code[] = { hex[vk >> 4], hex[vk & 15], '\0' };
+                Set(keys[vk], "VK 0x", code, 0);
+            }
+            Set(keys[0], "None", "", 0);
+            for (const Entry& e : kNamed) Set(keys[e.vk], e.name, "", (uint8_t)(e.flags | Named));
+            for (int i = 0; i < 10; ++i) {
+                const char digit[] = { (char)('0' + i), '\0' };
+                Set(keys[0x30 + i], digit, "", Named);
+                Set(keys[0x60 + i], "Num ", digit, Named);
+            }
+            for (int i = 0; i < 26; ++i) {
+                const char letter[] = { (char)('A' + i), '\0' };
+                Set(keys[0x41 + i], letter, "", Named);
+            }
+            for (int i = 1; i <= 24; ++i) {
+                const char number[] = { i < 10 ? (char)('0' + i) : (char)('0' + i / 10), i < 10 ? '\0' : (char)('0' + i % 10), '\0' };
+                Set(keys[0x70 + i - 1], "F", number, Named);
+            }
+            return keys;
+        }
+    }
+
+    inline constexpr std::array<Key, 256> kKeys = detail::Build();
+
+    constexpr const char* Name(int vk) { return kKeys[vk & 0xFF].name; }
+    constexpr bool IsModifier(int vk) { return (kKeys[vk & 0xFF].flags & Modifier) != 0; }
+    // What a hotkey can be bound to: named keyboard keys other than the modifiers.
+    constexpr bool Bindable(int vk) { return (kKeys[vk & 0xFF].flags & (Named | Modifier | Mouse)) == Named; }
+
+    namespace detail {
+        constexpr size_t CountBindable() {
+            size_t n = 0;
+            for (int vk = 0; vk < 256; ++vk) n += Bindable(vk) ? 1 : 0;
+            return n;
+        }
+        constexpr std::array<uint8_t, CountBindable()> BuildBindable() {
+            std::array<uint8_t, CountBindable()> out{};
+            size_t n = 0;
+            for (int vk = 0; vk < 256; ++vk) {
+                if (Bindable(vk)) out[n++] = (uint8_t)vk;
+            }
+            return out;
+        }
+    }
+
+    // Every bindable code, ascending: the key list of the settings UI.
+    inline constexpr auto kBindable = detail::BuildBindable();
+
+    static_assert(Name(VK_HOME)[0] == 'H' && Name(VK_F12)[2] == '2', "key catalog");
+
+    // "Ctrl+Alt+Home". Modifiers are HotkeyChord::Mods bits (Ctrl 1, Alt 2,
+    // Shift 4). Returns the length written, as snprintf.
+    inline int FormatChord(char* out, size_t size, int vk, uint8_t mods) {
+        return snprintf(out, size, "%s%s%s%s", (mods & 1) ? "Ctrl+" : "", (mods & 2) ? "Alt+" : "",
+                        (mods & 4) ? "Shift+" : "", Name(vk));
+    }
+}
@@ -0,0 +1,160 @@
+#include "log_format.hpp"
+#include <cstdio>
+
+namespace LogFormat {
+    static_assert(Checker<TypeList<int>>::Matches("%-+ #08d") && !Checker<TypeList<int>>::Matches("%------d"),
+                  "flag runs are capped at kMaxFlags");
+
+    namespace {
+        struct Reader {
+            const LogRecord& record;
+            size_t pos;
+
+            bool Next(Tag& tag, uint64_t& bits, const char*& text, uint16_t& length, uint8_t& width) {
+                if (pos >= record.size) return false;
+                tag = (Tag)record.payload[pos++];
+                width = sizeof(bits);
+                if (tag == TagSigned || tag == TagUnsigned) {
+                    if (pos >= record.size) return false;
+                    width = record.payload[pos++];
+                }
+                if (tag == TagString) {
+                    if (pos + sizeof(length) > record.size) return false;
+                    memcpy(&length, record.payload + pos, sizeof(length));
+                    pos += sizeof(length);
+                    text = (const char*)record.payload + pos;
+                    pos += length;
+                    return pos <= record.size;
+                }
+                if (pos + sizeof(bits) > record.size) return false;
+                memcpy(&bits, record.payload + pos, sizeof(bits));
+                pos += sizeof(bits);
+                return true;
+            }
+
+            // Next argument as an int (for '*' width/precision).
+            bool NextInt(int& value) {
+                Tag tag;
+                uint64_t bits = 0;
+                const char* text;
+                uint16_t length;
+                uint8_t width;
+                if (!Next(tag, bits, text, length, width) || tag == TagString) return false;
+                value = (int)(int64_t)bits;
+                return true;
+            }
+        };
+    }
+
+    void Render(const LogRecord& record, std::string& out) {
+        if (!record.site) {
+            out.append((const char*)record.payload, record.size);
+            return;
+        }
+
+        Reader reader = { record, 0 };
+        char tmp[kLogPayload + 64];
+        for (const char* p = record.site->format; *p; ++p) {
+            if (*p != '%') {
+                out.push_back(*p);
+                continue;
+            }
+            if (p[1] == '%') {
+                out.push_back('%');
+                ++p;
+                continue;
+            }
+
+            // Rebuild the conversion with '*' expanded and the length modifier
+            // normalized to the width the argument was stored with.
+            char spec[48];
+            size_t n = 0;
+            spec[n++] = *p++;
+            // Check rejects longer flag runs; skip the excess all the same.
+            for (; *p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0'; ++p) {
+                if (n <= kMaxFlags) spec[n++] = *p;
+            }
+            int star;
+            if (*p == '*') {
+                ++p;
+                if (reader.NextInt(star)) n += snprintf(spec + n, sizeof(spec) - n - 8, "%d", star);
+            }
+            while (*p >= '0' && *p <= '9' && n < 24) spec[n++] = *p++;
+            if (*p == '.') {
+                spec[n++] = *p++;
+                if (*p == '*') {
+                    ++p;
+                    if (reader.NextInt(star)) n += snprintf(spec + n, sizeof(spec) - n - 8, "%d", star);
+                }
+                while (*p >= '0' && *p <= '9' && n < 36) spec[n++] = *p++;
+            }
+            while (*p == 'h' || *p == 'l' || *p == 'z' || *p == 'j' || *p == 't' || *p == 'L') ++p;
+            char conv = *p;
+            if (!conv) break;
+
+            Tag tag;
+            uint64_t bits = 0;
+            const char* text = nullptr;
+            uint16_t length = 0;
+            uint8_t width = 8;
+            if (!reader.Next(tag, bits, text, length, width)) {
+                out += "<?>";
+                continue;
+            }
+            // As printf sees an argument of that width: unsigned conversions
+            // take its bits, signed ones its sign.
+            if (width < 8 && (tag == TagSigned || tag == TagUnsigned)) {
+                const unsigned shift = 64 - width * 8;
+                if (conv == 'd' || conv == 'i') bits = (uint64_t)((int64_t)(bits << shift) >> shift);
+                else bits &= ~0ull >> shift;
+            }
+
+            int written = 0;
+            switch (conv) {
+                case 'd': case 'i': case 'u': case 'x': case 'X': case 'o':
+                    spec[n++] = 'l';
+                    spec[n++] = 'l';
+                    spec[n++] = conv;
+                    spec[n] = '\0';
+                    written = (conv == 'd' || conv == 'i')
+                        ? snprintf(tmp, sizeof(tmp), spec, (long long)(int64_t)bits)
+                        : snprintf(tmp, sizeof(tmp), spec, (unsigned long long)bits);
+                    break;
+                case 'c':
+                    spec[n++] = 'c';
+                    spec[n] = '\0';
+                    written = snprintf(tmp, sizeof(tmp), spec, (int)bits);
+                    break;
+                case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+                    double d;
+                    memcpy(&d, &bits, sizeof(d));
+                    spec[n++] = conv;
+                    spec[n] = '\0';
+                    written = snprintf(tmp, sizeof(tmp), spec, d);
+                    break;
+                }
+                case 's': {
+                    char str[kLogPayload + 1];
+                    if (tag == TagString) {
+                        memcpy(str, text, length);
+                        str[length] = '\0';
+                    } else {
+                        str[0] = '\0';
+                    }
+                    spec[n++] = 's';
+                    spec[n] = '\0';
+                    written = snprintf(tmp, sizeof(tmp), spec, str);
+                    break;
+                }
+                case 'p':
+                    spec[n++] = 'p';
+                    spec[n] = '\0';
+                    written = snprintf(tmp, sizeof(tmp), spec, (void*)(uintptr_t)bits);
+                    break;
+                default:
+                    break;
+            }
+            if (written > 0) out.append(tmp, (size_t)written < sizeof(tmp) ? (size_t)written : sizeof(tmp) - 1);
+        }
+    }
+}
@@ -0,0 +1,225 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+// Binary log records: the LOG_* macros check the printf-style format against
+// the argument types at compile time, then copy the raw arguments into a
+// fixed-size record on the stack. Text is rendered later by the logger's
+// writer thread, so the calling thread never formats or allocates.
+
+enum class LogLevel : uint8_t { Trace, Debug, Info, Warn, Error };
+
+// Levels below this compile out entirely (0 = Trace ... 4 = Error).
+#ifndef LS_LOG_MIN_LEVEL
+#define LS_LOG_MIN_LEVEL 1
+#endif
+
+struct LogSite {
+    LogLevel level;
+    const char* format;
+};
+
+const size_t kLogPayload = 496;
+
+struct LogRecord {
+    const LogSite* site; // nullptr: payload is preformatted text
+    uint16_t size;
+    uint8_t payload[kLogPayload];
+};
+
+namespace LogFormat {
+    enum ArgKind : uint8_t { KindSigned, KindUnsigned, KindFloat, KindString, KindPointer, KindInvalid };
+
+    // Payload tags, one per argument. Integer tags are followed by the
+    // argument's width in bytes, then the value widened to 64 bits.
+    enum Tag : uint8_t { TagSigned = 'i', TagUnsigned = 'u', TagFloat = 'f', TagString = 's', TagPointer = 'p' };
+
+    template<typename... T> struct TypeList {};
+    // Declared only; used in decltype to capture the macro arguments' types.
+    template<typename... T> TypeList<std::decay_t<T>...> Types(const T&...);
+
+    template<typename T>
+    constexpr ArgKind KindOf() {
+        if constexpr (std::is_same<T, bool>::value) return KindUnsigned;
+        else if constexpr (std::is_enum<T>::value) return std::is_signed<std::underlying_type_t<T>>::value ? KindSigned : KindUnsigned;
+        else if constexpr (std::is_integral<T>::value) return std::is_signed<T>::value ? KindSigned : KindUnsigned;
+        else if constexpr (std::is_floating_point<T>::value) return KindFloat;
+        else if constexpr (std::is_same<T, const char*>::value || std::is_same<T, char*>::value || std::is_same<T, std::string>::value) return KindString;
+        else if constexpr (std::is_pointer<T>::value || std::is_null_pointer<T>::value) return KindPointer;
+        else return KindInvalid;
+    }
+
+    template<typename T>
+    constexpr size_t SizeOf() {
+        if constexpr (std::is_enum<T>::value) return sizeof(std::underlying_type_t<T>);
+        else return sizeof(T);
+    }
+
+    constexpr bool IsIntegerKind(ArgKind kind) { return kind == KindSigned || kind == KindUnsigned; }
+
+    // Flag characters allowed in one conversion (each of "-+ #0" once);
+    // Render rebuilds conversions in a small fixed buffer.
+    constexpr size_t kMaxFlags = 5;
+
+    // Walks a printf format and checks every conversion (and '*' width or
+    // precision) against the next argument. Integer arguments must fit the
+    // conversion's length modifier; %n, unknown conversions and more than
+    // kMaxFlags flags are rejected.
+    constexpr bool Check(const char* fmt, const ArgKind* kinds, const size_t* sizes, size_t count) {
+        size_t arg = 0;
+        for (const char* p = fmt; *p; ++p) {
+            if (*p != '%') continue;
+            ++p;
+            if (*p == '%') continue;
+            size_t flags = 0;
+            while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0') {
+                if (++flags > kMaxFlags) return false;
+                ++p;
+            }
+            if (*p == '*') {
+                if (arg >= count || !IsIntegerKind(kinds[arg])) return false;
+                ++arg;
+                ++p;
+            }
+            while (*p >= '0' && *p <= '9') ++p;
+            if (*p == '.') {
+                ++p;
+                if (*p == '*') {
+                    if (arg >= count || !IsIntegerKind(kinds[arg])) return false;
+                    ++arg;
+                    ++p;
+                }
+                while (*p >= '0' && *p <= '9') ++p;
+            }
+            size_t maxInt = sizeof(int);
+            if (*p == 'h') { ++p; if (*p == 'h') ++p; }
+            else if (*p == 'l') { ++p; maxInt = sizeof(long); if (*p == 'l') { ++p; maxInt = sizeof(long long); } }
+            else if (*p == 'z' || *p == 'j' || *p == 't') { ++p; maxInt = 8; }
+            else if (*p == 'L') { ++p; }
+
+            if (arg >= count) return false;
+            ArgKind kind = kinds[arg];
+            size_t size = sizes[arg];
+            ++arg;
+            switch (*p) {
+                case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+                    if (!IsIntegerKind(kind) || size > maxInt) return false;
+                    break;
+                case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+                    if (kind != KindFloat) return false;
+                    break;
+                case 's':
+                    if (kind != KindString) return false;
+                    break;
+                case 'p':
+                    if (kind != KindPointer) return false;
+                    break;
+                default:
+                    return false;
+            }
+        }
+        return arg == count;
+    }
+
+    template<typename List> struct Checker;
+    template<typename... T>
+    struct Checker<TypeList<T...>> {
+        static constexpr bool Matches(const char* fmt) {
+            constexpr ArgKind kinds[] = { KindOf<T>()..., KindInvalid };
+            constexpr size_t sizes[] = { SizeOf<T>()..., 0 };
+            return Check(fmt, kinds, sizes, sizeof...(T));
+        }
+    };
+
+    // --- Encoding (producer side) ---
+
+    inline bool Put(LogRecord& r, const void* data, size_t size) {
+        if (r.size + size > kLogPayload) return false;
+        memcpy(r.payload + r.size, data, size);
+        r.size = (uint16_t)(r.size + size);
+        return true;
+    }
+
+    inline void PutTagged(LogRecord& r, Tag tag, uint64_t bits) {
+        if (r.size + 1 + sizeof(bits) > kLogPayload) return;
+        r.payload[r.size++] = tag;
+        Put(r, &bits, sizeof(bits));
+    }
+
+    inline void PutInteger(LogRecord& r, Tag tag, uint8_t width, uint64_t bits) {
+        if (r.size + 2 + sizeof(bits) > kLogPayload) return;
+        r.payload[r.size++] = tag;
+        r.payload[r.size++] = width;
+        Put(r, &bits, sizeof(bits));
+    }
+
+    inline void PutString(LogRecord& r, const char* s, size_t length) {
+        if ((size_t)r.size + 3 > kLogPayload) return;
+        size_t room = kLogPayload - r.size - 3;
+        uint16_t n = (uint16_t)(length < room ? length : room);
+        r.payload[r.size++] = TagString;
+        Put(r, &n, sizeof(n));
+        Put(r, s, n);
+    }
+
+    template<typename A>
+    void Encode(LogRecord& r, const A& value) {
+        typedef std::decay_t<A> T;
+        constexpr ArgKind kind = KindOf<T>();
+        if constexpr (kind == KindString) {
+            if constexpr (std::is_same<T, std::string>::value) {
+                PutString(r, value.data(), value.size());
+            } else {
+                const char* s = value;
+                if (s) PutString(r, s, strlen(s));
+                else PutString(r, "(null)", 6);
+            }
+        } else if constexpr (kind == KindFloat) {
+            double d = (double)value;
+            uint64_t bits;
+            memcpy(&bits, &d, sizeof(bits));
+            PutTagged(r, TagFloat, bits);
+        } else if constexpr (kind == KindPointer) {
+            PutTagged(r, TagPointer, (uint64_t)(uintptr_t)value);
+        } else {
+            // The width printf would see: promoted to int at least.
+            constexpr uint8_t width = (uint8_t)(SizeOf<T>() < sizeof(int) ? sizeof(int) : SizeOf<T>());
+            if constexpr (kind == KindSigned) PutInteger(r, TagSigned, width, (uint64_t)(int64_t)value);
+            else PutInteger(r, TagUnsigned, width, (uint64_t)value);
+        }
+    }
+
+    // Renders a record's format + payload (consumer side). Appends to `out`.
+    void Render(const LogRecord& record, std::string& out);
+}
+
+// Copies the record into the logger's ring; defined in logger.cpp.
+void LogSubmit(const LogRecord& record);
+
+template<typename... Args>
+void LogWrite(const LogSite* site, const Args&... args) {
+    LogRecord record;
+    record.site = site;
+    record.size = 0;
+    (LogFormat::Encode(record, args), ...);
+    LogSubmit(record);
+}
+
+#define LS_LOG(level, fmt, ...)                                                                        \
+    do {                                                                                               \
+        static_assert(::LogFormat::Checker<decltype(::LogFormat::Types(__VA_ARGS__))>::Matches(fmt),  \
+                      "log format does not match its arguments: " fmt);                              \
+        if constexpr ((int)(level) >= LS_LOG_MIN_LEVEL) {                                              \
+            static constexpr ::LogSite logSite_ = { level, fmt };                                      \
+            ::LogWrite(&logSite_, ##__VA_ARGS__);                                                      \
+        }                                                                                              \
+    } while (0)
+
+#define LOG_TRACE(fmt, ...) LS_LOG(::LogLevel::Trace, fmt, ##__VA_ARGS__)
+#define LOG_DEBUG(fmt, ...) LS_LOG(::LogLevel::Debug, fmt, ##__VA_ARGS__)
+#define LOG_INFO(fmt, ...)  LS_LOG(::LogLevel::Info, fmt, ##__VA_ARGS__)
+#define LOG_WARN(fmt, ...)  LS_LOG(::LogLevel::Warn, fmt, ##__VA_ARGS__)
+#define LOG_ERROR(fmt, ...) LS_LOG(::LogLevel::Error, fmt, ##__VA_ARGS__)
@@ -1,35 +1,158 @@
 #include "logger.hpp"
+#include "mpsc_ring.hpp"
+#include <cstring>
+#include <filesystem>
 #include <iostream>
+#include <memory>
+#ifdef _WIN32
 #include <windows.h>
+#endif
+
+namespace {
+    typedef MpscRing<LogRecord, Logger::kRingRecords> LogRing;
+    // Heap-allocated once (about 512 KB) and kept for the process lifetime.
+    LogRing* g_Ring = nullptr;
+    std::atomic<uint64_t> g_Reported{ 0 };
+}
 
 std::ofstream Logger::logFile;
-std::mutex Logger::logMutex;
+std::mutex Logger::lifecycleMutex;
+std::mutex Logger::wakeMutex;
+std::condition_variable Logger::wake;
+std::thread Logger::writer;
+std::atomic<bool> Logger::running{ false };
+std::atomic<bool> Logger::stopping{ false };
+std::atomic<bool> Logger::sleeping{ false };
+std::atomic<uint64_t> Logger::dropped{ 0 };
 
 void Logger::Init(const std::wstring& logPath) {
-    std::lock_guard<std::mutex> lock(logMutex);
-    logFile.open(logPath, std::ios::out | std::ios::trunc);
+    std::lock_guard<std::mutex> lock(lifecycleMutex);
+    if (running) return;
+    if (!g_Ring) g_Ring = new LogRing();
+
+    logFile.open(std::filesystem::path(logPath), std::ios::out | std::ios::trunc);
     if (logFile.is_open()) {
-        logFile << "LS_ReShade Log Initialized" << std::endl;
+        logFile << "LS_ReShade Log Initialized\n";
+        logFile.flush();
     }
+    stopping = false;
+    sleeping = false;
+    running = true;
+    writer = std::thread(WriterThread);
 }
 
 void Logger::Log(const std::string& message) {
-    std::lock_guard<std::mutex> lock(logMutex);
-    if (logFile.is_open()) {
-        logFile << message << std::endl;
-        logFile.flush();
+    Log(message.data(), message.size());
+}
+
+void Logger::Log(const char* message, size_t length) {
+    LogRecord record;
+    record.site = nullptr;
+    record.size = (uint16_t)(length < kLogPayload ? length : kLogPayload);
+    memcpy(record.payload, message, record.size);
+    Submit(record);
+}
+
+void Logger::Submit(const LogRecord& record) {
+    if (!running.load(std::memory_order_acquire)) return;
+    bool pushed = g_Ring->TryPush([&](LogRecord& slot) {
+        slot.site = record.site;
+        slot.size = record.size;
+        memcpy(slot.payload, record.payload, record.size);
+    });
+    if (!pushed) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    // Pairs with the fence in WriterThread: either the writer sees this
+    // record before it blocks, or this sees it asleep and wakes it. Only the
+    // first producer to find it asleep takes the mutex.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping.load(std::memory_order_relaxed) && sleeping.exchange(false)) {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        wake.notify_one();
+    }
+}
+
+size_t Logger::Pending() {
+    return g_Ring ? g_Ring->ApproxSize() : 0;
+}
+
+size_t Logger::Drain(std::string& batch) {
+    static const char* const kLevelPrefix[] = { "[trace] ", "[debug] ", "", "[warn] ", "[error] " };
+    size_t count = 0;
+    while (g_Ring->TryPop([&](LogRecord& record) {
+#ifdef _WIN32
+        size_t start = batch.size();
+#endif
+        if (record.site) batch += kLevelPrefix[(int)record.site->level];
+        LogFormat::Render(record, batch);
+        batch.push_back('\n');
+#ifdef _WIN32
+        // Also print to debug console
+        OutputDebugStringA(batch.c_str() + start);
+#endif
+    })) {
+        ++count;
+    }
+    uint64_t lost = dropped.load(std::memory_order_relaxed);
+    uint64_t reported = g_Reported.load(std::memory_order_relaxed);
+    if (lost != reported) {
+        batch += "[Logger] dropped " + std::to_string(lost - reported) + " messages (ring full)\n";
+        g_Reported.store(lost, std::memory_order_relaxed);
+    }
+    return count;
+}
+
+void Logger::WriterThread() {
+    std::string batch;
+    batch.reserve(64 * 1024);
+    for (;;) {
+        bool stop = stopping.load(std::memory_order_acquire);
+        batch.clear();
+        Drain(batch);
+        if (!batch.empty() && logFile.is_open()) {
+            logFile.write(batch.data(), (std::streamsize)batch.size());
+            logFile.flush();
+        }
+        if (stop) break;
+
+        // Block until Submit or Close wakes us; no timeout, so an idle
+        // logger costs nothing. Announce it first, then look at the ring
+        // once more for a record pushed in between.
+        sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (g_Ring->ApproxSize() > 0) {
+            // Claimed but maybe not yet filled in: let the producer finish.
+            sleeping.store(false, std::memory_order_relaxed);
+            std::this_thread::yield();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wake.wait(lock, [] { return stopping.load() || !sleeping.load(); });
+        sleeping.store(false, std::memory_order_relaxed);
     }
-    // Also print to debug console
-    OutputDebugStringA((message + "\n").c_str());
 }
 
 void Logger::Close() {
-    std::lock_guard<std::mutex> lock(logMutex);
+    std::lock_guard<std::mutex> lock(lifecycleMutex);
+    if (!running) return;
+    running = false;
+    {
+        std::lock_guard<std::mutex> wakeLock(wakeMutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    if (writer.joinable()) writer.join();
     if (logFile.is_open()) {
         logFile.close();
     }
 }
 
+void LogSubmit(const LogRecord& record) {
+    Logger::Submit(record);
+}
+
 void Log(const std::string& message) {
     Logger::Log(message);
 }
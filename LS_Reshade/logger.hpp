@@ -1,23 +1,48 @@
 #pragma once
-#include <string>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <condition_variable>
 #include <fstream>
 #include <mutex>
+#include <string>
+#include <thread>
+#include "log_format.hpp"
 
+// Asynchronous logger. Producers (the LOG_* macros, or Log() for preformatted
+// text) copy a binary record into a lock-free MPSC ring and return; a
+// background writer thread, woken by the first record after it went idle,
+// renders and batches records into the file (and OutputDebugString on
+// Windows); with nothing to write it sleeps without a timeout. When the ring
+// is full the record is dropped and counted rather than blocking the caller.
+// Close() drains and flushes.
 class Logger {
 public:
+    static constexpr size_t kRingRecords = 1024;
+
     static void Init(const std::wstring& logPath);
     static void Log(const std::string& message);
+    static void Log(const char* message, size_t length);
+    static void Submit(const LogRecord& record);
     static void Close();
 
+    static uint64_t Dropped() { return dropped.load(std::memory_order_relaxed); }
+    // Records waiting for the writer (approximate).
+    static size_t Pending();
+
 private:
+    static void WriterThread();
+    static size_t Drain(std::string& batch);
+
     static std::ofstream logFile;
-    static std::mutex logMutex;
+    static std::mutex lifecycleMutex;
+    static std::mutex wakeMutex;
+    static std::condition_variable wake;
+    static std::thread writer;
+    static std::atomic<bool> running;
+    static std::atomic<bool> stopping;
+    static std::atomic<bool> sleeping; // writer blocked, waiting for a record
+    static std::atomic<uint64_t> dropped;
 };
 
 void Log(const std::string& message);
-template<typename... Args>
-void Log(const char* fmt, Args... args) {
-    char buffer[1024];
-    snprintf(buffer, sizeof(buffer), fmt, args...);
-    Log(std::string(buffer));
-}
@@ -1,462 +1,131 @@
 #include "../../../LosslessProxy/src/addon_api.hpp"
 #include "logger.hpp"
+#include "settings.hpp"
+#include "win32_window_system.hpp"
+#include "window_manager.hpp"
+#include "restore_journal.hpp"
+#include "worker.hpp"
+#include "hotkey_engine.hpp"
+#include "key_catalog.hpp"
+#include "metrics.hpp"
+#include "trace_recorder.hpp"
+#include "control_channel.hpp"
 #include "imgui.h"
 #include <windows.h>
-#include <atomic>
-#include <thread>
-#include <mutex>
-#include <map>
-#include <vector>
 #include <string>
-#include <cstring>
-#include <functional>
-
-// --- Global Settings ---
-struct Settings {
-    std::atomic<bool> threadRunning{ true };
-    std::atomic<bool> inputPassthrough{ false };
-    std::atomic<int> hotkeyVk{ VK_HOME };
-    std::atomic<bool> hotkeyCtrl{ false };
-    std::atomic<bool> hotkeyAlt{ false };
-    std::atomic<bool> hotkeyShift{ false };
-    std::atomic<bool> autoClickRepress{ true };
-    std::atomic<bool> isSimulating{ false };
-} g_Settings;
 
 ImGuiContext* g_ImGuiContext = nullptr;
+Win32WindowSystem g_Win32WindowSystem;
 
-// --- Input Simulation Helper ---
-namespace InputSim {
-    void SendKey(WORD vk, bool down) {
-        INPUT input = { 0 };
-        input.type = INPUT_KEYBOARD;
-        input.ki.wVk = vk;
-        input.ki.dwFlags = down ? 0 : KEYEVENTF_KEYUP;
-        SendInput(1, &input, sizeof(INPUT));
-    }
-
-    void Click() {
-        INPUT input = { 0 };
-        input.type = INPUT_MOUSE;
-        input.mi.dwFlags = MOUSEEVENTF_LEFTDOWN;
-        SendInput(1, &input, sizeof(INPUT));
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
-        input.mi.dwFlags = MOUSEEVENTF_LEFTUP;
-        SendInput(1, &input, sizeof(INPUT));
-    }
-
-    void PressCombo(int vk, bool ctrl, bool alt, bool shift) {
-        if (ctrl) SendKey(VK_CONTROL, true);
-        if (alt) SendKey(VK_MENU, true);
-        if (shift) SendKey(VK_SHIFT, true);
+// --- Config Helper ---
 
-        SendKey(vk, true);
-        std::this_thread::sleep_for(std::chrono::milliseconds(150));
-        SendKey(vk, false);
+extern "C" __declspec(dllexport) void AddonInitialize(IHost* host, ImGuiContext* ctx, void* alloc_func, void* free_func, void* user_data);
 
-        if (shift) SendKey(VK_SHIFT, false);
-        if (alt) SendKey(VK_MENU, false);
-        if (ctrl) SendKey(VK_CONTROL, false);
-    }
+// Directory of this DLL, with a trailing backslash. Resolved once.
+const std::wstring& GetAddonDir() {
+    static const std::wstring dir = [] {
+        HMODULE hModule = NULL;
+        GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, (LPCWSTR)&AddonInitialize, &hModule);
+        wchar_t path[MAX_PATH];
+        GetModuleFileNameW(hModule, path, MAX_PATH);
+        wchar_t* lastSlash = wcsrchr(path, L'\\');
+        if (lastSlash) *(lastSlash + 1) = L'\0';
+        return std::wstring(path);
+    }();
+    return dir;
 }
 
-// --- Window Management Helper ---
-class WindowManager {
-    struct WindowState {
-        WNDPROC originalProc = nullptr;
-        LONG_PTR originalStyle = 0;
-        LONG_PTR originalExStyle = 0;
-        bool stylesModified = false;
-        bool activated = false;
-    };
-
-    static std::map<HWND, WindowState> windows;
-    static std::mutex mutex;
-
-    // Custom Window Procedure
-    static LRESULT CALLBACK HookProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
-        // 1. Handle Cursor Visibility & Clipping (Priority)
-        if (g_Settings.inputPassthrough) {
-            if (uMsg == WM_SETCURSOR || uMsg == WM_MOUSEMOVE) {
-                SetCursor(LoadCursor(NULL, IDC_ARROW));
-                CURSORINFO ci = { sizeof(CURSORINFO) };
-                if (GetCursorInfo(&ci) && !(ci.flags & CURSOR_SHOWING)) {
-                    while (ShowCursor(TRUE) < 0);
-                }
-                ClipCursor(NULL);
-                if (uMsg == WM_SETCURSOR) return TRUE;
-            }
-        }
-
-        // 2. Retrieve Original WndProc
-        WNDPROC oldProc = nullptr;
-        {
-            std::lock_guard<std::mutex> lock(mutex);
-            auto it = windows.find(hwnd);
-            if (it != windows.end()) oldProc = it->second.originalProc;
-        }
-
-        // Fallback if not found (shouldn't happen often)
-        if (!oldProc) {
-            oldProc = (WNDPROC)GetWindowLongPtr(hwnd, GWLP_WNDPROC);
-            if (oldProc == HookProc) return DefWindowProc(hwnd, uMsg, wParam, lParam);
-        }
-
-        // 3. Call Original WndProc
-        LRESULT ret = CallWindowProc(oldProc, hwnd, uMsg, wParam, lParam);
-
-        // 4. Fix Click-Through
-        if (g_Settings.inputPassthrough && uMsg == WM_NCHITTEST && ret == HTTRANSPARENT) {
-            return HTCLIENT;
-        }
-
-        return ret;
+// --- Metrics Panel ---
+
+void RenderMetrics() {
+    static char status[128] = "";
+    MetricsSnapshot snap;
+    g_Metrics.Collect(snap);
+
+    ImGui::Text("Since reset: %.0f s", snap.seconds);
+    if (ImGui::BeginTable("dists", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Metric");
+        ImGui::TableSetupColumn("Count");
+        ImGui::TableSetupColumn("p50");
+        ImGui::TableSetupColumn("p99");
+        ImGui::TableSetupColumn("Max");
+        ImGui::TableSetupColumn("Unit");
+        ImGui::TableHeadersRow();
+        for (const MetricsSnapshot::Dist& d : snap.dists) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(d.name);
+            ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)d.summary.count);
+            ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)d.summary.p50);
+            ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)d.summary.p99);
+            ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)d.summary.max);
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(d.unit);
+        }
+        ImGui::EndTable();
     }
-
-public:
-    static void ProcessWindow(HWND hwnd) {
-        // 1. Subclassing
-        WNDPROC currentProc = (WNDPROC)GetWindowLongPtr(hwnd, GWLP_WNDPROC);
-        if (currentProc != HookProc) {
-            {
-                std::lock_guard<std::mutex> lock(mutex);
-                windows[hwnd].originalProc = currentProc;
-            }
-            SetWindowLongPtr(hwnd, GWLP_WNDPROC, (LONG_PTR)HookProc);
-        }
-
-        // 2. Style Modification
-        if (g_Settings.inputPassthrough) {
-            LONG_PTR exStyle = GetWindowLongPtr(hwnd, GWL_EXSTYLE);
-            LONG_PTR style = GetWindowLongPtr(hwnd, GWL_STYLE);
-
-            bool isNew = false;
-            bool isOverlay = false;
-            {
-                std::lock_guard<std::mutex> lock(mutex);
-                WindowState& state = windows[hwnd];
-                if (!state.stylesModified) {
-                    state.originalExStyle = exStyle;
-                    state.originalStyle = style;
-                    state.stylesModified = true;
-                }
-                if (!state.activated) {
-                    isNew = true;
-                    state.activated = true;
-                }
-                isOverlay = (state.originalExStyle & (WS_EX_TRANSPARENT | WS_EX_LAYERED | WS_EX_NOACTIVATE)) != 0;
-            }
-
-            LONG_PTR newExStyle = exStyle & ~(WS_EX_TRANSPARENT | WS_EX_NOACTIVATE | WS_EX_LAYERED);
-            LONG_PTR newStyle = style & ~WS_DISABLED;
-
-            bool stylesChanged = (newExStyle != exStyle || newStyle != style);
-
-            if (stylesChanged) {
-                SetWindowLongPtr(hwnd, GWL_EXSTYLE, newExStyle);
-                SetWindowLongPtr(hwnd, GWL_STYLE, newStyle);
-            }
-
-            if (stylesChanged || isNew) {
-                if (isOverlay) {
-                    SetWindowPos(hwnd, HWND_TOPMOST, 0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE | SWP_FRAMECHANGED);
-                    
-                    // Force Foreground
-                    DWORD foreThread = GetWindowThreadProcessId(GetForegroundWindow(), NULL);
-                    DWORD curThread = GetCurrentThreadId();
-                    if (foreThread != curThread) {
-                        AttachThreadInput(foreThread, curThread, TRUE);
-                        BringWindowToTop(hwnd);
-                        SetForegroundWindow(hwnd);
-                        AttachThreadInput(foreThread, curThread, FALSE);
-                    } else {
-                        SetForegroundWindow(hwnd);
-                    }
-                } else if (stylesChanged) {
-                    SetWindowPos(hwnd, NULL, 0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE | SWP_FRAMECHANGED | SWP_NOZORDER);
-                }
-            }
+    for (const MetricsSnapshot::Count& c : snap.counts) {
+        if (c.cumulative && snap.seconds > 0) {
+            ImGui::Text("%-22s %12llu  (%.1f/s)", c.name, (unsigned long long)c.value, c.value / snap.seconds);
+        } else {
+            ImGui::Text("%-22s %12llu", c.name, (unsigned long long)c.value);
         }
     }
 
-    static void RestoreAll() {
-        std::vector<std::pair<HWND, WindowState>> toRestore;
-        {
-            std::lock_guard<std::mutex> lock(mutex);
-            for (const auto& pair : windows) {
-                toRestore.push_back(pair);
-            }
-        }
-
-        Log("Restoring %zu windows...", toRestore.size());
-        
-        for (const auto& item : toRestore) {
-            HWND hwnd = item.first;
-            const WindowState& state = item.second;
-
-            if (!IsWindow(hwnd)) continue;
-
-            // Restore Styles
-            if (state.stylesModified) {
-                SetWindowLongPtr(hwnd, GWL_EXSTYLE, state.originalExStyle);
-                SetWindowLongPtr(hwnd, GWL_STYLE, state.originalStyle);
-                SetWindowPos(hwnd, NULL, 0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE | SWP_NOZORDER | SWP_FRAMECHANGED);
-            }
-
-            // Restore WndProc
-            if (GetWindowLongPtr(hwnd, GWLP_WNDPROC) == (LONG_PTR)HookProc) {
-                SetWindowLongPtr(hwnd, GWLP_WNDPROC, (LONG_PTR)state.originalProc);
-            }
-        }
-
-        {
-            std::lock_guard<std::mutex> lock(mutex);
-            windows.clear();
-        }
+    if (ImGui::Button("Reset")) {
+        g_Metrics.Reset();
+        status[0] = '\0';
     }
-
-    static void CleanupDeadWindows() {
-        std::lock_guard<std::mutex> lock(mutex);
-        for (auto it = windows.begin(); it != windows.end();) {
-            if (!IsWindow(it->first)) it = windows.erase(it);
-            else ++it;
-        }
+    ImGui::SameLine();
+    if (ImGui::Button("Export CSV")) {
+        bool ok = Metrics::ExportCsv(snap, GetAddonDir() + L"LS_ReShade_metrics.csv");
+        sprintf_s(status, "%s", ok ? "Wrote LS_ReShade_metrics.csv" : "Export failed");
     }
-};
-
-std::map<HWND, WindowManager::WindowState> WindowManager::windows;
-std::mutex WindowManager::mutex;
-
-// --- Helper Functions for Window Detection ---
-HWND GetLSWindow() {
-    HWND hFound = nullptr;
-    EnumWindows([](HWND hwnd, LPARAM lParam) -> BOOL {
-        DWORD pid;
-        GetWindowThreadProcessId(hwnd, &pid);
-        if (pid == GetCurrentProcessId() && IsWindowVisible(hwnd)) {
-            *(HWND*)lParam = hwnd;
-            return FALSE; 
-        }
-        return TRUE;
-    }, (LPARAM)&hFound);
-    return hFound;
-}
-
-HWND GetTargetWindow(HWND hLS) {
-    if (!hLS) return nullptr;
-    HWND hCurr = GetWindow(hLS, GW_HWNDNEXT);
-    while (hCurr) {
-        if (IsWindowVisible(hCurr)) {
-            DWORD pid;
-            GetWindowThreadProcessId(hCurr, &pid);
-            if (pid != GetCurrentProcessId()) {
-                char className[256];
-                GetClassNameA(hCurr, className, sizeof(className));
-                if (strcmp(className, "Progman") != 0 && strcmp(className, "Shell_TrayWnd") != 0 && strcmp(className, "WorkerW") != 0) {
-                     return hCurr;
-                }
-            }
-        }
-        hCurr = GetWindow(hCurr, GW_HWNDNEXT);
+    ImGui::SameLine();
+    if (ImGui::Button("Export JSON")) {
+        bool ok = Metrics::ExportJson(snap, GetAddonDir() + L"LS_ReShade_metrics.json");
+        sprintf_s(status, "%s", ok ? "Wrote LS_ReShade_metrics.json" : "Export failed");
     }
-    return nullptr;
-}
-
-// --- Main Logic ---
-
-void WorkerThread() {
-    Log("Worker thread started");
-    bool lastHotkeyState = false;
-    int cleanupCounter = 0;
-
-    while (g_Settings.threadRunning) {
-        // 0. Auto-disable on focus loss
-        if (g_Settings.inputPassthrough) {
-            HWND hForeground = GetForegroundWindow();
-            DWORD forePid = 0;
-            GetWindowThreadProcessId(hForeground, &forePid);
-
-            bool validFocus = false;
-            if (forePid == GetCurrentProcessId()) {
-                validFocus = true;
-            } else {
-                HWND hLS = GetLSWindow();
-                if (hLS) {
-                    HWND hTarget = GetTargetWindow(hLS);
-                    if (hForeground == hTarget) {
-                        validFocus = true;
-                    }
-                }
-            }
-
-            if (!validFocus) {
-                g_Settings.inputPassthrough = false;
-                Log("Passthrough disabled: Focus lost");
-                WindowManager::RestoreAll();
-            }
-        }
-
-        // 1. Check Hotkey
-        bool hotkeyPressed = false;
-        if (g_Settings.hotkeyVk != 0) {
-            bool k = (GetAsyncKeyState(g_Settings.hotkeyVk) & 0x8000) != 0;
-            bool c = (GetAsyncKeyState(VK_CONTROL) & 0x8000) != 0;
-            bool a = (GetAsyncKeyState(VK_MENU) & 0x8000) != 0;
-            bool s = (GetAsyncKeyState(VK_SHIFT) & 0x8000) != 0;
-            
-            if (k && 
-                c == g_Settings.hotkeyCtrl.load() && 
-                a == g_Settings.hotkeyAlt.load() && 
-                s == g_Settings.hotkeyShift.load()) {
-                hotkeyPressed = true;
-            }
-        }
-
-        // 2. Handle Toggle
-        if (hotkeyPressed && !lastHotkeyState && !g_Settings.isSimulating) {
-            HWND hForeground = GetForegroundWindow();
-            DWORD forePid = 0;
-            GetWindowThreadProcessId(hForeground, &forePid);
-
-            bool allowToggle = false;
-            if (forePid == GetCurrentProcessId()) {
-                allowToggle = true;
-            } else {
-                HWND hLS = GetLSWindow();
-                if (hLS) {
-                    HWND hTarget = GetTargetWindow(hLS);
-                    if (hForeground == hTarget) {
-                        allowToggle = true;
-                    }
-                }
-            }
-
-            if (allowToggle) {
-                bool newState = !g_Settings.inputPassthrough;
-                g_Settings.inputPassthrough = newState;
-                Log("Passthrough toggled: %s", newState ? "ON" : "OFF");
-
-                if (!newState) {
-                    WindowManager::RestoreAll();
-                }
-
-                // Auto Click & Repress Logic
-                if (g_Settings.autoClickRepress) {
-                    std::thread([newState]() {
-                        g_Settings.isSimulating = true;
-                        int vk = g_Settings.hotkeyVk;
-                        bool c = g_Settings.hotkeyCtrl;
-                        bool a = g_Settings.hotkeyAlt;
-                        bool s = g_Settings.hotkeyShift;
-
-                        if (newState) { // ON
-                            std::this_thread::sleep_for(std::chrono::milliseconds(250));
-                            InputSim::Click();
-                            std::this_thread::sleep_for(std::chrono::milliseconds(200));
-                            InputSim::PressCombo(vk, c, a, s);
-                        } else { // OFF
-                            std::this_thread::sleep_for(std::chrono::milliseconds(450));
-                            InputSim::Click();
-                        }
-                        
-                        std::this_thread::sleep_for(std::chrono::milliseconds(200));
-                        g_Settings.isSimulating = false;
-                    }).detach();
-                }
-            }
-        }
-        lastHotkeyState = hotkeyPressed;
-
-        // 3. Active Loop
-        if (g_Settings.inputPassthrough) {
-            // Enumerate and process windows
-            EnumWindows([](HWND hwnd, LPARAM) -> BOOL {
-                DWORD pid;
-                GetWindowThreadProcessId(hwnd, &pid);
-                if (pid == GetCurrentProcessId() && IsWindowVisible(hwnd)) {
-                    WindowManager::ProcessWindow(hwnd);
-                    EnumChildWindows(hwnd, [](HWND c, LPARAM) -> BOOL {
-                        WindowManager::ProcessWindow(c);
-                        return TRUE;
-                    }, 0);
-                }
-                return TRUE;
-            }, 0);
-
-            // Cleanup occasionally
-            if (++cleanupCounter >= 100) {
-                WindowManager::CleanupDeadWindows();
-                cleanupCounter = 0;
-            }
-
-            // Force cursor
-            ClipCursor(NULL);
-            
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        } else {
-            std::this_thread::sleep_for(std::chrono::milliseconds(50));
-        }
+    ImGui::SameLine();
+    if (!g_Trace.Active()) {
+        if (ImGui::Button("Start Trace")) {
+            bool ok = g_Trace.Start(GetAddonDir() + L"LS_ReShade.trace");
+            sprintf_s(status, "%s", ok ? "Tracing to LS_ReShade.trace" : "Trace failed to start");
+        }
+    } else if (ImGui::Button("Stop Trace")) {
+        uint64_t written = g_Trace.Written();
+        g_Trace.Stop();
+        sprintf_s(status, "Wrote LS_ReShade.trace (%llu events)", (unsigned long long)written);
     }
-    Log("Worker thread stopped");
-}
-
-// --- Config Helper ---
-
-extern "C" __declspec(dllexport) void AddonInitialize(IHost* host, ImGuiContext* ctx, void* alloc_func, void* free_func, void* user_data);
-
-void LoadSettings(const std::wstring& path) {
-    g_Settings.hotkeyVk = GetPrivateProfileIntW(L"Settings", L"HotkeyVk", VK_HOME, path.c_str());
-    g_Settings.hotkeyCtrl = GetPrivateProfileIntW(L"Settings", L"HotkeyCtrl", 0, path.c_str());
-    g_Settings.hotkeyAlt = GetPrivateProfileIntW(L"Settings", L"HotkeyAlt", 0, path.c_str());
-    g_Settings.hotkeyShift = GetPrivateProfileIntW(L"Settings", L"HotkeyShift", 0, path.c_str());
-    g_Settings.autoClickRepress = GetPrivateProfileIntW(L"Settings", L"AutoClickRepress", 1, path.c_str());
-}
-
-void SaveSettings() {
-    HMODULE hModule = NULL;
-    GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, (LPCWSTR)&AddonInitialize, &hModule);
-    wchar_t path[MAX_PATH];
-    GetModuleFileNameW(hModule, path, MAX_PATH);
-    wchar_t* lastSlash = wcsrchr(path, L'\\');
-    if (lastSlash) *(lastSlash + 1) = L'\0';
-    std::wstring configPath = std::wstring(path) + L"config.ini";
-
-    WritePrivateProfileStringW(L"Settings", L"HotkeyVk", std::to_wstring(g_Settings.hotkeyVk.load()).c_str(), configPath.c_str());
-    WritePrivateProfileStringW(L"Settings", L"HotkeyCtrl", std::to_wstring(g_Settings.hotkeyCtrl.load()).c_str(), configPath.c_str());
-    WritePrivateProfileStringW(L"Settings", L"HotkeyAlt", std::to_wstring(g_Settings.hotkeyAlt.load()).c_str(), configPath.c_str());
-    WritePrivateProfileStringW(L"Settings", L"HotkeyShift", std::to_wstring(g_Settings.hotkeyShift.load()).c_str(), configPath.c_str());
-    WritePrivateProfileStringW(L"Settings", L"AutoClickRepress", std::to_wstring(g_Settings.autoClickRepress.load()).c_str(), configPath.c_str());
+    if (status[0]) ImGui::TextUnformatted(status);
 }
 
 // --- Exports ---
 
 extern "C" __declspec(dllexport) void AddonInitialize(IHost* host, ImGuiContext* ctx, void* alloc_func, void* free_func, void* user_data) {
     // Init Logger
-    HMODULE hModule = NULL;
-    GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, (LPCWSTR)&AddonInitialize, &hModule);
-    wchar_t path[MAX_PATH];
-    GetModuleFileNameW(hModule, path, MAX_PATH);
-    wchar_t* lastSlash = wcsrchr(path, L'\\');
-    if (lastSlash) *(lastSlash + 1) = L'\0';
-    Logger::Init(std::wstring(path) + L"LS_ReShade.log");
-    
-    LoadSettings(std::wstring(path) + L"config.ini");
+    Logger::Init(GetAddonDir() + L"LS_ReShade.log");
 
-    Log("Addon Initialized");
+    g_SettingsStore.Start(GetAddonDir() + L"config.ini");
+
+    LOG_INFO("Addon Initialized");
     g_ImGuiContext = ctx;
+    g_WindowSystem = &g_Win32WindowSystem;
+    WindowManager::OpenJournal(GetAddonDir() + L"restore.journal");
+    if (!g_Control.Open(GetAddonDir() + L"control.mailbox")) LOG_WARN("Control channel unavailable");
 
-    // Start Thread
-    static bool threadStarted = false;
-    if (!threadStarted) {
-        std::thread(WorkerThread).detach();
-        threadStarted = true;
-    }
+    // Start Thread (again, if the addon was shut down and reloaded)
+    g_Worker.Start();
 }
 
 extern "C" __declspec(dllexport) void AddonShutdown() {
-    g_Settings.threadRunning = false;
-    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    // Joined on return: nothing below races the worker, and the logger is
+    // closed only after its last record.
+    g_Worker.Stop();
+    g_Control.Close();
+    g_Settings.SetPassthrough(false);
     WindowManager::RestoreAll();
+    g_Journal.Close();
+    g_Trace.Stop();
+    g_SettingsStore.Stop();
     Logger::Close();
 }
 
@@ -473,18 +142,20 @@ extern "C" __declspec(dllexport) const char* GetAddonVersion() {
 }
 
 // --- UI Helper ---
-const char* GetKeyName(int vk) {
-    static char buffer[32];
-    if (vk == 0) return "None";
-    if (vk >= VK_F1 && vk <= VK_F12) { sprintf_s(buffer, "F%d", vk - VK_F1 + 1); return buffer; }
-    switch (vk) {
-        case VK_INSERT: return "Insert"; case VK_DELETE: return "Delete";
-        case VK_HOME: return "Home"; case VK_END: return "End";
-        case VK_PRIOR: return "Page Up"; case VK_NEXT: return "Page Down";
+
+// The current hotkey as "Ctrl+Home", formatted only when the binding changes.
+const char* HotkeyLabel(const SettingsValues& values) {
+    static char label[64] = "";
+    static SettingsValues shown;
+    static bool valid = false;
+    if (!valid || values != shown) {
+        uint8_t mods = (values.hotkeyCtrl ? HotkeyChord::ModCtrl : 0) | (values.hotkeyAlt ? HotkeyChord::ModAlt : 0) |
+                       (values.hotkeyShift ? HotkeyChord::ModShift : 0);
+        KeyCatalog::FormatChord(label, sizeof(label), values.hotkeyVk, mods);
+        shown = values;
+        valid = true;
     }
-    if (vk >= 'A' && vk <= 'Z') { sprintf_s(buffer, "%c", vk); return buffer; }
-    sprintf_s(buffer, "Key %d", vk);
-    return buffer;
+    return label;
 }
 
 extern "C" __declspec(dllexport) void AddonRenderSettings() {
@@ -494,42 +165,77 @@ extern "C" __declspec(dllexport) void AddonRenderSettings() {
     ImGui::TextWrapped("Input Blocker allows interaction with the overlay.");
     ImGui::Separator();
 
-    // bool enabled = g_Settings.inputPassthrough;
+    // bool enabled = g_Settings.Read().inputPassthrough;
     // if (ImGui::Checkbox("Enable Input Passthrough", &enabled)) {
-    //     g_Settings.inputPassthrough = enabled;
+    //     g_Settings.SetPassthrough(enabled);
     //     if (!enabled) WindowManager::RestoreAll();
     // }
 
-    bool autoClick = g_Settings.autoClickRepress;
-    if (ImGui::Checkbox("Enable Auto Click & Repress", &autoClick)) {
-        g_Settings.autoClickRepress = autoClick;
-        SaveSettings();
-    }
+    // Edit a copy of one snapshot and publish it whole, so the worker never
+    // sees a half-changed hotkey.
+    SettingsValues values = g_Settings.Read().values;
+    bool changed = false;
+    if (ImGui::Checkbox("Enable Auto Click & Repress", &values.autoClickRepress)) changed = true;
 
     ImGui::Separator();
-    ImGui::Text("Hotkey:");
-    
-    bool c = g_Settings.hotkeyCtrl;
-    bool a = g_Settings.hotkeyAlt;
-    bool s = g_Settings.hotkeyShift;
-    bool changed = false;
-    if (ImGui::Checkbox("Ctrl", &c)) { g_Settings.hotkeyCtrl = c; changed = true; }
+    ImGui::Text("Hotkey: %s", HotkeyLabel(values));
+
+    // Press-to-bind: the worker's key hook takes the next key press.
+    static bool capturing = false;
+    if (!capturing) {
+        if (ImGui::Button("Press to Bind")) {
+            g_Hotkeys.BeginCapture();
+            capturing = true;
+        }
+    } else {
+        HotkeyChord chord;
+        HotkeyEngine::CaptureState state = g_Hotkeys.PollCapture(chord);
+        if (state == HotkeyEngine::CaptureDone) {
+            values.hotkeyVk = chord.vk;
+            values.hotkeyCtrl = (chord.mods & HotkeyChord::ModCtrl) != 0;
+            values.hotkeyAlt = (chord.mods & HotkeyChord::ModAlt) != 0;
+            values.hotkeyShift = (chord.mods & HotkeyChord::ModShift) != 0;
+            changed = true;
+        }
+        if (state != HotkeyEngine::CaptureWaiting) {
+            capturing = false;
+        } else {
+            ImGui::TextUnformatted("Press a key or combination (Esc cancels)...");
+            ImGui::SameLine();
+            if (ImGui::Button("Cancel")) {
+                g_Hotkeys.CancelCapture();
+                capturing = false;
+            }
+        }
+    }
+
+    if (ImGui::Checkbox("Ctrl", &values.hotkeyCtrl)) changed = true;
     ImGui::SameLine();
-    if (ImGui::Checkbox("Alt", &a)) { g_Settings.hotkeyAlt = a; changed = true; }
+    if (ImGui::Checkbox("Alt", &values.hotkeyAlt)) changed = true;
     ImGui::SameLine();
-    if (ImGui::Checkbox("Shift", &s)) { g_Settings.hotkeyShift = s; changed = true; }
+    if (ImGui::Checkbox("Shift", &values.hotkeyShift)) changed = true;
 
-    int currentKey = g_Settings.hotkeyVk;
-    if (ImGui::BeginCombo("Key", GetKeyName(currentKey))) {
-        const int keys[] = { 0, VK_F1, VK_F2, VK_F3, VK_F4, VK_F5, VK_F6, VK_F7, VK_F8, VK_F9, VK_F10, VK_F11, VK_F12, VK_INSERT, VK_DELETE, VK_HOME, VK_END, VK_PRIOR, VK_NEXT, 'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z' };
-        for (int vk : keys) {
-            if (ImGui::Selectable(GetKeyName(vk), currentKey == vk)) {
-                g_Settings.hotkeyVk = vk;
+    if (ImGui::BeginCombo("Key", KeyCatalog::Name(values.hotkeyVk))) {
+        if (ImGui::Selectable(KeyCatalog::Name(0), values.hotkeyVk == 0)) {
+            values.hotkeyVk = 0;
+            changed = true;
+        }
+        for (uint8_t vk : KeyCatalog::kBindable) {
+            if (ImGui::Selectable(KeyCatalog::Name(vk), values.hotkeyVk == vk)) {
+                values.hotkeyVk = vk;
                 changed = true;
             }
         }
         ImGui::EndCombo();
     }
 
-    if (changed) SaveSettings();
+    if (changed) {
+        g_Settings.SetValues(values);
+        g_SettingsStore.MarkDirty();
+    }
+
+    ImGui::Separator();
+    if (ImGui::CollapsingHeader("Performance")) {
+        RenderMetrics();
+    }
 }
@@ -0,0 +1,80 @@
+#include "mapped_file.hpp"
+#include <filesystem>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool MappedFile::Open(const std::wstring& path, bool shared) {
+    Close();
+#ifdef _WIN32
+    DWORD share = shared ? FILE_SHARE_READ | FILE_SHARE_WRITE : FILE_SHARE_READ;
+    m_file = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, share, NULL, OPEN_ALWAYS,
+                         FILE_ATTRIBUTE_NORMAL, NULL);
+    if (m_file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size = {};
+    if (GetFileSizeEx(m_file, &size)) m_openedSize = (size_t)size.QuadPart;
+#else
+    (void)shared; // nothing locks a file against other processes here
+    m_file = open(std::filesystem::path(path).c_str(), O_RDWR | O_CREAT, 0644);
+    if (m_file < 0) return false;
+    struct stat st = {};
+    if (fstat(m_file, &st) == 0) m_openedSize = (size_t)st.st_size;
+#endif
+    return true;
+}
+
+bool MappedFile::Map(size_t bytes) {
+    if (!IsOpen() || bytes == 0) return false;
+#ifdef _WIN32
+    // Mapping past the end of the file extends it with zeros.
+    HANDLE mapping = CreateFileMappingW(m_file, NULL, PAGE_READWRITE, (DWORD)((uint64_t)bytes >> 32), (DWORD)bytes, NULL);
+    if (!mapping) return false;
+    uint8_t* data = (uint8_t*)MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, bytes);
+    if (!data) {
+        CloseHandle(mapping);
+        return false;
+    }
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mapping) CloseHandle(m_mapping);
+    m_mapping = mapping;
+#else
+    struct stat st = {};
+    if (fstat(m_file, &st) != 0) return false;
+    if ((size_t)st.st_size < bytes && ftruncate(m_file, (off_t)bytes) != 0) return false;
+    void* mapped = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, m_file, 0);
+    if (mapped == MAP_FAILED) return false;
+    uint8_t* data = (uint8_t*)mapped;
+    if (m_data) munmap(m_data, m_size);
+#endif
+    m_data = data;
+    m_size = bytes;
+    return true;
+}
+
+void MappedFile::Close() {
+#ifdef _WIN32
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mapping) CloseHandle(m_mapping);
+    if (m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+    m_mapping = NULL;
+    m_file = INVALID_HANDLE_VALUE;
+#else
+    if (m_data) munmap(m_data, m_size);
+    if (m_file >= 0) close(m_file);
+    m_file = -1;
+#endif
+    m_data = nullptr;
+    m_size = 0;
+    m_openedSize = 0;
+}
+
+bool MappedFile::IsOpen() const {
+#ifdef _WIN32
+    return m_file != INVALID_HANDLE_VALUE;
+#else
+    return m_file >= 0;
+#endif
+}
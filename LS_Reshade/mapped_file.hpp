@@ -0,0 +1,43 @@
+#pragma once
+#include "platform.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// A file mapped read/write into memory (CreateFileMapping on Windows, mmap
+// elsewhere). Stores into the view belong to the file as soon as they are
+// made, so they survive the process dying right after; they are not flushed
+// to disk, so a power loss can still lose them.
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { Close(); }
+
+    // Opens or creates `path`; nothing is mapped yet. With `shared`, other
+    // processes may open and map it for writing at the same time.
+    bool Open(const std::wstring& path, bool shared = false);
+    // Maps the first `bytes`, extending the file with zeros if it is shorter.
+    // The new view is mapped before the old one goes, so a failure leaves the
+    // current view in place.
+    bool Map(size_t bytes);
+    void Close();
+
+    bool IsOpen() const;
+    // The file's size when it was opened.
+    size_t OpenedSize() const { return m_openedSize; }
+    uint8_t* Data() const { return m_data; }
+    size_t Size() const { return m_size; }
+
+private:
+    uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    size_t m_openedSize = 0;
+#ifdef _WIN32
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = NULL;
+#else
+    int m_file = -1;
+#endif
+};
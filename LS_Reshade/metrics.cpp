@@ -0,0 +1,175 @@
+#include "metrics.hpp"
+#include "window_manager.hpp"
+#include "logger.hpp"
+#include "cursor_manager.hpp"
+#include "window_mutations.hpp"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+Metrics g_Metrics;
+
+namespace {
+    int HighestBit(uint64_t v) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, v);
+        return (int)index;
+#else
+        return 63 - __builtin_clzll(v);
+#endif
+    }
+
+    void Add(std::atomic<uint64_t>& counter, uint64_t v) { counter.fetch_add(v, std::memory_order_relaxed); }
+    uint64_t Load(const std::atomic<uint64_t>& counter) { return counter.load(std::memory_order_relaxed); }
+}
+
+// --- Histogram ---
+
+size_t Histogram::BucketOf(uint64_t value) {
+    const uint64_t subCount = 1ull << kSubBits;
+    if (value < subCount) return (size_t)value;
+    int msb = HighestBit(value);
+    if (msb >= kMaxBits) return kBuckets - 1;
+    uint64_t top = value >> (msb - kSubBits); // in [16, 32)
+    return (size_t)(msb - kSubBits + 1) * subCount + (size_t)(top - subCount);
+}
+
+uint64_t Histogram::BucketHigh(size_t bucket) {
+    const uint64_t subCount = 1ull << kSubBits;
+    if (bucket < subCount) return bucket;
+    int shift = (int)(bucket / subCount) - 1;
+    uint64_t top = subCount + bucket % subCount;
+    return ((top + 1) << shift) - 1;
+}
+
+void Histogram::Record(uint64_t value) {
+    Add(m_buckets[BucketOf(value)], 1);
+    Add(m_count, 1);
+    Add(m_sum, value);
+    uint64_t max = Load(m_max);
+    while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {}
+}
+
+Histogram::Summary Histogram::Summarize() const {
+    Summary s = {};
+    // Bucket counts are read one by one while writers run; use their total
+    // rather than m_count so the percentiles are self-consistent.
+    uint64_t counts[kBuckets];
+    uint64_t total = 0;
+    for (size_t b = 0; b < kBuckets; ++b) {
+        counts[b] = Load(m_buckets[b]);
+        total += counts[b];
+    }
+    s.count = total;
+    s.max = Load(m_max);
+    if (total == 0) return s;
+    s.mean = (double)Load(m_sum) / Load(m_count);
+
+    const uint64_t ranks[3] = { (total * 50 + 99) / 100, (total * 90 + 99) / 100, (total * 99 + 99) / 100 };
+    uint64_t* outs[3] = { &s.p50, &s.p90, &s.p99 };
+    uint64_t seen = 0;
+    size_t next = 0;
+    for (size_t b = 0; b < kBuckets && next < 3; ++b) {
+        seen += counts[b];
+        while (next < 3 && seen >= ranks[next]) {
+            uint64_t high = BucketHigh(b);
+            *outs[next++] = high < s.max ? high : s.max;
+        }
+    }
+    return s;
+}
+
+void Histogram::Reset() {
+    for (auto& b : m_buckets) b.store(0, std::memory_order_relaxed);
+    m_count = 0;
+    m_sum = 0;
+    m_max = 0;
+}
+
+// --- Metrics ---
+
+uint64_t Metrics::NowNs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Metrics::Reset() {
+    workerTickNs.Reset();
+    windowsPerTick.Reset();
+    hookNs.Reset();
+    toggleLatencyMs.Reset();
+    mutationNs.Reset();
+    hookMessages = 0;
+    setLongCalls = 0;
+    setPosCalls = 0;
+    WindowManager::ResetLockStats();
+    g_Cursor.ResetStats();
+    resetAtNs = NowNs();
+}
+
+void Metrics::Collect(MetricsSnapshot& out) const {
+    uint64_t since = Load(resetAtNs);
+    out.seconds = since ? (NowNs() - since) / 1e9 : 0.0;
+    out.dists[0] = { "worker_tick", "ns", workerTickNs.Summarize() };
+    out.dists[1] = { "windows_per_tick", "windows", windowsPerTick.Summarize() };
+    out.dists[2] = { "hookproc", "ns", hookNs.Summarize() };
+    out.dists[3] = { "toggle_latency", "ms", toggleLatencyMs.Summarize() };
+    out.dists[4] = { "window_mutations", "ns", mutationNs.Summarize() };
+
+    ProfiledMutex::Stats lock = WindowManager::GetLockStats();
+    out.counts[0] = { "hookproc_messages", Load(hookMessages), true };
+    out.counts[1] = { "set_window_long_calls", Load(setLongCalls), true };
+    out.counts[2] = { "set_window_pos_calls", Load(setPosCalls), true };
+    out.counts[3] = { "lock_acquisitions", lock.acquisitions, true };
+    out.counts[4] = { "lock_wait_ns", lock.waitNs, true };
+    out.counts[5] = { "lock_hold_ns", lock.holdNs, true };
+    out.counts[6] = { "lock_max_hold_ns", lock.maxHoldNs, false };
+    out.counts[7] = { "log_records_dropped", Logger::Dropped(), true };
+
+    CursorManager::Stats cursor = g_Cursor.GetStats();
+    out.counts[8] = { "cursor_calls", cursor.calls, true };
+    out.counts[9] = { "cursor_calls_avoided", cursor.avoided, true };
+    out.counts[10] = { "mutation_batches_posted", g_Mutations.GetStats().postedBatches, true };
+}
+
+bool Metrics::ExportCsv(const MetricsSnapshot& snapshot, const std::wstring& path) {
+    std::ofstream file(std::filesystem::path(path), std::ios::out | std::ios::trunc);
+    if (!file.is_open()) return false;
+    file << "metric,unit,count,mean,p50,p90,p99,max,per_sec\n";
+    for (const MetricsSnapshot::Dist& d : snapshot.dists) {
+        const Histogram::Summary& s = d.summary;
+        file << d.name << ',' << d.unit << ',' << s.count << ',' << s.mean << ',' << s.p50 << ',' << s.p90 << ','
+             << s.p99 << ',' << s.max << ",\n";
+    }
+    for (const MetricsSnapshot::Count& c : snapshot.counts) {
+        file << c.name << ",," << c.value << ",,,,,,";
+        if (c.cumulative && snapshot.seconds > 0) file << c.value / snapshot.seconds;
+        file << '\n';
+    }
+    return file.good();
+}
+
+bool Metrics::ExportJson(const MetricsSnapshot& snapshot, const std::wstring& path) {
+    std::ofstream file(std::filesystem::path(path), std::ios::out | std::ios::trunc);
+    if (!file.is_open()) return false;
+    file << "{\n  \"seconds\": " << snapshot.seconds << ",\n  \"histograms\": {\n";
+    for (size_t i = 0; i < MetricsSnapshot::kDists; ++i) {
+        const MetricsSnapshot::Dist& d = snapshot.dists[i];
+        const Histogram::Summary& s = d.summary;
+        file << "    \"" << d.name << "\": { \"unit\": \"" << d.unit << "\", \"count\": " << s.count
+             << ", \"mean\": " << s.mean << ", \"p50\": " << s.p50 << ", \"p90\": " << s.p90
+             << ", \"p99\": " << s.p99 << ", \"max\": " << s.max << " }"
+             << (i + 1 < MetricsSnapshot::kDists ? ",\n" : "\n");
+    }
+    file << "  },\n  \"counters\": {\n";
+    for (size_t i = 0; i < MetricsSnapshot::kCounts; ++i) {
+        const MetricsSnapshot::Count& c = snapshot.counts[i];
+        file << "    \"" << c.name << "\": " << c.value << (i + 1 < MetricsSnapshot::kCounts ? ",\n" : "\n");
+    }
+    file << "  }\n}\n";
+    return file.good();
+}
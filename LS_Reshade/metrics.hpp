@@ -0,0 +1,85 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Log-linear histogram in the style of HdrHistogram: values below 16 are
+// exact, and every power of two above that is split into 16 buckets, so any
+// recorded value is reported within 6.25%. Record() is a few relaxed atomic
+// adds and is safe from any thread; values past 2^40 land in the top bucket.
+class Histogram {
+public:
+    static const int kSubBits = 4;
+    static const int kMaxBits = 40;
+    static const size_t kBuckets = (size_t)(kMaxBits - kSubBits + 1) << kSubBits;
+
+    struct Summary {
+        uint64_t count;
+        uint64_t p50;
+        uint64_t p90;
+        uint64_t p99;
+        uint64_t max;
+        double mean;
+    };
+
+    void Record(uint64_t value);
+    Summary Summarize() const;
+    void Reset();
+
+private:
+    static size_t BucketOf(uint64_t value);
+    // Largest value that maps to `bucket`.
+    static uint64_t BucketHigh(size_t bucket);
+
+    std::atomic<uint64_t> m_buckets[kBuckets] = {};
+    std::atomic<uint64_t> m_count{ 0 };
+    std::atomic<uint64_t> m_sum{ 0 };
+    std::atomic<uint64_t> m_max{ 0 };
+};
+
+// A point-in-time copy of every metric, for the settings panel and export.
+struct MetricsSnapshot {
+    struct Dist {
+        const char* name;
+        const char* unit;
+        Histogram::Summary summary;
+    };
+    struct Count {
+        const char* name;
+        uint64_t value;
+        bool cumulative; // a running total, so a per-second rate makes sense
+    };
+    static const size_t kDists = 5;
+    static const size_t kCounts = 11;
+
+    double seconds; // since the last reset
+    Dist dists[kDists];
+    Count counts[kCounts];
+};
+
+// Addon-wide runtime metrics. Written by the worker and by HookProc on the
+// window threads; read by the settings panel.
+struct Metrics {
+    Histogram workerTickNs;
+    Histogram windowsPerTick;
+    Histogram hookNs; // HookProc's own time on the messages it handles, excluding the original WndProc
+    Histogram toggleLatencyMs;
+    Histogram mutationNs; // flushing thread's time per batch of window changes
+    std::atomic<uint64_t> hookMessages{ 0 }; // forwarded messages are added per thread, 64 at a time
+    std::atomic<uint64_t> setLongCalls{ 0 };
+    std::atomic<uint64_t> setPosCalls{ 0 };
+    std::atomic<uint64_t> resetAtNs{ 0 };
+
+    Metrics() { resetAtNs = NowNs(); }
+    static uint64_t NowNs();
+
+    void Reset();
+    // Includes WindowManager's lock stats, the logger's drop count, the
+    // cursor manager's call counts and the posted mutation batches.
+    void Collect(MetricsSnapshot& out) const;
+    static bool ExportCsv(const MetricsSnapshot& snapshot, const std::wstring& path);
+    static bool ExportJson(const MetricsSnapshot& snapshot, const std::wstring& path);
+};
+
+extern Metrics g_Metrics;
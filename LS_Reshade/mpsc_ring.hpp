@@ -0,0 +1,104 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Bounded multi-producer / single-consumer ring (Vyukov-style per-cell
+// sequence numbers). Producers claim a cell with one CAS and fill it in
+// place; nothing blocks, and a full ring makes TryPush fail instead of
+// waiting. Only one thread may call TryPop.
+template<typename T, size_t N>
+class MpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "MpscRing size must be a power of two");
+
+public:
+    MpscRing() {
+        for (size_t i = 0; i < N; ++i) m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    // fill(T&) runs on the claimed cell before it is published.
+    template<typename Fill>
+    bool TryPush(Fill&& fill) {
+        size_t pos = m_head.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = m_cells[pos & (N - 1)];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+            if (diff == 0) {
+                if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    fill(cell.value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // full
+            } else {
+                pos = m_head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // consume(T&) runs on the oldest published cell. Consumer thread only.
+    template<typename Consume>
+    bool TryPop(Consume&& consume) {
+        Cell& cell = m_cells[m_tail & (N - 1)];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if ((intptr_t)sequence - (intptr_t)(m_tail + 1) < 0) return false; // empty
+        consume(cell.value);
+        cell.sequence.store(m_tail + N, std::memory_order_release);
+        ++m_tail;
+        m_tailShadow.store(m_tail, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Consumer thread only, for rings shared with processes that may die
+    // between claiming a cell and publishing it, which TryPop cannot tell
+    // from an empty ring. True while the oldest cell is claimed but not
+    // published, or was published over after Skip gave up on it; `position`
+    // names it, so the caller can tell how long the same stall lasts.
+    bool Stalled(size_t& position) const {
+        const Cell& cell = m_cells[m_tail & (N - 1)];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        bool empty = m_head.load(std::memory_order_acquire) == m_tail;
+        if (sequence == (empty ? m_tail : m_tail + 1)) return false;
+        position = m_tail;
+        return true;
+    }
+
+    // Consumer thread only: gives up on the stalled oldest cell (its
+    // producer is taken for dead) and moves past it. A cell published
+    // over after that is handed back to the producers.
+    void Skip() {
+        Cell& cell = m_cells[m_tail & (N - 1)];
+        if (m_head.load(std::memory_order_acquire) == m_tail) {
+            cell.sequence.store(m_tail, std::memory_order_release);
+            return;
+        }
+        cell.sequence.store(m_tail + N, std::memory_order_release);
+        ++m_tail;
+        m_tailShadow.store(m_tail, std::memory_order_relaxed);
+    }
+
+    // Approximate; for watermarks only.
+    size_t ApproxSize() const {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        size_t tail = m_tailShadow.load(std::memory_order_relaxed);
+        return head >= tail ? head - tail : 0;
+    }
+
+    static constexpr size_t Capacity() { return N; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    alignas(64) std::atomic<size_t> m_head{ 0 };
+    alignas(64) size_t m_tail = 0;
+    std::atomic<size_t> m_tailShadow{ 0 };
+    alignas(64) Cell m_cells[N];
+};
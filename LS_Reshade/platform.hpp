@@ -0,0 +1,90 @@
+#pragma once
+// Minimal Win32 surface used by the core. On Windows this is just <windows.h>;
+// elsewhere it provides the handful of types and constants the core needs so
+// it can be built and benchmarked against the fake window system.
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cstdint>
+
+struct HWND__;
+typedef HWND__* HWND;
+typedef void* HCURSOR;
+typedef int BOOL;
+typedef unsigned int UINT;
+typedef uint16_t WORD;
+typedef uint32_t DWORD;
+typedef uintptr_t WPARAM;
+typedef intptr_t LPARAM;
+typedef intptr_t LRESULT;
+typedef intptr_t LONG_PTR;
+
+#define CALLBACK
+typedef LRESULT (CALLBACK* WNDPROC)(HWND, UINT, WPARAM, LPARAM);
+
+#ifndef TRUE
+#define TRUE 1
+#define FALSE 0
+#endif
+
+// Messages
+#define WM_NCDESTROY 0x0082
+#define WM_NCHITTEST 0x0084
+#define WM_SETCURSOR 0x0020
+#define WM_MOUSEMOVE 0x0200
+#define WM_INPUT     0x00FF
+#define WM_USER      0x0400
+
+// Hit-test results
+#define HTTRANSPARENT (-1)
+#define HTCLIENT      1
+
+// GetWindowLongPtr indices
+#define GWLP_WNDPROC (-4)
+#define GWL_STYLE    (-16)
+#define GWL_EXSTYLE  (-20)
+
+// Styles
+#define WS_DISABLED       0x08000000L
+#define WS_VISIBLE        0x10000000L
+#define WS_EX_NOACTIVATE  0x08000000L
+#define WS_EX_LAYERED     0x00080000L
+#define WS_EX_TRANSPARENT 0x00000020L
+#define WS_EX_TOPMOST     0x00000008L
+
+// SetWindowPos
+#define HWND_TOPMOST    ((HWND)(intptr_t)-1)
+#define SWP_NOSIZE       0x0001
+#define SWP_NOMOVE       0x0002
+#define SWP_NOZORDER     0x0004
+#define SWP_FRAMECHANGED 0x0020
+
+// SendInput flags
+#define KEYEVENTF_KEYUP      0x0002
+#define MOUSEEVENTF_LEFTDOWN 0x0002
+#define MOUSEEVENTF_LEFTUP   0x0004
+
+// Virtual keys
+#define VK_SHIFT   0x10
+#define VK_CONTROL 0x11
+#define VK_MENU    0x12
+#define VK_LSHIFT   0xA0
+#define VK_RSHIFT   0xA1
+#define VK_LCONTROL 0xA2
+#define VK_RCONTROL 0xA3
+#define VK_LMENU    0xA4
+#define VK_RMENU    0xA5
+#define VK_ESCAPE  0x1B
+#define VK_PRIOR   0x21
+#define VK_NEXT    0x22
+#define VK_END     0x23
+#define VK_HOME    0x24
+#define VK_INSERT  0x2D
+#define VK_DELETE  0x2E
+#define VK_F1      0x70
+#define VK_F12     0x7B
+#endif
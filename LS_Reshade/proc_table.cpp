@@ -0,0 +1,158 @@
+#include "proc_table.hpp"
+#include <thread>
+
+namespace {
+    const size_t kMinCapacity = 16;
+    // Never a real window (HWND_NOTOPMOST).
+    const HWND kTombstone = (HWND)(intptr_t)-2;
+}
+
+ProcTable::ProcTable(size_t capacity) : m_capacity(kMinCapacity) {
+    while (m_capacity < capacity) m_capacity *= 2;
+    for (Table& table : m_tables) {
+        table.mask = m_capacity - 1;
+        table.used = 0;
+        table.live = 0;
+        table.slots = new Slot[m_capacity];
+    }
+    m_spare = &m_tables[1];
+    m_table.store(&m_tables[0]);
+}
+
+ProcTable::~ProcTable() {
+    for (Table& table : m_tables) delete[] table.slots;
+}
+
+void ProcTable::BeginWrite(Slot& slot) {
+    slot.version.store(slot.version.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void ProcTable::EndWrite(Slot& slot) {
+    slot.version.store(slot.version.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+bool ProcTable::Set(HWND hwnd, WNDPROC proc, uint8_t session) {
+    if (!hwnd || hwnd == kTombstone) return false;
+    Table* table = m_table.load(std::memory_order_relaxed);
+
+    Slot* reuse = nullptr;
+    size_t i = Hash(hwnd) & table->mask;
+    for (;; i = (i + 1) & table->mask) {
+        Slot& slot = table->slots[i];
+        HWND key = slot.key.load(std::memory_order_relaxed);
+        if (key == hwnd) {
+            BeginWrite(slot);
+            slot.session.store(session, std::memory_order_relaxed);
+            slot.value.store(proc, std::memory_order_relaxed);
+            EndWrite(slot);
+            m_generation.fetch_add(1, std::memory_order_release);
+            return true;
+        }
+        if (key == nullptr) break;
+        if (key == kTombstone && !reuse) reuse = &slot;
+    }
+
+    if ((table->live + 1) * 2 > m_capacity) return false;
+    if (!reuse) {
+        // Tombstones that were never reused: keep the probe chains short.
+        if ((table->used + 1) * 4 > m_capacity * 3) {
+            Compact(true);
+            return Set(hwnd, proc, session);
+        }
+        reuse = &table->slots[i];
+        ++table->used;
+    }
+
+    // Value first, then key: a reader that sees the key sees the value.
+    if (++m_nextTag == 0) ++m_nextTag;
+    BeginWrite(*reuse);
+    reuse->value.store(proc, std::memory_order_relaxed);
+    reuse->session.store(session, std::memory_order_relaxed);
+    reuse->tag.store(m_nextTag, std::memory_order_relaxed);
+    reuse->key.store(hwnd, std::memory_order_release);
+    EndWrite(*reuse);
+    ++table->live;
+    m_generation.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+bool ProcTable::Erase(HWND hwnd, uint32_t tag) {
+    if (!hwnd || hwnd == kTombstone) return false;
+    Table* table = m_table.load(std::memory_order_relaxed);
+    size_t i = Hash(hwnd) & table->mask;
+    for (size_t probes = 0; probes <= table->mask; ++probes, i = (i + 1) & table->mask) {
+        Slot& slot = table->slots[i];
+        HWND key = slot.key.load(std::memory_order_relaxed);
+        if (key == nullptr) return false;
+        if (key != hwnd) continue;
+        if (tag && slot.tag.load(std::memory_order_relaxed) != tag) return false;
+
+        BeginWrite(slot);
+        slot.key.store(kTombstone, std::memory_order_release);
+        EndWrite(slot);
+        --table->live;
+        // A tombstone just before an empty slot ends no probe chain: empty
+        // it, and the tombstones before it.
+        while (table->slots[(i + 1) & table->mask].key.load(std::memory_order_relaxed) == nullptr &&
+               table->slots[i].key.load(std::memory_order_relaxed) == kTombstone) {
+            BeginWrite(table->slots[i]);
+            table->slots[i].key.store(nullptr, std::memory_order_release);
+            EndWrite(table->slots[i]);
+            --table->used;
+            i = (i - 1) & table->mask;
+        }
+        m_generation.fetch_add(1, std::memory_order_release);
+        return true;
+    }
+    return false;
+}
+
+void ProcTable::Clear() {
+    Compact(false);
+}
+
+void ProcTable::Compact(bool keep) {
+    Table* old = m_table.load(std::memory_order_relaxed);
+    Table* table = m_spare;
+    for (size_t i = 0; i <= table->mask; ++i) {
+        Slot& slot = table->slots[i];
+        BeginWrite(slot);
+        slot.key.store(nullptr, std::memory_order_relaxed);
+        EndWrite(slot);
+    }
+    table->used = 0;
+    table->live = 0;
+
+    for (size_t i = 0; keep && i <= old->mask; ++i) {
+        const Slot& from = old->slots[i];
+        HWND key = from.key.load(std::memory_order_relaxed);
+        if (key == nullptr || key == kTombstone) continue;
+        size_t j = Hash(key) & table->mask;
+        while (table->slots[j].key.load(std::memory_order_relaxed) != nullptr) j = (j + 1) & table->mask;
+        Slot& to = table->slots[j];
+        BeginWrite(to);
+        to.value.store(from.value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        to.session.store(from.session.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        to.tag.store(from.tag.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        to.key.store(key, std::memory_order_relaxed);
+        EndWrite(to);
+        ++table->used;
+        ++table->live;
+    }
+
+    m_table.store(table);
+    m_generation.fetch_add(1, std::memory_order_release);
+
+    // Grace period: flip the epoch and wait for the readers counted under the
+    // previous parity, twice. A reader reads the parity before it announces
+    // itself, so one that read it before a flip may be counted under either
+    // parity; after both waits none can still hold the old array. Lookups are
+    // a handful of loads, so this is short.
+    for (int pass = 0; pass < 2; ++pass) {
+        uint32_t parity = m_epoch.fetch_add(1) & 1;
+        while (m_readers[parity].load() != 0) std::this_thread::yield();
+    }
+
+    m_spare = old;
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include "platform.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// HWND -> original WNDPROC lookup for HookProc, with the session (LS
+// window) each window belongs to.
+//
+// Open-addressing table with linear probing over a fixed pool: two arrays of
+// `capacity` slots allocated up front and never resized, so memory stays the
+// same however many windows come and go. Readers (any thread, typically the
+// UI thread inside HookProc) take no locks: an epoch counter announce and a
+// few atomic loads. All mutation happens on one writer thread (the worker).
+// Every slot carries a version that is odd while the writer changes it, so
+// erased slots can be reused in place: a reader that matched a key re-checks
+// the version and reads again if the slot changed under it. Each entry is
+// also tagged with a generation of its own, so a late request about a window
+// cannot release a newer window that got the same handle. Only when erased
+// slots pile up are the live entries compacted into the spare array, which
+// is published with a pointer swap and handed back once every reader that
+// could have seen the old one has left (two-counter epoch scheme, flipped
+// twice per compaction).
+class ProcTable {
+public:
+    static const size_t kDefaultCapacity = 2048; // up to half of it live
+    static const uint8_t kNoSession = 0xFF;
+
+    explicit ProcTable(size_t capacity = kDefaultCapacity);
+    ~ProcTable();
+    ProcTable(const ProcTable&) = delete;
+    ProcTable& operator=(const ProcTable&) = delete;
+
+    // Lock-free; safe from any thread. `session` and `tag` are left alone
+    // if not found.
+    WNDPROC Find(HWND hwnd, uint8_t* session = nullptr, uint32_t* tag = nullptr) const {
+        uint32_t parity = m_epoch.load() & 1;
+        m_readers[parity].fetch_add(1);
+        const Table* table = m_table.load();
+        WNDPROC result = nullptr;
+        size_t i = Hash(hwnd) & table->mask;
+        for (size_t probes = 0; probes <= table->mask;) {
+            const Slot& slot = table->slots[i];
+            uint32_t version = slot.version.load(std::memory_order_acquire);
+            HWND key = slot.key.load(std::memory_order_acquire);
+            if (key == hwnd) {
+                WNDPROC value = slot.value.load(std::memory_order_relaxed);
+                uint8_t s = slot.session.load(std::memory_order_relaxed);
+                uint32_t t = slot.tag.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if ((version & 1) || slot.version.load(std::memory_order_relaxed) != version) continue; // changed: read again
+                result = value;
+                if (session) *session = s;
+                if (tag) *tag = t;
+                break;
+            }
+            if (key == nullptr) break;
+            ++probes;
+            i = (i + 1) & table->mask;
+        }
+        m_readers[parity].fetch_sub(1, std::memory_order_release);
+        return result;
+    }
+
+    // Writer thread only. False when the pool is full (half the capacity
+    // live); the window is then best left alone.
+    bool Set(HWND hwnd, WNDPROC proc, uint8_t session = kNoSession);
+    // Erases `hwnd`, only if its entry still has `tag` when one is given.
+    bool Erase(HWND hwnd, uint32_t tag = 0);
+    void Clear();
+    // Writer thread only. Moves the live entries (none if !keep) into the
+    // spare array and publishes it; Set does this by itself when erased
+    // slots pile up. Returns once no reader can still see the old array.
+    void Compact(bool keep = true);
+    size_t Size() const { return m_table.load(std::memory_order_relaxed)->live; }
+    size_t Capacity() const { return m_capacity; }
+    // Bumped after every change, so a reader may keep a result for as long
+    // as the generation it read before the lookup is still current.
+    uint32_t Generation() const { return m_generation.load(std::memory_order_acquire); }
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> version{ 0 };
+        std::atomic<uint32_t> tag{ 0 };
+        std::atomic<HWND> key{ nullptr };
+        std::atomic<WNDPROC> value{ nullptr };
+        std::atomic<uint8_t> session{ kNoSession };
+    };
+
+    struct Table {
+        size_t mask;
+        size_t used; // live + tombstones (writer only)
+        size_t live; // writer only
+        Slot* slots;
+    };
+
+    static size_t Hash(HWND hwnd) {
+        uint64_t v = (uint64_t)(uintptr_t)hwnd * 0x9E3779B97F4A7C15ull;
+        return (size_t)(v >> 32);
+    }
+
+    // Brackets a change to one slot (odd version while it lasts).
+    static void BeginWrite(Slot& slot);
+    static void EndWrite(Slot& slot);
+
+    size_t m_capacity;
+    Table m_tables[2];
+    Table* m_spare;
+    uint32_t m_nextTag = 0; // writer only
+    std::atomic<Table*> m_table;
+    std::atomic<uint32_t> m_epoch{ 0 };
+    std::atomic<uint32_t> m_generation{ 1 };
+    mutable std::atomic<uint32_t> m_readers[2] = {};
+};
@@ -0,0 +1,57 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+// std::mutex that accounts wait and hold time, so lock contention shows up in
+// benchmarks. Usable with std::lock_guard.
+class ProfiledMutex {
+public:
+    struct Stats {
+        uint64_t acquisitions;
+        uint64_t waitNs;
+        uint64_t holdNs;
+        uint64_t maxHoldNs;
+    };
+
+    void lock() {
+        auto start = Clock::now();
+        m_mutex.lock();
+        m_acquiredAt = Clock::now();
+        m_acquisitions.fetch_add(1, std::memory_order_relaxed);
+        m_waitNs.fetch_add(Nanos(start, m_acquiredAt), std::memory_order_relaxed);
+    }
+
+    void unlock() {
+        uint64_t held = Nanos(m_acquiredAt, Clock::now());
+        m_holdNs.fetch_add(held, std::memory_order_relaxed);
+        if (held > m_maxHoldNs.load(std::memory_order_relaxed)) m_maxHoldNs.store(held, std::memory_order_relaxed);
+        m_mutex.unlock();
+    }
+
+    Stats GetStats() const {
+        return { m_acquisitions.load(std::memory_order_relaxed), m_waitNs.load(std::memory_order_relaxed),
+                 m_holdNs.load(std::memory_order_relaxed), m_maxHoldNs.load(std::memory_order_relaxed) };
+    }
+
+    void ResetStats() {
+        m_acquisitions = 0;
+        m_waitNs = 0;
+        m_holdNs = 0;
+        m_maxHoldNs = 0;
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    static uint64_t Nanos(Clock::time_point a, Clock::time_point b) {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count();
+    }
+
+    std::mutex m_mutex;
+    Clock::time_point m_acquiredAt;
+    std::atomic<uint64_t> m_acquisitions{ 0 };
+    std::atomic<uint64_t> m_waitNs{ 0 };
+    std::atomic<uint64_t> m_holdNs{ 0 };
+    std::atomic<uint64_t> m_maxHoldNs{ 0 };
+};
@@ -0,0 +1,225 @@
+#include "restore_journal.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+RestoreJournal g_Journal;
+
+namespace {
+    // Header: magic u32, version u16, record size u16, pid u32, reserved u32,
+    // hook u64, reserved u64.
+    const size_t kPidOffset = 8;
+    const size_t kHookOffset = 16;
+    // Record: hwnd u64, proc u64, style i64, exStyle i64, kind u32, check u32.
+    const size_t kKindOffset = 32;
+    const size_t kCheckOffset = 36;
+
+    uint32_t Checksum(const uint8_t* record) {
+        uint32_t h = 2166136261u; // FNV-1a
+        for (size_t i = 0; i < kCheckOffset; ++i) h = (h ^ record[i]) * 16777619u;
+        return h | 1; // never 0, which is what the unused tail holds
+    }
+
+    template<typename T> T Read(const uint8_t* p) { T v; memcpy(&v, p, sizeof(T)); return v; }
+    template<typename T> void Write(uint8_t* p, T v) { memcpy(p, &v, sizeof(T)); }
+
+    bool IsValid(const uint8_t* record) {
+        uint32_t kind = Read<uint32_t>(record + kKindOffset);
+        return kind >= RestoreJournal::Subclassed && kind <= RestoreJournal::Released &&
+               Read<uint32_t>(record + kCheckOffset) == Checksum(record);
+    }
+}
+
+RestoreJournal::RestoreJournal() {
+    ResizeLocked(kInitialRecords);
+}
+
+RestoreJournal::~RestoreJournal() {
+    Close();
+}
+
+bool RestoreJournal::Open(const std::wstring& path) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    UnmapLocked();
+    m_mapped = m_file.Open(path);
+    size_t bytes = m_file.OpenedSize();
+    size_t records = bytes > kHeaderSize ? (bytes - kHeaderSize) / kRecordSize : 0;
+    if (!m_mapped || !ResizeLocked(std::max(records, kInitialRecords))) {
+        UnmapLocked();
+        ResizeLocked(kInitialRecords);
+        return false;
+    }
+
+    m_count = 0;
+    m_previous = {};
+    bool valid = Read<uint32_t>(m_base) == kMagic && Read<uint16_t>(m_base + 4) == kVersion &&
+                 Read<uint16_t>(m_base + 6) == kRecordSize;
+    if (!valid) {
+        // New or foreign file: start from a clean slate.
+        memset(m_base, 0, kHeaderSize + m_capacity * kRecordSize);
+        return true;
+    }
+    m_previous.pid = Read<uint32_t>(m_base + kPidOffset);
+    m_previous.hook = Read<uint64_t>(m_base + kHookOffset);
+    while (m_count < m_capacity && IsValid(RecordAt(m_count))) ++m_count;
+    // A torn append may have left a partial record behind the valid ones.
+    if (m_count < m_capacity) memset(RecordAt(m_count), 0, kRecordSize);
+    return true;
+}
+
+void RestoreJournal::Close() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_mapped) return;
+    UnmapLocked();
+    ResizeLocked(kInitialRecords);
+}
+
+void RestoreJournal::RecordSubclassed(HWND hwnd, WNDPROC original) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    AppendLocked(Subclassed, hwnd, (uint64_t)(uintptr_t)original, 0, 0);
+}
+
+void RestoreJournal::RecordRestyled(HWND hwnd, LONG_PTR style, LONG_PTR exStyle) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    AppendLocked(Restyled, hwnd, 0, style, exStyle);
+}
+
+void RestoreJournal::RecordReleased(HWND hwnd) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    AppendLocked(Released, hwnd, 0, 0, 0);
+}
+
+std::vector<RestoreJournal::Entry> RestoreJournal::Pending() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return FoldLocked();
+}
+
+size_t RestoreJournal::Records() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_count;
+}
+
+RestoreJournal::Owner RestoreJournal::PreviousOwner() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_previous;
+}
+
+void RestoreJournal::Reset(const Owner& owner) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Only the used records need clearing; the rest of the tail is zero.
+    memset(RecordAt(0), 0, m_count * kRecordSize);
+    m_count = 0;
+    Write<uint32_t>(m_base, kMagic);
+    Write<uint16_t>(m_base + 4, kVersion);
+    Write<uint16_t>(m_base + 6, (uint16_t)kRecordSize);
+    Write<uint32_t>(m_base + kPidOffset, owner.pid);
+    Write<uint64_t>(m_base + kHookOffset, owner.hook);
+    m_previous = owner;
+}
+
+void RestoreJournal::AppendLocked(uint32_t kind, HWND hwnd, uint64_t proc, LONG_PTR style, LONG_PTR exStyle) {
+    if (m_count == m_capacity && !CompactLocked() && !ResizeLocked(m_capacity * 2)) return;
+    WriteLocked(m_count, kind, hwnd, proc, style, exStyle);
+    ++m_count;
+}
+
+void RestoreJournal::WriteLocked(size_t i, uint32_t kind, HWND hwnd, uint64_t proc, LONG_PTR style, LONG_PTR exStyle) {
+    uint8_t* record = RecordAt(i);
+    Write<uint64_t>(record, (uint64_t)(uintptr_t)hwnd);
+    Write<uint64_t>(record + 8, proc);
+    Write<int64_t>(record + 16, (int64_t)style);
+    Write<int64_t>(record + 24, (int64_t)exStyle);
+    Write<uint32_t>(record + kKindOffset, kind);
+    // The checksum goes last: a crash before it leaves an invalid record.
+    std::atomic_thread_fence(std::memory_order_release);
+    Write<uint32_t>(record + kCheckOffset, Checksum(record));
+}
+
+bool RestoreJournal::CompactLocked() {
+    // Windows come and go while passthrough is on, each leaving records
+    // behind; most of a full journal is windows released since. Rewriting
+    // what is still pending keeps the file at its size. Done in place: a
+    // torn rewrite needs the process (and its windows) to die mid-way, and
+    // any prefix of it followed by the old records still folds the same.
+    std::vector<Entry> pending = FoldLocked();
+    size_t needed = 0;
+    for (const Entry& e : pending) {
+        needed += (e.changes & (1 << Subclassed)) ? 1 : 0;
+        needed += (e.changes & (1 << Restyled)) ? 1 : 0;
+    }
+    if (needed * 2 > m_capacity) return false; // mostly live: grow instead
+
+    size_t n = 0;
+    for (const Entry& e : pending) {
+        if (e.changes & (1 << Subclassed)) WriteLocked(n++, Subclassed, e.hwnd, (uint64_t)(uintptr_t)e.proc, 0, 0);
+        if (e.changes & (1 << Restyled)) WriteLocked(n++, Restyled, e.hwnd, 0, e.style, e.exStyle);
+    }
+    // The tail must read as unused again.
+    memset(RecordAt(n), 0, (m_count - n) * kRecordSize);
+    m_count = n;
+    return true;
+}
+
+std::vector<RestoreJournal::Entry> RestoreJournal::FoldLocked() const {
+    // Group by window, keeping append order within a window.
+    std::vector<uint32_t> order(m_count);
+    for (size_t i = 0; i < m_count; ++i) order[i] = (uint32_t)i;
+    std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+        return Read<uint64_t>(RecordAt(a)) < Read<uint64_t>(RecordAt(b));
+    });
+
+    std::vector<Entry> out;
+    Entry current = {};
+    for (size_t n = 0; n <= order.size(); ++n) {
+        const uint8_t* record = n < order.size() ? RecordAt(order[n]) : nullptr;
+        HWND hwnd = record ? (HWND)(uintptr_t)Read<uint64_t>(record) : nullptr;
+        if (!record || hwnd != current.hwnd) {
+            if (current.changes) out.push_back(current);
+            if (!record) break;
+            current = {};
+            current.hwnd = hwnd;
+        }
+        switch (Read<uint32_t>(record + kKindOffset)) {
+        case Subclassed:
+            // Latest wins: the proc HookProc forwards to right now.
+            current.proc = (WNDPROC)(uintptr_t)Read<uint64_t>(record + 8);
+            current.changes |= 1 << Subclassed;
+            break;
+        case Restyled:
+            // First wins: the styles before any change.
+            if (!(current.changes & (1 << Restyled))) {
+                current.style = (LONG_PTR)Read<int64_t>(record + 16);
+                current.exStyle = (LONG_PTR)Read<int64_t>(record + 24);
+                current.changes |= 1 << Restyled;
+            }
+            break;
+        case Released:
+            current = {};
+            current.hwnd = hwnd;
+            break;
+        }
+    }
+    return out;
+}
+
+bool RestoreJournal::ResizeLocked(size_t records) {
+    const size_t bytes = kHeaderSize + records * kRecordSize;
+    if (!m_mapped) {
+        m_memory.resize(bytes, 0);
+        m_base = m_memory.data();
+    } else {
+        if (!m_file.Map(bytes)) return false;
+        m_base = m_file.Data();
+    }
+    m_capacity = records;
+    return true;
+}
+
+void RestoreJournal::UnmapLocked() {
+    m_file.Close();
+    m_mapped = false;
+    m_memory.clear();
+    m_base = nullptr;
+    m_capacity = 0;
+    m_count = 0;
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include "platform.hpp"
+#include "mapped_file.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Append-only record of what was changed on which window, written before the
+// change is made. Backed by a memory-mapped file (restore.journal next to
+// config.ini), so the records outlive a crash of the addon or of LS itself,
+// and the next load can put the windows back. Without a file it keeps the
+// same records in memory.
+//
+// A full journal is first compacted to the changes still in effect and only
+// grows when those fill half of it, so window churn does not grow the file.
+//
+// Layout: a 32-byte header, then 40-byte records. Each record ends with a
+// checksum written last; the unused tail is zero, so a reader stops at the
+// first record that does not check out, which also drops a torn append.
+class RestoreJournal {
+public:
+    static const uint32_t kMagic = 0x4A52534C; // "LSRJ"
+    static const uint16_t kVersion = 1;
+    static const size_t kHeaderSize = 32;
+    static const size_t kRecordSize = 40;
+    static constexpr size_t kInitialRecords = 1024;
+
+    enum Kind : uint32_t {
+        Subclassed = 1, // proc: the window procedure that was replaced
+        Restyled = 2,   // style / exStyle: the styles before the first change
+        Released = 3,   // the window is gone; earlier records no longer apply
+    };
+
+    // One window's changes still in effect, folded from its records.
+    struct Entry {
+        HWND hwnd;
+        WNDPROC proc;
+        LONG_PTR style;
+        LONG_PTR exStyle;
+        uint8_t changes; // 1 << Subclassed | 1 << Restyled
+    };
+
+    // Who wrote the journal: the process and its HookProc address, so a
+    // replay knows whether the handles and procs are still meaningful.
+    struct Owner {
+        DWORD pid;
+        uint64_t hook;
+    };
+
+    RestoreJournal();
+    ~RestoreJournal();
+
+    // Maps `path`, creating it if needed, and keeps any records a previous
+    // session left in it (see Pending / PreviousOwner). Falls back to memory
+    // and returns false if the file cannot be mapped.
+    bool Open(const std::wstring& path);
+    // Unmaps the file as it is; records still pending stay for the next Open.
+    void Close();
+    bool IsMapped() const { return m_mapped; }
+
+    void RecordSubclassed(HWND hwnd, WNDPROC original);
+    void RecordRestyled(HWND hwnd, LONG_PTR style, LONG_PTR exStyle);
+    void RecordReleased(HWND hwnd);
+
+    // The changes still in effect, one entry per window, in O(records).
+    std::vector<Entry> Pending() const;
+    size_t Records() const;
+    Owner PreviousOwner() const;
+    // Drops every record (all restored) and stamps the header with `owner`.
+    void Reset(const Owner& owner);
+
+private:
+    void AppendLocked(uint32_t kind, HWND hwnd, uint64_t proc, LONG_PTR style, LONG_PTR exStyle);
+    void WriteLocked(size_t i, uint32_t kind, HWND hwnd, uint64_t proc, LONG_PTR style, LONG_PTR exStyle);
+    // Rewrites a full journal as its pending entries; false (nothing done)
+    // if they would still take more than half of it.
+    bool CompactLocked();
+    std::vector<Entry> FoldLocked() const;
+    // Grows (or first allocates) the mapping or the memory buffer; the
+    // mapped file is extended with zeros.
+    bool ResizeLocked(size_t records);
+    void UnmapLocked();
+    uint8_t* RecordAt(size_t i) const { return m_base + kHeaderSize + i * kRecordSize; }
+
+    mutable std::mutex m_mutex;
+    uint8_t* m_base = nullptr;
+    size_t m_capacity = 0; // records
+    size_t m_count = 0;
+    Owner m_previous = {};
+    bool m_mapped = false;
+    std::vector<uint8_t> m_memory; // backing store when not mapped
+    MappedFile m_file;
+};
+
+extern RestoreJournal g_Journal;
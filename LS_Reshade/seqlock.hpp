@@ -0,0 +1,71 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <type_traits>
+
+// Single-value seqlock. Readers copy the value out of atomic words and retry
+// if a write overlapped; they never block a writer or each other and take no
+// lock, so they are safe on a window procedure. Writers are serialized by a
+// mutex. Every Store() advances Epoch() by one, so a reader can detect a
+// change with a single load.
+template<typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock value must be trivially copyable");
+    static const size_t kWords = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+public:
+    SeqLock() { Publish(T()); }
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+
+    // A consistent copy and the epoch it was published at.
+    T Load(uint64_t* epoch = nullptr) const {
+        uint64_t words[kWords];
+        for (;;) {
+            uint64_t before = m_sequence.load(std::memory_order_acquire);
+            if (before & 1) continue; // a write is in progress
+            for (size_t i = 0; i < kWords; ++i) words[i] = m_words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (m_sequence.load(std::memory_order_relaxed) != before) continue;
+            if (epoch) *epoch = before >> 1;
+            T value;
+            memcpy(&value, words, sizeof(T));
+            return value;
+        }
+    }
+
+    uint64_t Epoch() const { return m_sequence.load(std::memory_order_acquire) >> 1; }
+
+    void Store(const T& value) {
+        std::lock_guard<std::mutex> lock(m_writer);
+        Publish(value);
+    }
+
+    // Read-modify-write against other writers: edit(T&) gets the current
+    // value; nothing is published (and the epoch stays) if it returns false.
+    template<typename Edit>
+    T Update(Edit&& edit) {
+        std::lock_guard<std::mutex> lock(m_writer);
+        T value = Load();
+        if (edit(value)) Publish(value);
+        return value;
+    }
+
+private:
+    void Publish(const T& value) {
+        uint64_t words[kWords] = {};
+        memcpy(words, &value, sizeof(T));
+        uint64_t sequence = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < kWords; ++i) m_words[i].store(words[i], std::memory_order_relaxed);
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    std::atomic<uint64_t> m_sequence{ 0 };
+    std::atomic<uint64_t> m_words[kWords] = {};
+    std::mutex m_writer;
+};
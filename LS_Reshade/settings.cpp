@@ -0,0 +1,432 @@
+#include "settings.hpp"
+#include "logger.hpp"
+#include "window_rules.hpp"
+#include "focus_resolver.hpp"
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+Settings g_Settings;
+SettingsStore g_SettingsStore;
+
+namespace {
+    const char* const kSection = "Settings";
+    const char* const kRulesSection = "Rules";
+    const char* const kKeys[] = { "HotkeyVk", "HotkeyCtrl", "HotkeyAlt", "HotkeyShift", "AutoClickRepress" };
+    const size_t kKeyCount = sizeof(kKeys) / sizeof(kKeys[0]);
+
+    int GetValue(const SettingsValues& v, size_t key) {
+        switch (key) {
+            case 0: return v.hotkeyVk;
+            case 1: return v.hotkeyCtrl;
+            case 2: return v.hotkeyAlt;
+            case 3: return v.hotkeyShift;
+            default: return v.autoClickRepress;
+        }
+    }
+
+    void SetValue(SettingsValues& v, size_t key, int value) {
+        switch (key) {
+            case 0: v.hotkeyVk = value; break;
+            case 1: v.hotkeyCtrl = value != 0; break;
+            case 2: v.hotkeyAlt = value != 0; break;
+            case 3: v.hotkeyShift = value != 0; break;
+            default: v.autoClickRepress = value != 0; break;
+        }
+    }
+
+    std::string Trim(const std::string& s) {
+        size_t b = s.find_first_not_of(" \t");
+        if (b == std::string::npos) return std::string();
+        size_t e = s.find_last_not_of(" \t");
+        return s.substr(b, e - b + 1);
+    }
+
+    // INI names are case-insensitive, as with GetPrivateProfileIntW.
+    bool SameName(const std::string& a, const char* b) {
+        size_t i = 0;
+        for (; i < a.size() && b[i]; ++i) {
+            char x = a[i], y = b[i];
+            if (x >= 'A' && x <= 'Z') x += 'a' - 'A';
+            if (y >= 'A' && y <= 'Z') y += 'a' - 'A';
+            if (x != y) return false;
+        }
+        return i == a.size() && !b[i];
+    }
+
+    // Returns true for "[name]" and sets `name`.
+    bool SectionHeader(const std::string& line, std::string& name) {
+        if (line.size() < 2 || line[0] != '[') return false;
+        size_t close = line.find(']');
+        if (close == std::string::npos) return false;
+        name = Trim(line.substr(1, close - 1));
+        return true;
+    }
+
+    // Index into kKeys for a "key=value" line, or kKeyCount.
+    size_t KeyOf(const std::string& line, std::string* value) {
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) return kKeyCount;
+        std::string key = Trim(line.substr(0, eq));
+        for (size_t k = 0; k < kKeyCount; ++k) {
+            if (SameName(key, kKeys[k])) {
+                if (value) *value = Trim(line.substr(eq + 1));
+                return k;
+            }
+        }
+        return kKeyCount;
+    }
+
+    // Compiles the [Rules] section into g_WindowRules if it changed. True if
+    // the rules in effect changed.
+    bool ApplyRules(const std::string& text);
+
+    std::vector<std::string> SplitLines(const std::string& text) {
+        std::vector<std::string> lines;
+        size_t start = text.compare(0, 3, "\xEF\xBB\xBF") == 0 ? 3 : 0;
+        while (start < text.size()) {
+            size_t end = text.find('\n', start);
+            if (end == std::string::npos) end = text.size();
+            std::string line = text.substr(start, end - start);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            lines.push_back(line);
+            start = end + 1;
+        }
+        return lines;
+    }
+}
+
+// --- Settings ---
+
+bool SettingsValues::operator==(const SettingsValues& o) const {
+    return hotkeyVk == o.hotkeyVk && hotkeyCtrl == o.hotkeyCtrl && hotkeyAlt == o.hotkeyAlt &&
+           hotkeyShift == o.hotkeyShift && autoClickRepress == o.autoClickRepress;
+}
+
+void Settings::SetValues(const SettingsValues& values) {
+    bool changed = false;
+    m_config.Update([&](SettingsSnapshot& s) {
+        if (s.values == values) return false;
+        s.values = values;
+        return changed = true;
+    });
+    if (changed) Notify();
+}
+
+bool Settings::ReplaceValues(const SettingsValues& expected, const SettingsValues& values) {
+    bool changed = false, replaced = false;
+    m_config.Update([&](SettingsSnapshot& s) {
+        if (s.values != expected) return false;
+        replaced = true;
+        if (s.values == values) return false;
+        s.values = values;
+        return changed = true;
+    });
+    if (changed) Notify();
+    return replaced;
+}
+
+void Settings::SetPassthrough(bool on) {
+    bool changed = false;
+    m_config.Update([&](SettingsSnapshot& s) {
+        if (s.inputPassthrough == on) return false;
+        s.inputPassthrough = on;
+        return changed = true;
+    });
+    if (changed) Notify();
+}
+
+// --- Parse & Render ---
+
+SettingsValues SettingsStore::Parse(const std::string& text) {
+    SettingsValues v;
+    bool seen[kKeyCount] = {};
+    bool inSection = false;
+    for (const std::string& raw : SplitLines(text)) {
+        std::string line = Trim(raw);
+        std::string name;
+        if (SectionHeader(line, name)) {
+            inSection = SameName(name, kSection);
+            continue;
+        }
+        if (!inSection || line.empty() || line[0] == ';') continue;
+        std::string value;
+        size_t k = KeyOf(line, &value);
+        // The first occurrence wins, as with GetPrivateProfileIntW.
+        if (k == kKeyCount || seen[k]) continue;
+        seen[k] = true;
+        SetValue(v, k, (int)strtol(value.c_str(), nullptr, 10));
+    }
+    return v;
+}
+
+std::string SettingsStore::Render(const std::string& existing, const SettingsValues& values) {
+    std::vector<std::string> out;
+    bool written[kKeyCount] = {};
+    bool inSection = false;
+    bool sectionFound = false;
+
+    auto keyLine = [&](size_t k) { return std::string(kKeys[k]) + "=" + std::to_string(GetValue(values, k)); };
+    // Appends keys the section did not have, ahead of its trailing blank lines.
+    auto closeSection = [&]() {
+        size_t blanks = 0;
+        while (!out.empty() && Trim(out.back()).empty()) { out.pop_back(); ++blanks; }
+        for (size_t k = 0; k < kKeyCount; ++k) {
+            if (!written[k]) { out.push_back(keyLine(k)); written[k] = true; }
+        }
+        out.insert(out.end(), blanks, std::string());
+    };
+
+    for (const std::string& raw : SplitLines(existing)) {
+        std::string line = Trim(raw);
+        std::string name;
+        if (SectionHeader(line, name)) {
+            if (inSection) closeSection();
+            inSection = !sectionFound && SameName(name, kSection);
+            sectionFound |= inSection;
+            out.push_back(raw);
+            continue;
+        }
+        if (inSection && !line.empty() && line[0] != ';') {
+            size_t k = KeyOf(line, nullptr);
+            if (k != kKeyCount && !written[k]) {
+                out.push_back(keyLine(k));
+                written[k] = true;
+                continue;
+            }
+        }
+        out.push_back(raw);
+    }
+    if (inSection) closeSection();
+    if (!sectionFound) {
+        if (!out.empty() && !Trim(out.back()).empty()) out.push_back(std::string());
+        out.push_back(std::string("[") + kSection + "]");
+        closeSection();
+    }
+
+    std::string text;
+    for (const std::string& line : out) text += line + "\r\n";
+    return text;
+}
+
+std::vector<std::string> SettingsStore::ParseRules(const std::string& text) {
+    std::vector<std::string> rules;
+    bool inSection = false;
+    for (const std::string& raw : SplitLines(text)) {
+        std::string line = Trim(raw);
+        std::string name;
+        if (SectionHeader(line, name)) {
+            inSection = SameName(name, kRulesSection);
+            continue;
+        }
+        if (!inSection || line.empty() || line[0] == ';') continue;
+        // "Rule=ignore class=X", "Rule2=..." or the bare rule.
+        size_t eq = line.find('=');
+        if (eq != std::string::npos) {
+            std::string key = Trim(line.substr(0, eq));
+            if (key.size() >= 4 && SameName(key.substr(0, 4), "rule") &&
+                key.find_first_not_of("0123456789", 4) == std::string::npos) {
+                line = Trim(line.substr(eq + 1));
+            }
+        }
+        if (!line.empty()) rules.push_back(line);
+    }
+    return rules;
+}
+
+namespace {
+    bool ApplyRules(const std::string& text) {
+        std::vector<std::string> rules = SettingsStore::ParseRules(text);
+        if (rules == g_WindowRules.Specs()) return false;
+        std::string error;
+        if (!g_WindowRules.Load(rules, &error)) {
+            LOG_ERROR("Window rules not applied: %s", error.c_str());
+            return false;
+        }
+        // The target may be a different window now.
+        g_FocusResolver.Invalidate();
+        LOG_INFO("Loaded %zu window rules", rules.size());
+        return true;
+    }
+}
+
+// --- Store ---
+
+void SettingsStore::Start(const std::wstring& path) {
+    if (m_thread.joinable()) return;
+    m_path = std::filesystem::path(path);
+    {
+        std::lock_guard<std::mutex> lock(m_fileMutex);
+        std::string text;
+        ReadFile(m_path, text);
+        g_Settings.SetValues(Parse(text));
+        ApplyRules(text);
+        m_lastSeen = Stamp();
+    }
+    m_stop = false;
+    m_thread = std::thread(&SettingsStore::Run, this);
+}
+
+void SettingsStore::Stop() {
+    if (!m_thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_one();
+    m_thread.join();
+    Flush();
+}
+
+void SettingsStore::MarkDirty() {
+    m_requests.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_dirty = true;
+        m_due = Clock::now() + std::chrono::milliseconds(kDebounceMs);
+    }
+    m_cv.notify_one();
+}
+
+void SettingsStore::Flush() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_dirty) return;
+    }
+    Write();
+}
+
+void SettingsStore::Run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    Clock::time_point nextCheck = Clock::now() + std::chrono::milliseconds(kWatchMs);
+    while (!m_stop) {
+        Clock::time_point now = Clock::now();
+        if (m_dirty && now >= m_due) {
+            lock.unlock();
+            Write();
+            lock.lock();
+            continue;
+        }
+        if (now >= nextCheck) {
+            nextCheck = now + std::chrono::milliseconds(kWatchMs);
+            // A pending save is newer than whatever is on disk.
+            if (!m_dirty) {
+                lock.unlock();
+                CheckExternal();
+                lock.lock();
+            }
+            continue;
+        }
+        m_cv.wait_until(lock, m_dirty && m_due < nextCheck ? m_due : nextCheck);
+    }
+}
+
+bool SettingsStore::Write() {
+    std::lock_guard<std::mutex> lock(m_fileMutex);
+    // Cleared under the file lock, so CheckExternal sees an edit as pending
+    // until the write that saves it has started.
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_dirty = false;
+    }
+    std::string existing;
+    ReadFile(m_path, existing);
+    std::string text = Render(existing, g_Settings.Read().values);
+
+    std::filesystem::path temp = m_path;
+    temp += ".tmp";
+    {
+        std::ofstream file(temp, std::ios::out | std::ios::binary | std::ios::trunc);
+        file.write(text.data(), (std::streamsize)text.size());
+        file.close();
+        if (!file) {
+            m_failures.fetch_add(1, std::memory_order_relaxed);
+            LOG_ERROR("Settings: could not write %s", temp.string().c_str());
+            RetryLater();
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp, m_path, ec);
+    if (ec) {
+        m_failures.fetch_add(1, std::memory_order_relaxed);
+        LOG_ERROR("Settings: could not replace config.ini (%s)", ec.message().c_str());
+        std::filesystem::remove(temp, ec);
+        RetryLater();
+        return false;
+    }
+    m_lastSeen = Stamp();
+    m_writes.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_retryMs = kRetryMs;
+    }
+    return true;
+}
+
+void SettingsStore::RetryLater() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Clock::time_point due = Clock::now() + std::chrono::milliseconds(m_retryMs);
+        // Not before the debounce of an edit made during the write.
+        if (!m_dirty || m_due < due) m_due = due;
+        m_dirty = true;
+        m_retryMs = m_retryMs * 2 < kRetryMaxMs ? m_retryMs * 2 : kRetryMaxMs;
+    }
+    m_cv.notify_one();
+}
+
+void SettingsStore::CheckExternal() {
+    std::lock_guard<std::mutex> lock(m_fileMutex);
+    FileStamp stamp = Stamp();
+    if (!(stamp != m_lastSeen)) return;
+    m_lastSeen = stamp;
+    const SettingsValues current = g_Settings.Read().values;
+    std::string text;
+    if (!ReadFile(m_path, text)) return;
+    SettingsValues values = Parse(text);
+    bool rulesChanged = ApplyRules(text);
+    if (values == current && !rulesChanged) return;
+    // A UI edit made since Run() checked m_dirty is newer than the file:
+    // keep it, and let its pending save overwrite the external values.
+    bool pending;
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        pending = m_dirty;
+    }
+    if (pending || !g_Settings.ReplaceValues(current, values)) {
+        LOG_INFO("Settings: config.ini changed while an edit was unsaved; keeping the edit");
+        return;
+    }
+    m_reloads.fetch_add(1, std::memory_order_relaxed);
+    LOG_INFO("Settings reloaded from config.ini");
+}
+
+SettingsStore::FileStamp SettingsStore::Stamp() const {
+    FileStamp s;
+    std::error_code ec;
+    s.time = std::filesystem::last_write_time(m_path, ec);
+    if (ec) return s;
+    s.size = std::filesystem::file_size(m_path, ec);
+    s.exists = !ec;
+    return s;
+}
+
+bool SettingsStore::ReadFile(const std::filesystem::path& path, std::string& text) {
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file.is_open()) return false;
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    text = buffer.str();
+    return true;
+}
+
+SettingsStore::Stats SettingsStore::GetStats() const {
+    Stats s;
+    s.requests = m_requests.load(std::memory_order_relaxed);
+    s.writes = m_writes.load(std::memory_order_relaxed);
+    s.reloads = m_reloads.load(std::memory_order_relaxed);
+    s.failures = m_failures.load(std::memory_order_relaxed);
+    return s;
+}
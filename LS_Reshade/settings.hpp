@@ -0,0 +1,146 @@
+#pragma once
+#include "platform.hpp"
+#include "seqlock.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// The persisted subset of the settings.
+struct SettingsValues {
+    int hotkeyVk = VK_HOME;
+    bool hotkeyCtrl = false;
+    bool hotkeyAlt = false;
+    bool hotkeyShift = false;
+    bool autoClickRepress = true;
+
+    bool operator==(const SettingsValues& o) const;
+    bool operator!=(const SettingsValues& o) const { return !(*this == o); }
+};
+
+// One immutable, consistent view of the configuration.
+struct SettingsSnapshot {
+    SettingsValues values;
+    // On while any LS window's session is; the worker keeps it in step.
+    // Setting it from outside turns on the focused session, or all off.
+    bool inputPassthrough = false;
+    uint64_t epoch = 0; // filled in by Read()
+};
+
+// --- Global Settings ---
+// Configuration is published as whole snapshots through a seqlock: Read()
+// is lock-free and never sees a half-edited hotkey, and Epoch() tells a
+// consumer whether anything changed since its last Read(). Epochs start at 1.
+class Settings {
+public:
+    SettingsSnapshot Read() const {
+        uint64_t epoch;
+        SettingsSnapshot s = m_config.Load(&epoch);
+        s.epoch = epoch;
+        return s;
+    }
+    uint64_t Epoch() const { return m_config.Epoch(); }
+
+    // Each returns without publishing if nothing changes.
+    void SetValues(const SettingsValues& values);
+    // SetValues only if the values are still `expected`; false if another
+    // edit got there first.
+    bool ReplaceValues(const SettingsValues& expected, const SettingsValues& values);
+    void SetPassthrough(bool on);
+    // Called after every publish that changed something (the worker runtime
+    // uses it to end its wait); nullptr to clear.
+    void OnChange(void (*notify)()) { m_notify.store(notify, std::memory_order_release); }
+
+private:
+    void Notify() const {
+        if (void (*notify)() = m_notify.load(std::memory_order_acquire)) notify();
+    }
+
+    SeqLock<SettingsSnapshot> m_config;
+    std::atomic<void (*)()> m_notify{ nullptr };
+};
+
+extern Settings g_Settings;
+
+// --- Settings Store ---
+// Owns config.ini. The path is resolved once by Start(). MarkDirty() only
+// flags a save; a background thread writes once the UI has been quiet for
+// kDebounceMs, so a burst of edits becomes one write. Writes go to a temp
+// file that is renamed over config.ini, so a crash never leaves it torn.
+// A write that fails (config.ini held open by an editor or a scanner) stays
+// pending and is retried, kRetryMs later at first, backing off to kRetryMaxMs.
+// The same thread checks the file every kWatchMs and applies external edits,
+// except while a UI edit is waiting to be saved: the pending write wins.
+// The file is parsed in one pass; unknown keys and sections are kept.
+class SettingsStore {
+public:
+    static constexpr uint32_t kDebounceMs = 250;
+    static constexpr uint32_t kWatchMs = 500;
+    static constexpr uint32_t kRetryMs = 500;
+    static constexpr uint32_t kRetryMaxMs = 8000;
+
+    struct Stats {
+        uint64_t requests; // MarkDirty calls
+        uint64_t writes;
+        uint64_t reloads;  // external edits applied
+        uint64_t failures;
+    };
+
+    // Loads `path` into g_Settings and starts the writer/watcher thread.
+    void Start(const std::wstring& path);
+    // Writes any pending change and stops the thread.
+    void Stop();
+
+    void MarkDirty();
+    // Writes now if a save is pending (on the calling thread).
+    void Flush();
+
+    Stats GetStats() const;
+
+    // Exposed for the benchmark.
+    static SettingsValues Parse(const std::string& text);
+    // The [Rules] section: one window rule per line, as "Rule=<rule>" or
+    // just "<rule>" (see WindowRules).
+    static std::vector<std::string> ParseRules(const std::string& text);
+    static std::string Render(const std::string& existing, const SettingsValues& values);
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    struct FileStamp {
+        std::filesystem::file_time_type time;
+        uintmax_t size = 0;
+        bool exists = false;
+        bool operator!=(const FileStamp& o) const { return time != o.time || size != o.size || exists != o.exists; }
+    };
+
+    void Run();
+    bool Write();
+    // After a failed write: the save is pending again, due after the backoff.
+    void RetryLater();
+    void CheckExternal();
+    FileStamp Stamp() const;
+    static bool ReadFile(const std::filesystem::path& path, std::string& text);
+
+    std::filesystem::path m_path;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stop = false;
+    bool m_dirty = false;
+    Clock::time_point m_due;
+    uint32_t m_retryMs = kRetryMs; // next backoff, reset by a successful write
+    std::mutex m_fileMutex; // serializes Write() between the thread and Flush()
+    FileStamp m_lastSeen;   // the file as we last wrote or read it
+
+    std::atomic<uint64_t> m_requests{ 0 };
+    std::atomic<uint64_t> m_writes{ 0 };
+    std::atomic<uint64_t> m_reloads{ 0 };
+    std::atomic<uint64_t> m_failures{ 0 };
+};
+
+extern SettingsStore g_SettingsStore;
@@ -0,0 +1,100 @@
+// Command-line client of the addon's control channel, for macro pads and
+// scripts:
+//
+//   ls_control [--mailbox FILE] [--timeout MS] state | metrics | toggle | on | off
+//   ls_control [--mailbox FILE] set VK [MODS [AUTOCLICK]]
+//
+// FILE is control.mailbox next to the addon (default: in the current
+// directory). MODS is a sum of 1 Ctrl, 2 Alt, 4 Shift. Exits with the
+// ControlResult, so 0 is success.
+#include "control_channel.hpp"
+#include "key_catalog.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+namespace {
+    const char* ResultName(ControlResult r) {
+        switch (r) {
+            case ControlOk: return "ok";
+            case ControlRefused: return "refused (no valid focus, or a toggle sequence is running)";
+            case ControlInvalid: return "invalid request";
+            case ControlBusy: return "busy";
+            case ControlTimeout: return "timed out";
+            case ControlNoServer: return "addon not running";
+        }
+        return "?";
+    }
+
+    void PrintState(const ControlState& s) {
+        char chord[64];
+        KeyCatalog::FormatChord(chord, sizeof(chord), s.hotkeyVk, s.mods);
+        printf("passthrough %s (%u LS windows)\nhotkey      %s\nauto click  %s\nepoch       %llu\n",
+               s.passthrough ? "on" : "off", (unsigned)s.activeSessions, chord, s.autoClickRepress ? "on" : "off",
+               (unsigned long long)s.epoch);
+    }
+
+    void PrintMetrics(const ControlMetrics& m) {
+        // Names and order as in the addon's own export.
+        MetricsSnapshot names;
+        Metrics().Collect(names);
+        printf("since reset %.0f s\n", m.seconds);
+        for (size_t i = 0; i < MetricsSnapshot::kDists; ++i) {
+            const ControlMetrics::Dist& d = m.dists[i];
+            printf("%-22s count %10llu  p50 %8llu  p99 %8llu  max %9llu %s\n", names.dists[i].name,
+                   (unsigned long long)d.count, (unsigned long long)d.p50, (unsigned long long)d.p99,
+                   (unsigned long long)d.max, names.dists[i].unit);
+        }
+        for (size_t i = 0; i < MetricsSnapshot::kCounts; ++i) {
+            printf("%-22s %12llu\n", names.counts[i].name, (unsigned long long)m.counts[i]);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* mailbox = "control.mailbox";
+    uint32_t timeoutMs = 1000;
+    int arg = 1;
+    for (; arg + 1 < argc && argv[arg][0] == '-'; arg += 2) {
+        if (strcmp(argv[arg], "--mailbox") == 0) mailbox = argv[arg + 1];
+        else if (strcmp(argv[arg], "--timeout") == 0) timeoutMs = (uint32_t)strtoul(argv[arg + 1], nullptr, 10);
+    }
+    if (arg >= argc) {
+        printf("usage: ls_control [--mailbox FILE] [--timeout MS] state|metrics|toggle|on|off|set VK [MODS [AUTOCLICK]]\n");
+        return ControlInvalid;
+    }
+    const std::string command = argv[arg];
+
+    ControlRequest request = {};
+    if (command == "state") request.command = ControlGetState;
+    else if (command == "metrics") request.command = ControlGetMetrics;
+    else if (command == "toggle") request.command = ControlToggle;
+    else if (command == "on" || command == "off") {
+        request.command = ControlSetPassthrough;
+        request.arg = command == "on" ? 1 : 0;
+    } else if (command == "set" && arg + 1 < argc) {
+        request.command = ControlSetConfig;
+        request.hotkeyVk = (int32_t)strtol(argv[arg + 1], nullptr, 0);
+        request.mods = arg + 2 < argc ? (uint8_t)strtoul(argv[arg + 2], nullptr, 0) : 0;
+        request.autoClickRepress = arg + 3 < argc ? (uint8_t)(strtoul(argv[arg + 3], nullptr, 0) != 0) : 1;
+    } else {
+        printf("unknown command %s\n", command.c_str());
+        return ControlInvalid;
+    }
+
+    ControlClient client;
+    if (!client.Connect(std::filesystem::path(mailbox).wstring())) {
+        printf("%s: %s\n", mailbox, ResultName(ControlNoServer));
+        return ControlNoServer;
+    }
+    ControlReply reply;
+    ControlResult result = client.Send(request, reply, timeoutMs);
+    if (result != ControlOk) printf("%s\n", ResultName(result));
+    if (result == ControlOk || result == ControlRefused) {
+        if (request.command == ControlGetMetrics) PrintMetrics(reply.metrics);
+        else PrintState(reply.state);
+    }
+    return result;
+}
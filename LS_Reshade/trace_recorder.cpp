@@ -0,0 +1,111 @@
+#include "trace_recorder.hpp"
+#include "metrics.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+TraceRecorder g_Trace;
+
+namespace {
+    // Header: magic u32, version u16, record size u16, capacity u64,
+    // wall-clock start (ns since 1970) u64, then zeros.
+    const size_t kCapacityOffset = 8;
+    const size_t kWallOffset = 16;
+
+    template<typename T> T ReadAt(const uint8_t* p) { T v; memcpy(&v, p, sizeof(T)); return v; }
+    template<typename T> void WriteAt(uint8_t* p, T v) { memcpy(p, &v, sizeof(T)); }
+}
+
+bool TraceRecorder::Start(const std::wstring& path, size_t records) {
+    std::lock_guard<std::mutex> lock(m_lifecycle);
+    if (Active()) return false;
+    // A power of two, so slot = (seq - 1) & (capacity - 1) holds across the
+    // wrap of the 32-bit sequence.
+    size_t capacity = 64;
+    while (capacity < records) capacity <<= 1;
+    size_t bytes = kHeaderSize + capacity * sizeof(TraceRecord);
+    if (!m_file.Open(path) || !m_file.Map(bytes)) {
+        m_file.Close();
+        return false;
+    }
+    uint8_t* base = m_file.Data();
+    memset(base, 0, bytes);
+    WriteAt<uint32_t>(base, kMagic);
+    WriteAt<uint16_t>(base + 4, kVersion);
+    WriteAt<uint16_t>(base + 6, (uint16_t)sizeof(TraceRecord));
+    WriteAt<uint64_t>(base + kCapacityOffset, (uint64_t)capacity);
+    WriteAt<uint64_t>(base + kWallOffset, (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+
+    m_records = (TraceRecord*)(base + kHeaderSize);
+    m_capacity = capacity;
+    m_startNs = Metrics::NowNs();
+    m_next.store(0, std::memory_order_relaxed);
+    m_active.store(true, std::memory_order_seq_cst);
+    return true;
+}
+
+void TraceRecorder::Stop() {
+    std::lock_guard<std::mutex> lock(m_lifecycle);
+    if (!Active()) return;
+    m_active.store(false, std::memory_order_seq_cst);
+    // A writer that saw m_active before the store is still in its slot.
+    while (m_writers.load(std::memory_order_seq_cst) != 0) std::this_thread::yield();
+    m_records = nullptr;
+    m_file.Close();
+}
+
+void TraceRecorder::Write(TraceKind kind, uint64_t value, uint32_t arg, uint16_t small, uint8_t flags, HWND hwnd) {
+    m_writers.fetch_add(1, std::memory_order_seq_cst);
+    if (m_active.load(std::memory_order_seq_cst)) {
+        uint64_t index = m_next.fetch_add(1, std::memory_order_relaxed);
+        TraceRecord* r = &m_records[index & (m_capacity - 1)];
+        // Clear the sequence first, so a crash mid-write (or a writer lapping
+        // a slow one) leaves a slot the reader skips.
+        r->seq = 0;
+        std::atomic_thread_fence(std::memory_order_release);
+        r->ns = Metrics::NowNs() - m_startNs;
+        r->value = value;
+        r->hwnd = (uint32_t)(uintptr_t)hwnd;
+        r->arg = arg;
+        r->kind = kind;
+        r->flags = flags;
+        r->small = small;
+        std::atomic_thread_fence(std::memory_order_release);
+        r->seq = (uint32_t)(index + 1);
+    }
+    m_writers.fetch_sub(1, std::memory_order_release);
+}
+
+bool TraceRecorder::Load(const std::wstring& path, std::vector<TraceRecord>& out, uint64_t* lost) {
+    out.clear();
+    std::ifstream in(std::filesystem::path(path), std::ios::binary);
+    if (!in) return false;
+    uint8_t header[kHeaderSize];
+    if (!in.read((char*)header, sizeof(header))) return false;
+    if (ReadAt<uint32_t>(header) != kMagic || ReadAt<uint16_t>(header + 4) != kVersion ||
+        ReadAt<uint16_t>(header + 6) != sizeof(TraceRecord)) {
+        return false;
+    }
+    uint64_t capacity = ReadAt<uint64_t>(header + kCapacityOffset);
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0) return false;
+
+    std::vector<TraceRecord> slots((size_t)capacity);
+    in.read((char*)slots.data(), (std::streamsize)(capacity * sizeof(TraceRecord)));
+    size_t readSlots = (size_t)in.gcount() / sizeof(TraceRecord);
+
+    uint32_t newest = 0;
+    for (size_t i = 0; i < readSlots; ++i) {
+        const TraceRecord& r = slots[i];
+        if (r.seq == 0 || ((r.seq - 1) & (capacity - 1)) != i) continue;
+        if (r.kind == 0 || r.kind >= TraceKindCount) continue;
+        out.push_back(r);
+        newest = std::max(newest, r.seq);
+    }
+    std::sort(out.begin(), out.end(), [](const TraceRecord& a, const TraceRecord& b) { return a.seq < b.seq; });
+    if (lost) *lost = newest - out.size();
+    return true;
+}
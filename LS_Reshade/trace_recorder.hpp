@@ -0,0 +1,88 @@
+#pragma once
+#include "platform.hpp"
+#include "mapped_file.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// What a trace record describes. Field use per kind:
+enum TraceKind : uint8_t {
+    TraceTick = 1,    // value: tick ns, arg: worker clock ms, flags: 1 if the active loop ran
+    TraceRefresh,     // arg: windows processed
+    TraceHook,        // hwnd, small: message, value: our ns, flags: 1 if passthrough
+    TraceMutations,   // value: ns, arg: mutations, small: batches posted, flags: 1 if drained by the owner
+    TraceKey,         // small: vk, flags: 1 down | 2 injected
+    TraceToggle,      // flags: the new passthrough state; arg: the session
+    TraceInput,       // arg: events sent in one batch, small: first vk, flags: first type
+    TraceWindowEvent, // hwnd, small: WindowEvent
+    TraceKindCount
+};
+
+// 32 bytes, little-endian, as stored in the file.
+struct TraceRecord {
+    uint64_t ns;    // since the trace started
+    uint64_t value;
+    uint32_t hwnd;  // handles fit in 32 bits on Win32
+    uint32_t arg;
+    uint8_t kind;
+    uint8_t flags;
+    uint16_t small;
+    uint32_t seq;   // slot index + 1, stored last; 0 = never written
+};
+static_assert(sizeof(TraceRecord) == 32, "trace records are 32 bytes");
+
+// --- Trace Recorder ---
+// An opt-in binary trace of ticks, hook messages, window mutations, key edges
+// and toggle steps, for reproducing a stutter report offline (bench/
+// trace_replay runs one against the fake backend). Records go to a ring in a
+// memory-mapped file, so the last kDefaultRecords events survive a crash.
+// Any thread can record: a slot is claimed with one atomic add and its
+// sequence number is stored last, so a reader skips torn or lapped slots.
+// While off, each trace point costs one relaxed load.
+class TraceRecorder {
+public:
+    static const uint32_t kMagic = 0x5452534C; // "LSRT"
+    static const uint16_t kVersion = 1;
+    static const size_t kHeaderSize = 64;
+    static const size_t kDefaultRecords = 1 << 18; // 8 MB
+
+    TraceRecorder() = default;
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+    ~TraceRecorder() { Stop(); }
+
+    // Maps `path` (truncating any earlier trace in it) and starts recording.
+    bool Start(const std::wstring& path, size_t records = kDefaultRecords);
+    // Waits out writers in flight and unmaps the file.
+    void Stop();
+    bool Active() const { return m_active.load(std::memory_order_relaxed); }
+    // Records claimed since Start (the ring keeps the last Capacity()).
+    uint64_t Written() const { return m_next.load(std::memory_order_relaxed); }
+    size_t Capacity() const { return m_capacity; }
+
+    void Record(TraceKind kind, uint64_t value = 0, uint32_t arg = 0, uint16_t small = 0,
+                uint8_t flags = 0, HWND hwnd = nullptr) {
+        if (Active()) Write(kind, value, arg, small, flags, hwnd);
+    }
+
+    // Reads a trace file, oldest record first. `lost` gets the number of
+    // records the ring overwrote or that were torn. False if not a trace.
+    static bool Load(const std::wstring& path, std::vector<TraceRecord>& out, uint64_t* lost = nullptr);
+
+private:
+    void Write(TraceKind kind, uint64_t value, uint32_t arg, uint16_t small, uint8_t flags, HWND hwnd);
+
+    std::mutex m_lifecycle; // Start / Stop
+    MappedFile m_file;
+    TraceRecord* m_records = nullptr;
+    size_t m_capacity = 0;
+    uint64_t m_startNs = 0;
+    std::atomic<bool> m_active{ false };
+    std::atomic<uint64_t> m_next{ 0 };
+    std::atomic<uint32_t> m_writers{ 0 };
+};
+
+extern TraceRecorder g_Trace;
@@ -0,0 +1,405 @@
+#include "win32_window_system.hpp"
+#include "mpsc_ring.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace {
+    IWindowSystem::EventProc s_eventProc = nullptr;
+    void* s_eventCtx = nullptr;
+    HWINEVENTHOOK s_foregroundHook = nullptr;
+    HWINEVENTHOOK s_objectHook = nullptr;
+    HWINEVENTHOOK s_nameHook = nullptr;
+    IWindowSystem::KeyProc s_keyProc = nullptr;
+    void* s_keyCtx = nullptr;
+    HANDLE s_wakeEvent = ::CreateEventW(NULL, FALSE, FALSE, NULL); // auto-reset
+
+    // The keyboard hook lives on a thread of its own that does nothing but
+    // pump messages, so a busy worker never delays keystrokes system-wide
+    // (and never gets the hook removed for exceeding LowLevelHooksTimeout).
+    // Transitions are queued for the worker's PumpEvents.
+    struct KeyRecord {
+        WORD vk;
+        bool down;
+        bool injected;
+    };
+    // How often the hook thread compares its last callback with the
+    // system's last input, and how long input may go unreported before the
+    // hook is taken for removed.
+    const DWORD kHookCheckMs = 1000;
+    const DWORD kHookSilentMs = 3000;
+    MpscRing<KeyRecord, 256> s_keyRing;
+    std::thread s_keyThread;
+    DWORD s_keyThreadId = 0;
+    std::atomic<DWORD> s_lastKeyTick{ 0 }; // GetTickCount clock, as GetLastInputInfo
+    std::atomic<bool> s_keysLive{ false };
+
+    void CALLBACK WinEventThunk(HWINEVENTHOOK, DWORD event, HWND hwnd, LONG idObject, LONG idChild, DWORD, DWORD) {
+        if (!s_eventProc || idChild != CHILDID_SELF) return;
+        switch (event) {
+            case EVENT_SYSTEM_FOREGROUND: s_eventProc(WindowEventForeground, hwnd, s_eventCtx); break;
+            case EVENT_OBJECT_REORDER: s_eventProc(WindowEventZOrder, hwnd, s_eventCtx); break;
+            case EVENT_OBJECT_SHOW:
+            case EVENT_OBJECT_HIDE:
+                if (idObject == OBJID_WINDOW) s_eventProc(WindowEventVisibility, hwnd, s_eventCtx);
+                break;
+            case EVENT_OBJECT_DESTROY:
+                if (idObject == OBJID_WINDOW) s_eventProc(WindowEventDestroy, hwnd, s_eventCtx);
+                break;
+            case EVENT_OBJECT_NAMECHANGE:
+                if (idObject == OBJID_WINDOW) s_eventProc(WindowEventNameChange, hwnd, s_eventCtx);
+                break;
+        }
+    }
+
+    // Runs on the hook thread; keep it short.
+    LRESULT CALLBACK KeyboardThunk(int code, WPARAM wParam, LPARAM lParam) {
+        if (code == HC_ACTION) {
+            const KBDLLHOOKSTRUCT* key = (const KBDLLHOOKSTRUCT*)lParam;
+            KeyRecord record = { (WORD)key->vkCode, wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN,
+                                 (key->flags & LLKHF_INJECTED) != 0 && key->dwExtraInfo == kInputSignature };
+            s_lastKeyTick.store(key->time, std::memory_order_relaxed);
+            s_keysLive.store(true, std::memory_order_relaxed);
+            // A full ring means the worker is far behind; the key is dropped.
+            s_keyRing.TryPush([&](KeyRecord& r) { r = record; });
+            ::SetEvent(s_wakeEvent);
+        }
+        return ::CallNextHookEx(NULL, code, wParam, lParam);
+    }
+
+    HHOOK InstallKeyHook() {
+        s_lastKeyTick.store(::GetTickCount(), std::memory_order_relaxed);
+        return ::SetWindowsHookExW(WH_KEYBOARD_LL, KeyboardThunk, ::GetModuleHandleW(NULL), 0);
+    }
+
+    // Windows removes a low-level hook that times out without telling its
+    // owner. If there has been input for a while and none of it reached the
+    // callback, reinstall once and report the keys as not live (the watcher
+    // polls) until a callback shows the new hook works. Mouse-only input
+    // also looks like this; the cost is polling until the next keystroke.
+    void CheckKeyHook(HHOOK& hook) {
+        LASTINPUTINFO info = { sizeof(info) };
+        if (!::GetLastInputInfo(&info)) return;
+        if ((LONG)(info.dwTime - s_lastKeyTick.load(std::memory_order_relaxed)) <= (LONG)kHookSilentMs) return;
+        if (!s_keysLive.exchange(false)) return; // already reinstalled, waiting for a key
+        if (hook) ::UnhookWindowsHookEx(hook);
+        hook = InstallKeyHook();
+        ::SetEvent(s_wakeEvent);
+    }
+
+    void KeyHookThread(std::promise<bool>* installed) {
+        MSG msg;
+        ::PeekMessageW(&msg, NULL, WM_USER, WM_USER, PM_NOREMOVE); // create the queue for WM_QUIT
+        HHOOK hook = InstallKeyHook();
+        s_keysLive.store(hook != nullptr);
+        installed->set_value(hook != nullptr);
+        if (!hook) return;
+
+        DWORD lastCheck = ::GetTickCount();
+        for (;;) {
+            ::MsgWaitForMultipleObjects(0, NULL, FALSE, kHookCheckMs, QS_ALLINPUT);
+            // Hook callbacks run inside PeekMessage.
+            while (::PeekMessageW(&msg, NULL, 0, 0, PM_REMOVE)) {
+                if (msg.message == WM_QUIT) {
+                    if (hook) ::UnhookWindowsHookEx(hook);
+                    return;
+                }
+                ::TranslateMessage(&msg);
+                ::DispatchMessageW(&msg);
+            }
+            DWORD now = ::GetTickCount();
+            if (now - lastCheck >= kHookCheckMs) {
+                lastCheck = now;
+                CheckKeyHook(hook);
+            }
+        }
+    }
+
+    struct EnumThunk {
+        IWindowSystem::EnumProc proc;
+        void* ctx;
+    };
+
+    BOOL CALLBACK EnumThunkProc(HWND hwnd, LPARAM lParam) {
+        EnumThunk* thunk = (EnumThunk*)lParam;
+        return thunk->proc(hwnd, thunk->ctx) ? TRUE : FALSE;
+    }
+}
+
+DWORD Win32WindowSystem::CurrentProcessId() { return ::GetCurrentProcessId(); }
+DWORD Win32WindowSystem::CurrentThreadId() { return ::GetCurrentThreadId(); }
+DWORD Win32WindowSystem::GetWindowThread(HWND hwnd, DWORD* pid) { return ::GetWindowThreadProcessId(hwnd, pid); }
+
+void Win32WindowSystem::EnumTopLevel(EnumProc proc, void* ctx) {
+    EnumThunk thunk = { proc, ctx };
+    ::EnumWindows(EnumThunkProc, (LPARAM)&thunk);
+}
+
+void Win32WindowSystem::EnumChildren(HWND parent, EnumProc proc, void* ctx) {
+    EnumThunk thunk = { proc, ctx };
+    ::EnumChildWindows(parent, EnumThunkProc, (LPARAM)&thunk);
+}
+
+void Win32WindowSystem::EnumThreadTopLevel(DWORD tid, EnumProc proc, void* ctx) {
+    EnumThunk thunk = { proc, ctx };
+    ::EnumThreadWindows(tid, EnumThunkProc, (LPARAM)&thunk);
+}
+
+HWND Win32WindowSystem::NextWindow(HWND hwnd) { return ::GetWindow(hwnd, GW_HWNDNEXT); }
+bool Win32WindowSystem::IsAlive(HWND hwnd) { return ::IsWindow(hwnd) != FALSE; }
+bool Win32WindowSystem::IsVisible(HWND hwnd) { return ::IsWindowVisible(hwnd) != FALSE; }
+int Win32WindowSystem::GetClass(HWND hwnd, char* buffer, int size) { return ::GetClassNameA(hwnd, buffer, size); }
+
+int Win32WindowSystem::GetTitle(HWND hwnd, char* buffer, int size) {
+    if (size <= 0) return 0;
+    // GetWindowTextA would send WM_GETTEXT to our own windows' threads.
+    wchar_t text[256];
+    int n = ::InternalGetWindowText(hwnd, text, 256);
+    int len = n > 0 ? ::WideCharToMultiByte(CP_UTF8, 0, text, n, buffer, size - 1, NULL, NULL) : 0;
+    buffer[len] = '\0';
+    return len;
+}
+
+int Win32WindowSystem::GetProcessName(DWORD pid, char* buffer, int size) {
+    if (size <= 0) return 0;
+    buffer[0] = '\0';
+    HANDLE process = ::OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+    if (!process) return 0;
+    char path[MAX_PATH];
+    DWORD len = MAX_PATH;
+    BOOL ok = ::QueryFullProcessImageNameA(process, 0, path, &len);
+    ::CloseHandle(process);
+    if (!ok) return 0;
+    const char* name = path;
+    for (const char* p = path; *p; ++p) {
+        if (*p == '\\' || *p == '/') name = p + 1;
+    }
+    int n = (int)strlen(name);
+    if (n > size - 1) n = size - 1;
+    memcpy(buffer, name, n);
+    buffer[n] = '\0';
+    return n;
+}
+
+LONG_PTR Win32WindowSystem::GetLong(HWND hwnd, int index) { return ::GetWindowLongPtr(hwnd, index); }
+LONG_PTR Win32WindowSystem::SetLong(HWND hwnd, int index, LONG_PTR value) { return ::SetWindowLongPtr(hwnd, index, value); }
+
+bool Win32WindowSystem::SetPos(HWND hwnd, HWND insertAfter, UINT flags) {
+    return ::SetWindowPos(hwnd, insertAfter, 0, 0, 0, 0, flags) != FALSE;
+}
+
+void Win32WindowSystem::ApplyMutations(const WindowMutation* mutations, size_t count) {
+    std::vector<std::pair<HWND, const WindowMutation*>> moves; // (parent, mutation)
+    for (size_t i = 0; i < count; ++i) {
+        const WindowMutation& m = mutations[i];
+        if (m.ops & WindowMutation::SetStyles) {
+            ::SetWindowLongPtr(m.hwnd, GWL_EXSTYLE, m.exStyle);
+            ::SetWindowLongPtr(m.hwnd, GWL_STYLE, m.style);
+        }
+        if (m.ops & WindowMutation::Reposition) moves.push_back({ ::GetAncestor(m.hwnd, GA_PARENT), &m });
+    }
+
+    // A DeferWindowPos transaction only takes siblings, so one per parent.
+    std::stable_sort(moves.begin(), moves.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (size_t begin = 0; begin < moves.size();) {
+        size_t end = begin;
+        while (end < moves.size() && moves[end].first == moves[begin].first) ++end;
+        HDWP dwp = ::BeginDeferWindowPos((int)(end - begin));
+        size_t i = begin;
+        for (; dwp && i < end; ++i) {
+            const WindowMutation& m = *moves[i].second;
+            dwp = ::DeferWindowPos(dwp, m.hwnd, m.insertAfter, 0, 0, 0, 0, m.swpFlags);
+        }
+        if (dwp) {
+            ::EndDeferWindowPos(dwp);
+        } else {
+            // The transaction was dropped; place what it held one by one.
+            for (size_t j = begin; j < end; ++j) {
+                const WindowMutation& m = *moves[j].second;
+                ::SetWindowPos(m.hwnd, m.insertAfter, 0, 0, 0, 0, m.swpFlags);
+            }
+        }
+        begin = end;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        const WindowMutation& m = mutations[i];
+        if (!(m.ops & WindowMutation::Activate)) continue;
+        DWORD foreThread = ::GetWindowThreadProcessId(::GetForegroundWindow(), NULL);
+        DWORD curThread = ::GetCurrentThreadId();
+        if (foreThread != curThread) {
+            ::AttachThreadInput(foreThread, curThread, TRUE);
+            ::BringWindowToTop(m.hwnd);
+            ::SetForegroundWindow(m.hwnd);
+            ::AttachThreadInput(foreThread, curThread, FALSE);
+        } else {
+            ::SetForegroundWindow(m.hwnd);
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        const WindowMutation& m = mutations[i];
+        if (m.ops & WindowMutation::SetProc) ::SetWindowLongPtr(m.hwnd, GWLP_WNDPROC, (LONG_PTR)m.proc);
+    }
+}
+
+bool Win32WindowSystem::WatchEvents(EventProc proc, void* ctx) {
+    UnwatchEvents();
+    s_eventProc = proc;
+    s_eventCtx = ctx;
+    // Out-of-context hooks are delivered to this thread while it pumps messages.
+    s_foregroundHook = ::SetWinEventHook(EVENT_SYSTEM_FOREGROUND, EVENT_SYSTEM_FOREGROUND, NULL, WinEventThunk, 0, 0, WINEVENT_OUTOFCONTEXT);
+    s_objectHook = ::SetWinEventHook(EVENT_OBJECT_DESTROY, EVENT_OBJECT_REORDER, NULL, WinEventThunk, 0, 0, WINEVENT_OUTOFCONTEXT);
+    // Separate, so the busy range in between (location changes) stays out.
+    s_nameHook = ::SetWinEventHook(EVENT_OBJECT_NAMECHANGE, EVENT_OBJECT_NAMECHANGE, NULL, WinEventThunk, 0, 0, WINEVENT_OUTOFCONTEXT);
+    if (!s_foregroundHook || !s_objectHook || !s_nameHook) {
+        UnwatchEvents();
+        return false;
+    }
+    return true;
+}
+
+void Win32WindowSystem::UnwatchEvents() {
+    if (s_foregroundHook) ::UnhookWinEvent(s_foregroundHook);
+    if (s_objectHook) ::UnhookWinEvent(s_objectHook);
+    if (s_nameHook) ::UnhookWinEvent(s_nameHook);
+    s_foregroundHook = nullptr;
+    s_objectHook = nullptr;
+    s_nameHook = nullptr;
+    s_eventProc = nullptr;
+    s_eventCtx = nullptr;
+}
+
+void Win32WindowSystem::PumpEvents() {
+    MSG msg;
+    while (::PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
+        ::TranslateMessage(&msg);
+        ::DispatchMessage(&msg);
+    }
+    if (!s_keyProc) return;
+    KeyRecord key;
+    while (s_keyRing.TryPop([&](KeyRecord& r) { key = r; })) s_keyProc(key.vk, key.down, key.injected, s_keyCtx);
+}
+
+bool Win32WindowSystem::WatchKeys(KeyProc proc, void* ctx) {
+    UnwatchKeys();
+    s_keyProc = proc;
+    s_keyCtx = ctx;
+    std::promise<bool> installed;
+    std::future<bool> result = installed.get_future();
+    s_keyThread = std::thread(KeyHookThread, &installed);
+    s_keyThreadId = ::GetThreadId(s_keyThread.native_handle());
+    if (!result.get()) {
+        UnwatchKeys();
+        return false;
+    }
+    return true;
+}
+
+void Win32WindowSystem::UnwatchKeys() {
+    if (s_keyThread.joinable()) {
+        ::PostThreadMessageW(s_keyThreadId, WM_QUIT, 0, 0);
+        s_keyThread.join();
+    }
+    s_keyThreadId = 0;
+    s_keysLive.store(false);
+    while (s_keyRing.TryPop([](KeyRecord&) {})) {}
+    s_keyProc = nullptr;
+    s_keyCtx = nullptr;
+}
+
+bool Win32WindowSystem::KeysLive() { return s_keysLive.load(std::memory_order_relaxed); }
+
+void Win32WindowSystem::WaitEvents(DWORD timeoutMs) {
+    // WinEvents arrive as messages and the key hook thread sets the event.
+    ::MsgWaitForMultipleObjectsEx(1, &s_wakeEvent, timeoutMs, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+}
+
+void Win32WindowSystem::Wake() { ::SetEvent(s_wakeEvent); }
+
+UINT Win32WindowSystem::WakeMessage() {
+    static const UINT message = ::RegisterWindowMessageW(L"LS_ReShade.ApplyMutations");
+    return message;
+}
+
+bool Win32WindowSystem::PostWake(HWND hwnd) { return ::PostMessageW(hwnd, WakeMessage(), 0, 0) != FALSE; }
+
+HWND Win32WindowSystem::GetForeground() { return ::GetForegroundWindow(); }
+bool Win32WindowSystem::SetForeground(HWND hwnd) { return ::SetForegroundWindow(hwnd) != FALSE; }
+bool Win32WindowSystem::BringToTop(HWND hwnd) { return ::BringWindowToTop(hwnd) != FALSE; }
+bool Win32WindowSystem::AttachInput(DWORD from, DWORD to, bool attach) { return ::AttachThreadInput(from, to, attach ? TRUE : FALSE) != FALSE; }
+
+LRESULT Win32WindowSystem::CallProc(WNDPROC proc, HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+    return ::CallWindowProc(proc, hwnd, msg, wParam, lParam);
+}
+
+LRESULT Win32WindowSystem::DefProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
+    return ::DefWindowProc(hwnd, msg, wParam, lParam);
+}
+
+bool Win32WindowSystem::IsKeyDown(int vk) { return (::GetAsyncKeyState(vk) & 0x8000) != 0; }
+
+UINT Win32WindowSystem::SendInputs(const InputEvent* events, UINT count) {
+    INPUT inputs[16];
+    UINT sent = 0;
+    while (sent < count) {
+        UINT n = 0;
+        for (; n < 16 && sent + n < count; ++n) {
+            const InputEvent& ev = events[sent + n];
+            INPUT& input = inputs[n];
+            input = {};
+            if (ev.type == InputEvent::Keyboard) {
+                input.type = INPUT_KEYBOARD;
+                input.ki.wVk = ev.vk;
+                input.ki.dwFlags = ev.flags;
+                input.ki.dwExtraInfo = kInputSignature;
+            } else {
+                input.type = INPUT_MOUSE;
+                input.mi.dwFlags = ev.flags;
+                input.mi.dwExtraInfo = kInputSignature;
+            }
+        }
+        UINT ok = ::SendInput(n, inputs, sizeof(INPUT));
+        sent += ok;
+        if (ok != n) break;
+    }
+    return sent;
+}
+
+// Shared system cursor: loaded once, never destroyed.
+static HCURSOR ArrowCursor() {
+    static const HCURSOR arrow = ::LoadCursor(NULL, IDC_ARROW);
+    return arrow;
+}
+
+void Win32WindowSystem::SetArrowCursor() { ::SetCursor(ArrowCursor()); }
+
+bool Win32WindowSystem::IsCursorShowing() {
+    CURSORINFO ci = { sizeof(CURSORINFO) };
+    return !::GetCursorInfo(&ci) || (ci.flags & CURSOR_SHOWING) != 0;
+}
+
+CursorState Win32WindowSystem::QueryCursor() {
+    CursorState state;
+    CURSORINFO ci = { sizeof(CURSORINFO) };
+    if (::GetCursorInfo(&ci)) {
+        state.showing = (ci.flags & CURSOR_SHOWING) != 0;
+        state.arrow = ci.hCursor == ArrowCursor();
+    }
+    // An unclipped cursor reads back as the whole virtual screen.
+    RECT clip;
+    if (::GetClipCursor(&clip)) {
+        int x = ::GetSystemMetrics(SM_XVIRTUALSCREEN);
+        int y = ::GetSystemMetrics(SM_YVIRTUALSCREEN);
+        int cx = ::GetSystemMetrics(SM_CXVIRTUALSCREEN);
+        int cy = ::GetSystemMetrics(SM_CYVIRTUALSCREEN);
+        state.clipped = clip.left > x || clip.top > y || clip.right < x + cx || clip.bottom < y + cy;
+    }
+    return state;
+}
+
+int Win32WindowSystem::ShowCursor(bool show) { return ::ShowCursor(show ? TRUE : FALSE); }
+void Win32WindowSystem::ReleaseCursorClip() { ::ClipCursor(NULL); }
@@ -0,0 +1,53 @@
+#pragma once
+#include "window_system.hpp"
+
+// Production backend: thin forwarding to user32.
+class Win32WindowSystem : public IWindowSystem {
+public:
+    DWORD CurrentProcessId() override;
+    DWORD CurrentThreadId() override;
+    DWORD GetWindowThread(HWND hwnd, DWORD* pid) override;
+
+    void EnumTopLevel(EnumProc proc, void* ctx) override;
+    void EnumChildren(HWND parent, EnumProc proc, void* ctx) override;
+    void EnumThreadTopLevel(DWORD tid, EnumProc proc, void* ctx) override;
+    HWND NextWindow(HWND hwnd) override;
+    bool IsAlive(HWND hwnd) override;
+    bool IsVisible(HWND hwnd) override;
+    int GetClass(HWND hwnd, char* buffer, int size) override;
+    int GetTitle(HWND hwnd, char* buffer, int size) override;
+    int GetProcessName(DWORD pid, char* buffer, int size) override;
+
+    LONG_PTR GetLong(HWND hwnd, int index) override;
+    LONG_PTR SetLong(HWND hwnd, int index, LONG_PTR value) override;
+    bool SetPos(HWND hwnd, HWND insertAfter, UINT flags) override;
+    void ApplyMutations(const WindowMutation* mutations, size_t count) override;
+
+    bool WatchEvents(EventProc proc, void* ctx) override;
+    void UnwatchEvents() override;
+    void PumpEvents() override;
+    bool WatchKeys(KeyProc proc, void* ctx) override;
+    void UnwatchKeys() override;
+    bool KeysLive() override;
+    void WaitEvents(DWORD timeoutMs) override;
+    void Wake() override;
+    bool PostWake(HWND hwnd) override;
+    UINT WakeMessage() override;
+
+    HWND GetForeground() override;
+    bool SetForeground(HWND hwnd) override;
+    bool BringToTop(HWND hwnd) override;
+    bool AttachInput(DWORD from, DWORD to, bool attach) override;
+
+    LRESULT CallProc(WNDPROC proc, HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) override;
+    LRESULT DefProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) override;
+
+    bool IsKeyDown(int vk) override;
+    UINT SendInputs(const InputEvent* events, UINT count) override;
+
+    void SetArrowCursor() override;
+    bool IsCursorShowing() override;
+    CursorState QueryCursor() override;
+    int ShowCursor(bool show) override;
+    void ReleaseCursorClip() override;
+};
@@ -0,0 +1,60 @@
+#include "window_discovery.hpp"
+#include "window_store.hpp"
+#include "window_system.hpp"
+#include <algorithm>
+
+bool WindowDiscovery::Contains(HWND hwnd) const {
+    return std::binary_search(m_current.begin(), m_current.end(), hwnd);
+}
+
+void WindowDiscovery::Reset(HWND root) {
+    m_root = root;
+    m_current.clear();
+    m_topLevel.clear();
+    m_order.clear();
+}
+
+bool WindowDiscovery::CollectChild(HWND hwnd, void* ctx) {
+    WindowDiscovery* self = (WindowDiscovery*)ctx;
+    self->m_next.push_back(hwnd);
+    self->m_order.push_back(hwnd);
+    return true;
+}
+
+bool WindowDiscovery::Scan() {
+    IWindowSystem* sys = g_WindowSystem;
+    m_next.clear();
+    m_order.clear();
+    m_topLevel.clear();
+
+    if (m_root && sys->IsVisible(m_root)) {
+        m_topLevel.push_back(m_root);
+        m_next.push_back(m_root);
+        m_order.push_back(m_root);
+        sys->EnumChildren(m_root, CollectChild, this);
+    }
+
+    std::sort(m_next.begin(), m_next.end());
+    m_next.erase(std::unique(m_next.begin(), m_next.end()), m_next.end());
+
+    // Steady state: identical sorted snapshots.
+    size_t common = std::min(m_next.size(), m_current.size());
+    size_t same = FirstMismatch(m_next.data(), m_current.data(), common);
+    if (same == m_next.size() && same == m_current.size()) return false;
+
+    m_created.clear();
+    m_removed.clear();
+    size_t i = same, j = same;
+    while (i < m_next.size() || j < m_current.size()) {
+        if (j == m_current.size() || (i < m_next.size() && m_next[i] < m_current[j])) {
+            m_created.push_back(m_next[i++]);
+        } else if (i == m_next.size() || m_current[j] < m_next[i]) {
+            m_removed.push_back(m_current[j++]);
+        } else {
+            ++i;
+            ++j;
+        }
+    }
+    m_current.swap(m_next);
+    return true;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "platform.hpp"
+#include <cstdint>
+#include <vector>
+
+// Finds one LS window (a visible top-level window of this process) and all
+// its descendants, and diffs each pass against the previous one. Each
+// session scans only its own window tree, so a pass costs the windows of
+// that LS window, not those of the desktop or of the other sessions.
+class WindowDiscovery {
+public:
+    // Starts over with `root` (nullptr: finds nothing).
+    void Reset(HWND root = nullptr);
+
+    // Returns false when the window set is unchanged (the steady state).
+    // Otherwise Created()/Removed() hold the sorted differences.
+    bool Scan();
+
+    HWND Root() const { return m_root; }
+    const std::vector<HWND>& Current() const { return m_current; }   // sorted
+    const std::vector<HWND>& Order() const { return m_order; }       // enumeration order
+    const std::vector<HWND>& TopLevel() const { return m_topLevel; } // the root, while visible
+    const std::vector<HWND>& Created() const { return m_created; }
+    const std::vector<HWND>& Removed() const { return m_removed; }
+    bool Contains(HWND hwnd) const;
+
+private:
+    static bool CollectChild(HWND hwnd, void* ctx);
+
+    HWND m_root = nullptr;
+    std::vector<HWND> m_current;
+    std::vector<HWND> m_next;
+    std::vector<HWND> m_order;
+    std::vector<HWND> m_topLevel;
+    std::vector<HWND> m_created;
+    std::vector<HWND> m_removed;
+};
@@ -0,0 +1,612 @@
+#include "window_manager.hpp"
+#include "window_system.hpp"
+#include "settings.hpp"
+#include "logger.hpp"
+#include "metrics.hpp"
+#include "cursor_manager.hpp"
+#include "window_mutations.hpp"
+#include "restore_journal.hpp"
+#include "window_rules.hpp"
+#include "trace_recorder.hpp"
+#include <algorithm>
+#include <array>
+
+namespace {
+    // Rows re-read per pass to catch restyles of child windows; top-level
+    // windows are re-read every pass.
+    const int kRevalidatePerPass = 4;
+    // What makes a window click-through; stripped while passthrough is on.
+    const LONG_PTR kClickThroughExStyles = WS_EX_TRANSPARENT | WS_EX_NOACTIVATE | WS_EX_LAYERED;
+    // How long a restore waits for owner threads before restoring itself.
+    const uint32_t kRestoreWaitMs = 250;
+
+    // SetWindowLongPtr, counted for the metrics panel. Only for the window
+    // procedure, which sends no message; everything else goes through
+    // g_Mutations.
+    LONG_PTR SetLongCounted(IWindowSystem* sys, HWND hwnd, int index, LONG_PTR value) {
+        g_Metrics.setLongCalls.fetch_add(1, std::memory_order_relaxed);
+        return sys->SetLong(hwnd, index, value);
+    }
+
+    // Puts back what the journal says was changed on one window; the proc
+    // only when `restoreProc` (it is still ours to replace).
+    WindowMutation RestoreMutation(const RestoreJournal::Entry& e, bool restoreProc) {
+        WindowMutation m;
+        m.hwnd = e.hwnd;
+        if (e.changes & (1 << RestoreJournal::Restyled)) {
+            m.ops |= WindowMutation::SetStyles | WindowMutation::Reposition;
+            m.exStyle = e.exStyle;
+            m.style = e.style;
+            m.swpFlags = SWP_NOMOVE | SWP_NOSIZE | SWP_NOZORDER | SWP_FRAMECHANGED;
+        }
+        if (restoreProc && (e.changes & (1 << RestoreJournal::Subclassed))) {
+            m.ops |= WindowMutation::SetProc;
+            m.proc = e.proc;
+        }
+        return m;
+    }
+
+    // What HookProc does with a message. Everything not listed is forwarded
+    // to the original WndProc untouched.
+    enum HookHandler : uint8_t {
+        HookForward,
+        HookCursor,     // WM_SETCURSOR: keep the arrow while passthrough is on
+        HookMouseMove,  // WM_MOUSEMOVE: undo cursor hiding and clipping
+        HookHitTest,    // WM_NCHITTEST: no click-through while passthrough is on
+        HookDestroy,    // WM_NCDESTROY: the window's state can go
+        HookRegistered, // RegisterWindowMessage range: may be the mutation wake
+    };
+
+    // Messages below WM_USER, by number; registered messages are checked at
+    // run time since their numbers are assigned per session.
+    const UINT kHookTableSize = WM_USER;
+
+    constexpr std::array<uint8_t, kHookTableSize> BuildHookTable() {
+        std::array<uint8_t, kHookTableSize> table{};
+        table[WM_SETCURSOR] = HookCursor;
+        table[WM_MOUSEMOVE] = HookMouseMove;
+        table[WM_NCHITTEST] = HookHitTest;
+        table[WM_NCDESTROY] = HookDestroy;
+        return table;
+    }
+
+    constexpr std::array<uint8_t, kHookTableSize> kHookTable = BuildHookTable();
+
+    constexpr uint8_t HookHandlerOf(UINT msg) {
+        return msg < kHookTableSize ? kHookTable[msg] : msg >= 0xC000 ? (uint8_t)HookRegistered : (uint8_t)HookForward;
+    }
+
+    static_assert(HookHandlerOf(WM_NCHITTEST) == HookHitTest && HookHandlerOf(WM_USER) == HookForward, "hook table");
+
+    // The last lookup of this thread: messages come in runs to one window,
+    // so most lookups are answered without touching the table.
+    struct CachedProc {
+        HWND hwnd;
+        WNDPROC proc;
+        uint8_t session;
+        uint32_t generation;
+    };
+    thread_local CachedProc t_lastProc = {};
+
+    // Forwarded messages are counted per thread and added in batches.
+    const uint32_t kForwardBatch = 64;
+    thread_local uint32_t t_forwarded = 0;
+
+    // Our share of a HookProc call, for the histogram and the trace.
+    void RecordHook(HWND hwnd, UINT msg, bool passthrough, uint64_t entered) {
+        uint64_t ns = Metrics::NowNs() - entered;
+        g_Metrics.hookNs.Record(ns);
+        g_Trace.Record(TraceHook, ns, 0, (uint16_t)msg, passthrough, hwnd);
+    }
+}
+
+WindowManager::Shard WindowManager::shards[WindowManager::kMaxSessions];
+ProcTable WindowManager::procs;
+MpscRing<WindowManager::DestroyedWindow, 256> WindowManager::destroyed;
+std::atomic<bool> WindowManager::destroyedOverflow{ false };
+
+bool WindowManager::LookupProc(HWND hwnd, WNDPROC& proc, uint8_t& session) {
+    uint32_t generation = procs.Generation();
+    CachedProc& last = t_lastProc;
+    if (last.hwnd != hwnd || last.generation != generation) {
+        uint8_t found = ProcTable::kNoSession;
+        WNDPROC result = procs.Find(hwnd, &found);
+        if (!result) return false;
+        last = { hwnd, result, found, generation };
+    }
+    proc = last.proc;
+    session = last.session;
+    return true;
+}
+
+LRESULT CALLBACK WindowManager::HookProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
+    // One table load and one branch for the messages we leave alone.
+    const uint8_t handler = HookHandlerOf(uMsg);
+    if (handler == HookForward) return Forward(hwnd, uMsg, wParam, lParam);
+    return HandleMessage(handler, hwnd, uMsg, wParam, lParam);
+}
+
+LRESULT WindowManager::Forward(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
+    IWindowSystem* sys = g_WindowSystem;
+    if (++t_forwarded == kForwardBatch) {
+        g_Metrics.hookMessages.fetch_add(kForwardBatch, std::memory_order_relaxed);
+        t_forwarded = 0;
+    }
+    WNDPROC oldProc;
+    uint8_t session;
+    if (!LookupProc(hwnd, oldProc, session)) {
+        // Fallback if the original WndProc is not known (shouldn't happen often)
+        oldProc = (WNDPROC)sys->GetLong(hwnd, GWLP_WNDPROC);
+        if (oldProc == HookProc) return sys->DefProc(hwnd, uMsg, wParam, lParam);
+    }
+    return sys->CallProc(oldProc, hwnd, uMsg, wParam, lParam);
+}
+
+LRESULT WindowManager::HandleMessage(uint8_t handler, HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam) {
+    IWindowSystem* sys = g_WindowSystem;
+    // 0. Window changes the worker posted to this thread
+    if (handler == HookRegistered) {
+        if (uMsg != sys->WakeMessage()) return Forward(hwnd, uMsg, wParam, lParam);
+        g_Mutations.Drain(sys);
+        return 0;
+    }
+    const uint64_t entered = Metrics::NowNs();
+    g_Metrics.hookMessages.fetch_add(1, std::memory_order_relaxed);
+    // The original WndProc and the session the window belongs to; the
+    // passthrough state is that session's.
+    WNDPROC oldProc = nullptr;
+    uint8_t session = ProcTable::kNoSession;
+    LookupProc(hwnd, oldProc, session);
+    const bool passthrough = session < kMaxSessions ? shards[session].passthrough.load(std::memory_order_relaxed)
+                                                    : g_Settings.Read().inputPassthrough;
+
+    // 1. Handle Cursor Visibility & Clipping (Priority)
+    if (passthrough && (handler == HookCursor || handler == HookMouseMove)) {
+        g_Cursor.Enforce(sys); // only what is known to be wrong
+        if (handler == HookCursor) {
+            RecordHook(hwnd, uMsg, passthrough, entered);
+            return TRUE;
+        }
+    }
+
+    // 2. Fallback if the original WndProc is not known (shouldn't happen often)
+    if (!oldProc) {
+        oldProc = (WNDPROC)sys->GetLong(hwnd, GWLP_WNDPROC);
+        if (oldProc == HookProc) {
+            RecordHook(hwnd, uMsg, passthrough, entered);
+            return sys->DefProc(hwnd, uMsg, wParam, lParam);
+        }
+    }
+
+    // 3. Call Original WndProc (not counted as our time)
+    RecordHook(hwnd, uMsg, passthrough, entered);
+    LRESULT ret = sys->CallProc(oldProc, hwnd, uMsg, wParam, lParam);
+
+    // 4. Fix Click-Through
+    if (passthrough && handler == HookHitTest && ret == HTTRANSPARENT) {
+        return HTCLIENT;
+    }
+
+    // 5. Last message of the window: hand its state back
+    if (handler == HookDestroy) QueueDestroyed(hwnd);
+
+    return ret;
+}
+
+void WindowManager::QueueDestroyed(HWND hwnd) {
+    DestroyedWindow d = { hwnd, 0, ProcTable::kNoSession };
+    if (!procs.Find(hwnd, &d.session, &d.tag)) return;
+    if (t_lastProc.hwnd == hwnd) t_lastProc = {};
+    if (!destroyed.TryPush([&](DestroyedWindow& e) { e = d; })) destroyedOverflow.store(true, std::memory_order_relaxed);
+}
+
+void WindowManager::PlanWindow(uint8_t session, HWND hwnd) {
+    IWindowSystem* sys = g_WindowSystem;
+    Shard& shard = shards[session];
+    if (!shard.passthrough.load(std::memory_order_relaxed)) return;
+
+    LONG_PTR exStyle = sys->GetLong(hwnd, GWL_EXSTYLE);
+    LONG_PTR style = sys->GetLong(hwnd, GWL_STYLE);
+
+    LONG_PTR newExStyle = exStyle & ~kClickThroughExStyles;
+    LONG_PTR newStyle = style & ~WS_DISABLED;
+    bool stylesChanged = (newExStyle != exStyle || newStyle != style);
+
+    bool isNew = false;
+    bool modified, hooked;
+    LONG_PTR originalStyle, originalExStyle;
+    {
+        std::lock_guard<ProfiledMutex> lock(shard.mutex);
+        WindowStore& windows = shard.windows;
+        size_t i = windows.Insert(hwnd);
+        modified = (windows.flags[i] & WindowStore::StylesModified) != 0;
+        hooked = (windows.flags[i] & WindowStore::Subclassed) != 0;
+        // Until we change them, the current styles are the ones LS gave it.
+        originalStyle = modified ? windows.originalStyle[i] : style;
+        originalExStyle = modified ? windows.originalExStyle[i] : exStyle;
+        windows.appliedExStyle[i] = newExStyle;
+        windows.appliedStyle[i] = newStyle;
+    }
+    // Judged on the styles LS gave the window, not on ours.
+    bool isOverlay = g_WindowRules.Classify(hwnd, originalStyle, originalExStyle) == WindowRules::Overlay;
+
+    // 1. Subclassing: every LS window, since any of them may answer
+    // WM_NCHITTEST with HTTRANSPARENT (a plain Static does by default) or
+    // set its own cursor. Messages HookProc does not fix cost one table
+    // lookup before the original WndProc.
+    if (!hooked) {
+        WNDPROC currentProc = (WNDPROC)sys->GetLong(hwnd, GWLP_WNDPROC);
+        if (currentProc != HookProc && !procs.Set(hwnd, currentProc, session)) {
+            LOG_WARN("Proc table full (%zu windows); leaving window %p alone", procs.Size(), (void*)hwnd);
+            return;
+        }
+        {
+            std::lock_guard<ProfiledMutex> lock(shard.mutex);
+            size_t i = shard.windows.Insert(hwnd);
+            shard.windows.flags[i] |= WindowStore::Subclassed;
+            if (currentProc != HookProc) shard.windows.originalProc[i] = currentProc;
+        }
+        if (currentProc != HookProc) {
+            g_Journal.RecordSubclassed(hwnd, currentProc);
+            SetLongCounted(sys, hwnd, GWLP_WNDPROC, (LONG_PTR)HookProc);
+        }
+    }
+
+    // 2. Style Modification
+    bool firstRestyle = false;
+    {
+        std::lock_guard<ProfiledMutex> lock(shard.mutex);
+        WindowStore& windows = shard.windows;
+        size_t i = windows.Insert(hwnd);
+        if (stylesChanged && !(windows.flags[i] & WindowStore::StylesModified)) {
+            windows.originalExStyle[i] = exStyle;
+            windows.originalStyle[i] = style;
+            windows.flags[i] |= WindowStore::StylesModified;
+            firstRestyle = true;
+        }
+        if (!(windows.flags[i] & WindowStore::Activated)) {
+            isNew = true;
+            windows.flags[i] |= WindowStore::Activated;
+        }
+    }
+
+    // Journaled before the change is even planned.
+    if (firstRestyle) g_Journal.RecordRestyled(hwnd, style, exStyle);
+
+    WindowMutation m;
+    m.hwnd = hwnd;
+    if (stylesChanged) {
+        m.ops |= WindowMutation::SetStyles;
+        m.exStyle = newExStyle;
+        m.style = newStyle;
+    }
+    if (stylesChanged || isNew) {
+        if (isOverlay) {
+            m.ops |= WindowMutation::Reposition | WindowMutation::Activate;
+            m.insertAfter = HWND_TOPMOST;
+            m.swpFlags = SWP_NOMOVE | SWP_NOSIZE | SWP_FRAMECHANGED;
+        } else if (stylesChanged) {
+            m.ops |= WindowMutation::Reposition;
+            m.swpFlags = SWP_NOMOVE | SWP_NOSIZE | SWP_FRAMECHANGED | SWP_NOZORDER;
+        }
+    }
+    if (m.ops) g_Mutations.Add(sys->GetWindowThread(hwnd, NULL), m);
+}
+
+void WindowManager::CheckWindow(uint8_t session, HWND hwnd) {
+    IWindowSystem* sys = g_WindowSystem;
+    Shard& shard = shards[session];
+    LONG_PTR proc = sys->GetLong(hwnd, GWLP_WNDPROC);
+    LONG_PTR exStyle = sys->GetLong(hwnd, GWL_EXSTYLE);
+    LONG_PTR style = sys->GetLong(hwnd, GWL_STYLE);
+
+    bool changed = true;
+    {
+        std::lock_guard<ProfiledMutex> lock(shard.mutex);
+        const WindowStore& windows = shard.windows;
+        ptrdiff_t i = windows.Find(hwnd);
+        if (i >= 0) {
+            changed = ((windows.flags[i] & WindowStore::Subclassed) && proc != (LONG_PTR)HookProc) ||
+                      exStyle != windows.appliedExStyle[i] ||
+                      style != windows.appliedStyle[i];
+        }
+    }
+    if (changed) PlanWindow(session, hwnd);
+}
+
+void WindowManager::Forget(uint8_t session, HWND hwnd) {
+    Shard& shard = shards[session];
+    bool known = false;
+    {
+        std::lock_guard<ProfiledMutex> lock(shard.mutex);
+        ptrdiff_t i = shard.windows.Find(hwnd);
+        if (i >= 0) {
+            shard.windows.Erase((size_t)i);
+            known = true;
+        }
+    }
+    procs.Erase(hwnd);
+    // The handle may be reused; its old records must not apply to the new one.
+    if (known) g_Journal.RecordReleased(hwnd);
+}
+
+int WindowManager::Session(HWND lsWindow) {
+    if (!lsWindow) return -1;
+    int free = -1;
+    for (size_t i = 0; i < kMaxSessions; ++i) {
+        Shard& shard = shards[i];
+        if (shard.discovery.Root() == lsWindow) return (int)i;
+        // A session that is off keeps no windows; its slot can be reused.
+        if (free < 0 && !shard.passthrough.load(std::memory_order_relaxed) && shard.windows.Size() == 0) free = (int)i;
+    }
+    if (free >= 0) {
+        shards[free].discovery.Reset(lsWindow);
+        shards[free].revalidateCursor = 0;
+    }
+    return free;
+}
+
+bool WindowManager::Passthrough(int session) {
+    return session >= 0 && (size_t)session < kMaxSessions && shards[session].passthrough.load(std::memory_order_relaxed);
+}
+
+void WindowManager::SetPassthrough(int session, bool on) {
+    if (session < 0 || (size_t)session >= kMaxSessions) return;
+    Shard& shard = shards[session];
+    if (shard.passthrough.exchange(on) == on || on) return;
+
+    std::vector<HWND> restored;
+    PlanRestore((uint8_t)session, restored);
+    LOG_INFO("Restoring %zu windows of session %d...", restored.size(), session);
+    // The window procedures must be back before the procs are dropped;
+    // Flush puts them back itself if an owner thread does not respond.
+    g_Mutations.Flush(g_WindowSystem, kRestoreWaitMs);
+    for (HWND hwnd : restored) {
+        procs.Erase(hwnd);
+        g_Journal.RecordReleased(hwnd);
+    }
+}
+
+size_t WindowManager::ActiveSessions() {
+    size_t n = 0;
+    for (const Shard& shard : shards) n += shard.passthrough.load(std::memory_order_relaxed) ? 1 : 0;
+    return n;
+}
+
+void WindowManager::PlanRestore(uint8_t session, std::vector<HWND>& restored) {
+    IWindowSystem* sys = g_WindowSystem;
+    Shard& shard = shards[session];
+    WindowStore windows;
+    {
+        std::lock_guard<ProfiledMutex> lock(shard.mutex);
+        windows.Swap(shard.windows);
+    }
+    shard.discovery.Reset(shard.discovery.Root());
+
+    // The same restore the journal would plan, from the shard's own rows.
+    for (size_t i = 0; i < windows.Size(); ++i) {
+        RestoreJournal::Entry e = {};
+        e.hwnd = windows.hwnd[i];
+        restored.push_back(e.hwnd);
+        if (!sys->IsAlive(e.hwnd)) continue;
+        if (windows.originalProc[i]) {
+            e.changes |= 1 << RestoreJournal::Subclassed;
+            e.proc = windows.originalProc[i];
+        }
+        if (windows.flags[i] & WindowStore::StylesModified) {
+            e.changes |= 1 << RestoreJournal::Restyled;
+            e.style = windows.originalStyle[i];
+            e.exStyle = windows.originalExStyle[i];
+        }
+        bool hooked = sys->GetLong(e.hwnd, GWLP_WNDPROC) == (LONG_PTR)HookProc;
+        WindowMutation m = RestoreMutation(e, hooked);
+        if (m.ops) g_Mutations.Add(sys->GetWindowThread(e.hwnd, NULL), m);
+    }
+}
+
+size_t WindowManager::Refresh() {
+    size_t visited = 0;
+    for (size_t i = 0; i < kMaxSessions; ++i) {
+        if (shards[i].passthrough.load(std::memory_order_relaxed)) visited += RefreshSession((uint8_t)i);
+    }
+    g_Mutations.Flush(g_WindowSystem);
+    return visited;
+}
+
+size_t WindowManager::RefreshSession(uint8_t session) {
+    IWindowSystem* sys = g_WindowSystem;
+    Shard& shard = shards[session];
+    WindowDiscovery& discovery = shard.discovery;
+    size_t visited = 0;
+
+    bool changed = discovery.Scan();
+    // A root that is not visible may be gone with the whole session.
+    if (discovery.TopLevel().empty() && !sys->IsAlive(discovery.Root())) {
+        LOG_INFO("Session %d ended: its LS window is gone", (int)session);
+        SetPassthrough(session, false);
+        discovery.Reset();
+        return 0;
+    }
+
+    if (changed) {
+        const std::vector<HWND>& created = discovery.Created();
+        if (!created.empty()) {
+            {
+                std::lock_guard<ProfiledMutex> lock(shard.mutex);
+                shard.windows.InsertSorted(created.data(), created.size());
+            }
+            // Process in enumeration order (parents first, z-order), as before.
+            for (HWND hwnd : discovery.Order()) {
+                if (std::binary_search(created.begin(), created.end(), hwnd)) {
+                    PlanWindow(session, hwnd);
+                    ++visited;
+                }
+            }
+        }
+        // Gone from the snapshot: hidden, or destroyed (hooked windows were
+        // mostly released on WM_NCDESTROY already). Hidden windows we changed
+        // are kept for restore; the rest hold nothing worth keeping.
+        for (HWND hwnd : discovery.Removed()) {
+            bool changedByUs;
+            {
+                std::lock_guard<ProfiledMutex> lock(shard.mutex);
+                ptrdiff_t i = shard.windows.Find(hwnd);
+                if (i < 0) continue;
+                changedByUs = (shard.windows.flags[i] & (WindowStore::Subclassed | WindowStore::StylesModified)) != 0;
+            }
+            if (!changedByUs || !sys->IsAlive(hwnd)) Forget(session, hwnd);
+        }
+    }
+
+    // Restyle detection. Skipped while posted changes are still pending,
+    // since those windows would read back their old styles.
+    if (!g_Mutations.InFlight()) {
+        for (HWND hwnd : discovery.TopLevel()) CheckWindow(session, hwnd);
+        visited += discovery.TopLevel().size();
+
+        size_t count = discovery.Current().size();
+        for (int n = 0; n < kRevalidatePerPass && (size_t)n < count; ++n) {
+            HWND hwnd = discovery.Current()[shard.revalidateCursor++ % count];
+            CheckWindow(session, hwnd);
+            ++visited;
+        }
+    }
+    return visited;
+}
+
+void WindowManager::RestoreAll() {
+    IWindowSystem* sys = g_WindowSystem;
+    for (Shard& shard : shards) {
+        shard.passthrough.store(false);
+        {
+            std::lock_guard<ProfiledMutex> lock(shard.mutex);
+            shard.windows.Clear();
+        }
+        shard.discovery.Reset(shard.discovery.Root());
+    }
+
+    // Only the windows that were actually changed, straight from the journal.
+    std::vector<RestoreJournal::Entry> changed = g_Journal.Pending();
+    LOG_INFO("Restoring %zu windows...", changed.size());
+
+    for (const RestoreJournal::Entry& e : changed) {
+        if (!sys->IsAlive(e.hwnd)) continue;
+
+        // Styles, then the WndProc (applied after the styles, so the owner
+        // thread still routes the wake through HookProc)
+        bool hooked = sys->GetLong(e.hwnd, GWLP_WNDPROC) == (LONG_PTR)HookProc;
+        WindowMutation m = RestoreMutation(e, hooked);
+        if (m.ops) g_Mutations.Add(sys->GetWindowThread(e.hwnd, NULL), m);
+    }
+    // The window procedures must be back before procs is cleared (and
+    // before unload); Flush puts them back itself for a hung owner.
+    g_Mutations.Flush(sys, kRestoreWaitMs);
+
+    procs.Clear();
+    g_Journal.Reset({ sys->CurrentProcessId(), (uint64_t)(uintptr_t)&HookProc });
+}
+
+void WindowManager::OpenJournal(const std::wstring& path) {
+    IWindowSystem* sys = g_WindowSystem;
+    if (!g_Journal.Open(path)) LOG_WARN("Restore journal could not be mapped; keeping it in memory");
+
+    const RestoreJournal::Owner self = { sys->CurrentProcessId(), (uint64_t)(uintptr_t)&HookProc };
+    const RestoreJournal::Owner previous = g_Journal.PreviousOwner();
+    const size_t records = g_Journal.Records();
+    if (records && previous.pid != self.pid) {
+        // That process is gone, and its windows with it.
+        LOG_INFO("Discarding restore journal of process %lu (%zu records)", (unsigned long)previous.pid, records);
+    } else if (records) {
+        // An earlier load in this process never restored. Apply directly:
+        // the old HookProc may no longer be able to take a posted batch.
+        std::vector<RestoreJournal::Entry> stale = g_Journal.Pending();
+        std::vector<WindowMutation> batch;
+        batch.reserve(stale.size());
+        for (const RestoreJournal::Entry& e : stale) {
+            if (!sys->IsAlive(e.hwnd)) continue;
+            DWORD pid = 0;
+            sys->GetWindowThread(e.hwnd, &pid);
+            if (pid != self.pid) continue; // handle reused by another process
+            // The proc only if nobody subclassed on top of the old hook since.
+            bool hooked = (uint64_t)sys->GetLong(e.hwnd, GWLP_WNDPROC) == previous.hook;
+            WindowMutation m = RestoreMutation(e, hooked);
+            if (m.ops) batch.push_back(m);
+        }
+        sys->ApplyMutations(batch.data(), batch.size());
+        LOG_WARN("Replayed restore journal left by an earlier load: %zu of %zu windows", batch.size(), stale.size());
+    }
+    g_Journal.Reset(self);
+}
+
+size_t WindowManager::ReleaseDestroyed() {
+    size_t released = 0;
+    DestroyedWindow d;
+    while (destroyed.TryPop([&](DestroyedWindow& e) { d = e; })) {
+        // Already forgotten (session off, or seen gone by a scan), or the
+        // handle now belongs to a newer window: nothing of it left here.
+        uint32_t tag = 0;
+        if (!procs.Find(d.hwnd, nullptr, &tag) || tag != d.tag) continue;
+        if (d.session < kMaxSessions) {
+            Forget(d.session, d.hwnd);
+        } else {
+            procs.Erase(d.hwnd, d.tag);
+        }
+        ++released;
+    }
+    if (destroyedOverflow.exchange(false, std::memory_order_relaxed)) {
+        LOG_WARN("Destroy notices were dropped; sweeping for dead windows");
+        CleanupDeadWindows();
+    }
+    return released;
+}
+
+void WindowManager::CleanupDeadWindows() {
+    IWindowSystem* sys = g_WindowSystem;
+    for (size_t s = 0; s < kMaxSessions; ++s) {
+        Shard& shard = shards[s];
+        // Windows in the current snapshot were just enumerated, so only rows
+        // missing from it (hidden or stale) need an IsWindow check.
+        const std::vector<HWND>& current = shard.discovery.Current();
+        std::vector<HWND> dead;
+        {
+            std::lock_guard<ProfiledMutex> lock(shard.mutex);
+            const WindowStore& windows = shard.windows;
+            size_t j = 0;
+            for (size_t i = 0; i < windows.Size(); ++i) {
+                HWND hwnd = windows.hwnd[i];
+                while (j < current.size() && current[j] < hwnd) ++j;
+                if (j < current.size() && current[j] == hwnd) continue;
+                if (!sys->IsAlive(hwnd)) dead.push_back(hwnd);
+            }
+        }
+        for (HWND hwnd : dead) Forget((uint8_t)s, hwnd);
+    }
+}
+
+WindowManager::Footprint WindowManager::GetFootprint() {
+    Footprint f = {};
+    for (Shard& shard : shards) {
+        std::lock_guard<ProfiledMutex> lock(shard.mutex);
+        f.rows += shard.windows.Size();
+        f.rowCapacity += shard.windows.hwnd.capacity();
+    }
+    f.procs = procs.Size();
+    f.procCapacity = procs.Capacity();
+    return f;
+}
+
+ProfiledMutex::Stats WindowManager::GetLockStats() {
+    ProfiledMutex::Stats total = {};
+    for (const Shard& shard : shards) {
+        ProfiledMutex::Stats s = shard.mutex.GetStats();
+        total.acquisitions += s.acquisitions;
+        total.waitNs += s.waitNs;
+        total.holdNs += s.holdNs;
+        total.maxHoldNs = std::max(total.maxHoldNs, s.maxHoldNs);
+    }
+    return total;
+}
+
+void WindowManager::ResetLockStats() {
+    for (Shard& shard : shards) shard.mutex.ResetStats();
+}
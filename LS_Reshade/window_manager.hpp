@@ -0,0 +1,109 @@
+#pragma once
+#include "platform.hpp"
+#include "profiled_mutex.hpp"
+#include "mpsc_ring.hpp"
+#include "proc_table.hpp"
+#include "window_discovery.hpp"
+#include "window_store.hpp"
+#include <atomic>
+#include <string>
+#include <vector>
+
+// --- Window Management Helper ---
+// State is kept per session: one LS window (LS opens one per scaled game,
+// e.g. one per monitor) with its own passthrough flag and its own shard of
+// window bookkeeping and lock, so sessions never contend with each other and
+// a pass only touches the windows of the sessions that are on.
+class WindowManager {
+public:
+    static const size_t kMaxSessions = 8;
+
+private:
+    struct Shard {
+        ProfiledMutex mutex;
+        WindowStore windows;
+        WindowDiscovery discovery; // rooted at the session's LS window
+        size_t revalidateCursor = 0;
+        // Read by HookProc for the windows of this shard.
+        std::atomic<bool> passthrough{ false };
+    };
+
+    static Shard shards[kMaxSessions];
+    // Lock-free mirror of WindowStore::originalProc read by HookProc, tagged
+    // with each window's session. Written only by the worker, alongside the
+    // shards.
+    static ProcTable procs;
+
+    // Windows HookProc saw WM_NCDESTROY for, with the tag of their procs
+    // entry; the worker releases them on its next tick. Filled on the UI
+    // thread, so it only ever queues.
+    struct DestroyedWindow {
+        HWND hwnd;
+        uint32_t tag;
+        uint8_t session;
+    };
+    static MpscRing<DestroyedWindow, 256> destroyed;
+    // Set when the queue was full: the worker then sweeps instead.
+    static std::atomic<bool> destroyedOverflow;
+    static void QueueDestroyed(HWND hwnd);
+
+    // Custom Window Procedure: a table lookup on the message number sends
+    // everything but the few messages it fixes straight to Forward.
+    static LRESULT CALLBACK HookProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
+    static LRESULT Forward(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
+    static LRESULT HandleMessage(uint8_t handler, HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
+    // The original WndProc and session of `hwnd`, through a per-thread cache.
+    static bool LookupProc(HWND hwnd, WNDPROC& proc, uint8_t& session);
+
+    // Plans the style fix for one window (subclassing happens at once, the
+    // rest goes to g_Mutations for the end of the pass).
+    static void PlanWindow(uint8_t session, HWND hwnd);
+    static void CheckWindow(uint8_t session, HWND hwnd);
+    static void Forget(uint8_t session, HWND hwnd);
+    static size_t RefreshSession(uint8_t session);
+    // Queues the restore of every window the session changed, drops its
+    // rows and lists them in `restored`; the caller flushes.
+    static void PlanRestore(uint8_t session, std::vector<HWND>& restored);
+
+public:
+    // The session of LS window `lsWindow`, assigned on first use; -1 when
+    // every session is taken. Worker thread only.
+    static int Session(HWND lsWindow);
+    static bool Passthrough(int session);
+    // Turning a session off restores its windows (done when it returns);
+    // the other sessions are not touched.
+    static void SetPassthrough(int session, bool on);
+    static size_t ActiveSessions();
+
+    // Per active tick: rescans the sessions that are on, then style-fixes
+    // (subclass, strip click-through styles, raise overlays) only the windows
+    // that appeared or were restyled since the last pass, as one batch per
+    // owner thread. Sessions whose LS window was destroyed are dropped.
+    // Returns the number of windows processed or re-checked.
+    static size_t Refresh();
+    // Turns every session off and undoes every change recorded in g_Journal,
+    // batched the same way; done when it returns.
+    static void RestoreAll();
+    // Maps the restore journal at `path` and first puts back any windows an
+    // earlier load in this process left changed (crash or missed shutdown).
+    static void OpenJournal(const std::wstring& path);
+    // Drops the state of the windows destroyed since the last call, one
+    // table erase each. Every tick, whether or not a session is on, so no
+    // handle can be reused before its old state is gone. Returns how many.
+    static size_t ReleaseDestroyed();
+    // Full IsWindow sweep of the rows missing from the last scans; only
+    // needed when destroy notices were lost (queue full).
+    static void CleanupDeadWindows();
+
+    // Rows over all shards (and the room their columns hold) and entries
+    // in the proc table (and its fixed capacity).
+    struct Footprint {
+        size_t rows, rowCapacity;
+        size_t procs, procCapacity;
+    };
+    static Footprint GetFootprint();
+
+    // Summed over the shards.
+    static ProfiledMutex::Stats GetLockStats();
+    static void ResetLockStats();
+};
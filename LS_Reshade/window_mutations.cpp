@@ -0,0 +1,166 @@
+#include "window_mutations.hpp"
+#include "metrics.hpp"
+#include "logger.hpp"
+#include "trace_recorder.hpp"
+#include <algorithm>
+#include <chrono>
+
+MutationDispatcher g_Mutations;
+
+void MutationDispatcher::Add(DWORD tid, const WindowMutation& mutation) {
+    if (!mutation.ops) return;
+    m_plan.push_back({ tid, mutation });
+    if (mutation.ops & WindowMutation::SetStyles) g_Metrics.setLongCalls.fetch_add(2, std::memory_order_relaxed);
+    if (mutation.ops & WindowMutation::SetProc) g_Metrics.setLongCalls.fetch_add(1, std::memory_order_relaxed);
+    if (mutation.ops & WindowMutation::Reposition) g_Metrics.setPosCalls.fetch_add(1, std::memory_order_relaxed);
+}
+
+MutationDispatcher::Queue* MutationDispatcher::FindLocked(DWORD tid) {
+    for (Queue& q : m_queues) {
+        if (q.tid == tid) return &q;
+    }
+    return nullptr;
+}
+
+void MutationDispatcher::EraseLocked(DWORD tid) {
+    m_queues.erase(std::remove_if(m_queues.begin(), m_queues.end(), [&](const Queue& q) { return q.tid == tid; }),
+                   m_queues.end());
+    m_inFlight.store(m_queues.size(), std::memory_order_release);
+}
+
+template<typename Pick>
+size_t MutationDispatcher::Reclaim(std::vector<WindowMutation>& out, Pick pick) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t taken = 0, dropped = 0;
+    for (size_t i = 0; i < m_queues.size();) {
+        Queue& q = m_queues[i];
+        if (!q.applying && pick(q)) {
+            for (const WindowMutation& m : q.mutations) {
+                if (m.ops & ~WindowMutation::SetProc) ++dropped;
+                if (!(m.ops & WindowMutation::SetProc)) continue;
+                WindowMutation proc;
+                proc.hwnd = m.hwnd;
+                proc.ops = WindowMutation::SetProc;
+                proc.proc = m.proc;
+                out.push_back(proc);
+            }
+            EraseLocked(q.tid);
+            ++taken;
+        } else {
+            ++i;
+        }
+    }
+    m_reclaimed.fetch_add(taken, std::memory_order_relaxed);
+    m_dropped.fetch_add(dropped, std::memory_order_relaxed);
+    if (dropped) LOG_WARN("Window mutations: dropped %zu changes their owner threads never took", dropped);
+    return taken;
+}
+
+void MutationDispatcher::Flush(IWindowSystem* sys, uint32_t waitMs) {
+    const uint64_t flush = ++m_flushCount;
+    std::vector<WindowMutation> local;
+    // Batches whose owner never came for them.
+    if (InFlight()) {
+        size_t n = Reclaim(local, [&](const Queue& q) { return flush - q.postedAt > kMaxFlushesInFlight; });
+        if (n) LOG_WARN("Window mutations: gave up on %zu stale batches", n);
+    }
+    if (m_plan.empty() && local.empty()) return;
+
+    const uint64_t start = Metrics::NowNs();
+    m_flushes.fetch_add(1, std::memory_order_relaxed);
+    const size_t mutations = m_plan.size() + local.size();
+    m_mutations.fetch_add(m_plan.size(), std::memory_order_relaxed);
+    const DWORD self = sys->CurrentThreadId();
+    std::stable_sort(m_plan.begin(), m_plan.end(), [](const Planned& a, const Planned& b) { return a.tid < b.tid; });
+
+    std::vector<DWORD> posted;
+    for (size_t begin = 0; begin < m_plan.size();) {
+        const DWORD tid = m_plan[begin].tid;
+        size_t end = begin;
+        while (end < m_plan.size() && m_plan[end].tid == tid) ++end;
+
+        if (tid == self || tid == 0) {
+            for (size_t i = begin; i < end; ++i) local.push_back(m_plan[i].mutation);
+            begin = end;
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Queue* q = FindLocked(tid);
+            if (!q) {
+                m_queues.push_back({ tid, {}, flush, false });
+                q = &m_queues.back();
+                m_inFlight.store(m_queues.size(), std::memory_order_release);
+            }
+            if (q->mutations.empty()) q->postedAt = flush;
+            for (size_t i = begin; i < end; ++i) q->mutations.push_back(m_plan[i].mutation);
+        }
+        // One wake per thread and pass, to any of its live windows.
+        bool woke = false;
+        for (size_t i = begin; i < end && !woke; ++i) woke = sys->PostWake(m_plan[i].mutation.hwnd);
+        if (woke) {
+            posted.push_back(tid);
+            m_postedBatches.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            Reclaim(local, [&](const Queue& q) { return q.tid == tid; });
+        }
+        begin = end;
+    }
+    m_plan.clear();
+
+    if (waitMs && !posted.empty()) {
+        auto waiting = [&](const Queue& q) { return std::find(posted.begin(), posted.end(), q.tid) != posted.end(); };
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_drained.wait_for(lock, std::chrono::milliseconds(waitMs), [&] {
+                return std::none_of(m_queues.begin(), m_queues.end(), waiting);
+            });
+        }
+        size_t n = Reclaim(local, waiting);
+        if (n) LOG_WARN("Window mutations: %zu owner threads did not respond in %u ms", n, waitMs);
+    }
+
+    if (!local.empty()) {
+        sys->ApplyMutations(local.data(), local.size());
+        m_inlineBatches.fetch_add(1, std::memory_order_relaxed);
+    }
+    uint64_t ns = Metrics::NowNs() - start;
+    g_Metrics.mutationNs.Record(ns);
+    g_Trace.Record(TraceMutations, ns, (uint32_t)mutations, (uint16_t)posted.size());
+}
+
+void MutationDispatcher::Drain(IWindowSystem* sys) {
+    const DWORD tid = sys->CurrentThreadId();
+    std::vector<WindowMutation> work;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Queue* q = FindLocked(tid);
+        if (!q || q->applying) return;
+        work.swap(q->mutations);
+        q->applying = true;
+    }
+    if (!work.empty()) {
+        const uint64_t start = Metrics::NowNs();
+        sys->ApplyMutations(work.data(), work.size());
+        g_Trace.Record(TraceMutations, Metrics::NowNs() - start, (uint32_t)work.size(), 0, 1);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Queue* q = FindLocked(tid);
+        q->applying = false;
+        // More may have been queued while applying; its wake is on the way.
+        if (q->mutations.empty()) EraseLocked(tid);
+    }
+    m_drained.notify_all();
+}
+
+MutationDispatcher::Stats MutationDispatcher::GetStats() const {
+    Stats s;
+    s.flushes = m_flushes.load(std::memory_order_relaxed);
+    s.mutations = m_mutations.load(std::memory_order_relaxed);
+    s.inlineBatches = m_inlineBatches.load(std::memory_order_relaxed);
+    s.postedBatches = m_postedBatches.load(std::memory_order_relaxed);
+    s.reclaimed = m_reclaimed.load(std::memory_order_relaxed);
+    s.dropped = m_dropped.load(std::memory_order_relaxed);
+    return s;
+}
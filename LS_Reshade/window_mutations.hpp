@@ -0,0 +1,85 @@
+#pragma once
+#include "window_system.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Collects the window changes of one pass and applies them as one batch per
+// owner thread. Changes to the caller's own windows are applied in place;
+// every other owner thread gets its share queued here and a single posted
+// wake, and applies it from HookProc (Drain) on its own thread. The worker
+// therefore never waits on another thread's message loop, which is what
+// SetWindowLongPtr(GWL_STYLE) and SetWindowPos do from the wrong thread.
+class MutationDispatcher {
+public:
+    // A posted batch still waiting after this many flushes is given up on
+    // (its owner is gone or hung); see Flush.
+    static const uint32_t kMaxFlushesInFlight = 50;
+
+    struct Stats {
+        uint64_t flushes;
+        uint64_t mutations;
+        uint64_t inlineBatches;
+        uint64_t postedBatches;
+        uint64_t reclaimed; // posted batches given up on
+        uint64_t dropped;   // style, position and activation changes they lost
+    };
+
+    // Plans a change for the current pass; `tid` is the window's owner.
+    void Add(DWORD tid, const WindowMutation& mutation);
+    bool Empty() const { return m_plan.empty(); }
+
+    // Applies the pass. With `waitMs`, waits up to that long for the owner
+    // threads. Batches an owner has not taken by then (or within
+    // kMaxFlushesInFlight flushes) are given up on: their style, position
+    // and activation changes are dropped and logged, since applying them
+    // here would block on that owner. Only their window procedure changes
+    // are made by the flushing thread; those send no messages, and HookProc
+    // must not outlive the proc table. A batch its owner has started
+    // applying is left to it. Records the time spent in g_Metrics.mutationNs.
+    void Flush(IWindowSystem* sys, uint32_t waitMs = 0);
+    // Called on WakeMessage(): applies what is queued for this thread.
+    void Drain(IWindowSystem* sys);
+    // True while posted batches are waiting to be applied.
+    bool InFlight() const { return m_inFlight.load(std::memory_order_acquire) != 0; }
+
+    Stats GetStats() const;
+
+private:
+    struct Planned {
+        DWORD tid;
+        WindowMutation mutation;
+    };
+    struct Queue {
+        DWORD tid;
+        std::vector<WindowMutation> mutations;
+        uint64_t postedAt; // flush number of the oldest waiting mutation
+        bool applying;
+    };
+
+    Queue* FindLocked(DWORD tid);
+    void EraseLocked(DWORD tid);
+    // Takes every waiting batch whose tid matches `pick` (and is not being
+    // applied right now); only their SetProc parts go to `out`.
+    template<typename Pick>
+    size_t Reclaim(std::vector<WindowMutation>& out, Pick pick);
+
+    std::vector<Planned> m_plan; // flushing thread only
+    uint64_t m_flushCount = 0;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_drained;
+    std::vector<Queue> m_queues;
+    std::atomic<size_t> m_inFlight{ 0 };
+
+    std::atomic<uint64_t> m_flushes{ 0 };
+    std::atomic<uint64_t> m_mutations{ 0 };
+    std::atomic<uint64_t> m_inlineBatches{ 0 };
+    std::atomic<uint64_t> m_postedBatches{ 0 };
+    std::atomic<uint64_t> m_reclaimed{ 0 };
+    std::atomic<uint64_t> m_dropped{ 0 };
+};
+
+extern MutationDispatcher g_Mutations;
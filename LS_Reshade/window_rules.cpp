@@ -0,0 +1,326 @@
+#include "window_rules.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+WindowRules g_WindowRules;
+
+namespace {
+    // Appended after the configured rules: the shell windows that are never
+    // the scaled game, and the LS overlays (click-through or non-activating).
+    const char* const kDefaults[] = {
+        "ignore class=Progman",
+        "ignore class=Shell_TrayWnd",
+        "ignore class=WorkerW",
+        "overlay process=self exstyle~0x08080020",
+    };
+
+    std::string Lower(const char* s, size_t n) {
+        std::string out(s, n);
+        for (char& c : out) {
+            if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+        }
+        return out;
+    }
+    std::string Lower(const std::string& s) { return Lower(s.data(), s.size()); }
+
+    // Splits on blanks; a value may be quoted: title="Picture in picture".
+    std::vector<std::string> Tokens(const std::string& spec) {
+        std::vector<std::string> out;
+        std::string token;
+        bool quoted = false;
+        for (char c : spec) {
+            if (c == '"') { quoted = !quoted; continue; }
+            if (!quoted && (c == ' ' || c == '\t')) {
+                if (!token.empty()) out.push_back(token);
+                token.clear();
+                continue;
+            }
+            token.push_back(c);
+        }
+        if (!token.empty()) out.push_back(token);
+        return out;
+    }
+
+    bool StylesMatch(LONG_PTR value, LONG_PTR all, LONG_PTR any, LONG_PTR none) {
+        return (value & all) == all && (!any || (value & any)) && !(value & none);
+    }
+
+    // Counters have one writer (the classifying thread): no locked add.
+    void Count(std::atomic<uint64_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    int LowestBit(uint64_t v) {
+        int n = 0;
+        while (!(v & 1)) { v >>= 1; ++n; }
+        return n;
+    }
+}
+
+WindowRules::WindowRules() {
+    Build({}, m_compiled, nullptr);
+}
+
+// --- Compile ---
+
+bool WindowRules::ParseRule(const std::string& spec, Rule& rule, std::string* error) {
+    rule = Rule();
+    rule.processSelf = -1;
+    std::vector<std::string> tokens = Tokens(spec);
+    auto fail = [&](const std::string& why) {
+        if (error) *error = "\"" + spec + "\": " + why;
+        return false;
+    };
+    if (tokens.empty()) return fail("empty rule");
+
+    std::string action = Lower(tokens[0]);
+    if (action == "ignore") rule.verdict = Ignore;
+    else if (action == "overlay") rule.verdict = Overlay;
+    else if (action == "plain") rule.verdict = Plain;
+    else return fail("unknown action '" + tokens[0] + "'");
+
+    for (size_t i = 1; i < tokens.size(); ++i) {
+        const std::string& t = tokens[i];
+        size_t op = t.find_first_of("=~!");
+        if (op == std::string::npos || op == 0) return fail("expected key=value, got '" + t + "'");
+        std::string key = Lower(t.substr(0, op));
+        std::string value = t.substr(op + 1);
+        char kind = t[op];
+        if (key == "style" || key == "exstyle") {
+            char* end = nullptr;
+            LONG_PTR mask = (LONG_PTR)strtoull(value.c_str(), &end, 0);
+            if (value.empty() || *end) return fail("bad mask '" + value + "'");
+            bool ex = key == "exstyle";
+            LONG_PTR& slot = kind == '=' ? (ex ? rule.exStyleAll : rule.styleAll)
+                           : kind == '~' ? (ex ? rule.exStyleAny : rule.styleAny)
+                                         : (ex ? rule.exStyleNone : rule.styleNone);
+            slot |= mask;
+            rule.testsStyles = true;
+            continue;
+        }
+        if (kind != '=') return fail("'" + key + "' only takes '='");
+        if (value.empty()) return fail("empty " + key);
+        if (key == "class") {
+            rule.classExact = value.back() != '*';
+            rule.classPrefix = Lower(rule.classExact ? value : value.substr(0, value.size() - 1));
+        } else if (key == "title") {
+            rule.title = Lower(value);
+        } else if (key == "process") {
+            std::string name = Lower(value);
+            if (name == "self") rule.processSelf = 1;
+            else if (name == "other") rule.processSelf = 0;
+            else rule.process = name;
+        } else {
+            return fail("unknown key '" + key + "'");
+        }
+    }
+    return true;
+}
+
+uint32_t WindowRules::Hash(const char* s, size_t n, uint32_t seed) {
+    uint32_t h = 2166136261u ^ (seed * 0x9E3779B9u); // FNV-1a, seeded
+    for (size_t i = 0; i < n; ++i) h = (h ^ (uint8_t)s[i]) * 16777619u;
+    return h ^ (h >> 15);
+}
+
+bool WindowRules::Build(const std::vector<std::string>& specs, Compiled& out, std::string* error) {
+    out = Compiled();
+    out.specs = specs;
+    std::vector<std::string> all = specs;
+    for (const char* d : kDefaults) all.push_back(d);
+    if (all.size() > kMaxRules) {
+        if (error) *error = "too many rules (" + std::to_string(specs.size()) + ")";
+        return false;
+    }
+
+    std::vector<std::string> names;
+    for (size_t i = 0; i < all.size(); ++i) {
+        Rule rule;
+        if (!ParseRule(all[i], rule, error)) return false;
+        const uint64_t bit = 1ull << i;
+        if (rule.classPrefix.empty()) out.anyClassMask |= bit;
+        else if (!rule.classExact) out.prefixRules.push_back(i);
+        else if (std::find(names.begin(), names.end(), rule.classPrefix) == names.end()) names.push_back(rule.classPrefix);
+        out.usesTitle |= !rule.title.empty();
+        out.rules.push_back(rule);
+    }
+
+    // Find a seed that puts every exact class name in its own slot.
+    size_t size = 2;
+    while (size < names.size() * 2) size *= 2;
+    for (;;) {
+        std::vector<std::string> slots(size);
+        uint32_t seed = 0;
+        for (; seed < 256; ++seed) {
+            bool collided = false;
+            for (std::string& slot : slots) slot.clear();
+            for (const std::string& name : names) {
+                std::string& slot = slots[Hash(name.data(), name.size(), seed) & (size - 1)];
+                if (!slot.empty()) { collided = true; break; }
+                slot = name;
+            }
+            if (!collided) break;
+        }
+        if (seed == 256) { size *= 2; continue; }
+        out.seed = seed;
+        out.slotName = slots;
+        out.slotMask.assign(size, 0);
+        for (size_t i = 0; i < out.rules.size(); ++i) {
+            const Rule& rule = out.rules[i];
+            if (!rule.classExact || rule.classPrefix.empty()) continue;
+            out.slotMask[Hash(rule.classPrefix.data(), rule.classPrefix.size(), seed) & (size - 1)] |= 1ull << i;
+        }
+        return true;
+    }
+}
+
+bool WindowRules::Load(const std::vector<std::string>& specs, std::string* error) {
+    Compiled compiled;
+    if (!Build(specs, compiled, error)) return false;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_usesTitle.store(compiled.usesTitle, std::memory_order_relaxed);
+    m_specs = specs;
+    m_staged = std::move(compiled);
+    m_generation.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+std::vector<std::string> WindowRules::Specs() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_specs;
+}
+
+// --- Classify ---
+
+WindowRules::Cached WindowRules::Describe(HWND hwnd) {
+    IWindowSystem* sys = g_WindowSystem;
+    const Compiled& c = m_compiled;
+
+    char buffer[256];
+    int n = sys->GetClass(hwnd, buffer, sizeof(buffer));
+    Count(m_classQueries);
+    std::string cls = Lower(buffer, n > 0 ? (size_t)n : 0);
+    uint64_t mask = c.anyClassMask;
+    size_t slot = Hash(cls.data(), cls.size(), c.seed) & (c.slotName.size() - 1);
+    if (c.slotName[slot] == cls) mask |= c.slotMask[slot];
+    for (size_t i : c.prefixRules) {
+        if (cls.compare(0, c.rules[i].classPrefix.size(), c.rules[i].classPrefix) == 0) mask |= 1ull << i;
+    }
+
+    DWORD pid = 0;
+    sys->GetWindowThread(hwnd, &pid);
+    const bool self = pid == sys->CurrentProcessId();
+    std::string title;
+    bool titleRead = false;
+    for (uint64_t m = mask; m; m &= m - 1) {
+        const int i = LowestBit(m);
+        const Rule& rule = c.rules[i];
+        bool ok = rule.processSelf < 0 || (rule.processSelf == 1) == self;
+        if (ok && !rule.process.empty()) {
+            auto it = m_processNames.find(pid);
+            if (it == m_processNames.end()) {
+                int len = sys->GetProcessName(pid, buffer, sizeof(buffer));
+                it = m_processNames.emplace(pid, Lower(buffer, len > 0 ? (size_t)len : 0)).first;
+            }
+            ok = it->second == rule.process;
+        }
+        if (ok && !rule.title.empty()) {
+            if (!titleRead) {
+                int len = sys->GetTitle(hwnd, buffer, sizeof(buffer));
+                title = Lower(buffer, len > 0 ? (size_t)len : 0);
+                titleRead = true;
+            }
+            ok = title.find(rule.title) != std::string::npos;
+        }
+        if (!ok) mask &= ~(1ull << i);
+    }
+
+    Cached entry = { mask, 0 };
+    for (uint64_t m = mask; m; m &= m - 1) {
+        if (c.rules[LowestBit(m)].testsStyles) entry.styled |= m & (~m + 1);
+    }
+    return entry;
+}
+
+WindowRules::Verdict WindowRules::Decide(const Cached& entry, HWND hwnd, const LONG_PTR* styles) {
+    LONG_PTR fetched[2];
+    for (uint64_t m = entry.mask; m; m &= m - 1) {
+        const uint64_t bit = m & (~m + 1);
+        const Rule& rule = m_compiled.rules[LowestBit(bit)];
+        if (entry.styled & bit) {
+            if (!styles) {
+                fetched[0] = g_WindowSystem->GetLong(hwnd, GWL_STYLE);
+                fetched[1] = g_WindowSystem->GetLong(hwnd, GWL_EXSTYLE);
+                styles = fetched;
+            }
+            if (!StylesMatch(styles[0], rule.styleAll, rule.styleAny, rule.styleNone) ||
+                !StylesMatch(styles[1], rule.exStyleAll, rule.exStyleAny, rule.exStyleNone)) continue;
+        }
+        return rule.verdict;
+    }
+    return Default;
+}
+
+void WindowRules::Sync() {
+    if (m_generation.load(std::memory_order_acquire) != m_adopted) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_adopted = m_generation.load(std::memory_order_relaxed);
+        m_compiled = m_staged;
+        m_cache.clear();
+        m_processNames.clear();
+    }
+    if (m_staleOverflow.load(std::memory_order_relaxed) && m_staleOverflow.exchange(false, std::memory_order_acquire)) {
+        m_cache.clear();
+    }
+    HWND stale;
+    while (m_stale.TryPop([&](HWND& h) { stale = h; })) {
+        if (m_cache.erase(stale)) Count(m_invalidations);
+    }
+}
+
+WindowRules::Cached WindowRules::Entry(HWND hwnd) {
+    Sync();
+    Count(m_lookups);
+    auto it = m_cache.find(hwnd);
+    if (it != m_cache.end()) {
+        Count(m_hits);
+        return it->second;
+    }
+    if (m_cache.size() >= kMaxCached) m_cache.clear();
+    Cached entry = Describe(hwnd);
+    m_cache.emplace(hwnd, entry);
+    return entry;
+}
+
+WindowRules::Verdict WindowRules::Classify(HWND hwnd) {
+    return Decide(Entry(hwnd), hwnd, nullptr);
+}
+
+WindowRules::Verdict WindowRules::Classify(HWND hwnd, LONG_PTR style, LONG_PTR exStyle) {
+    const LONG_PTR styles[2] = { style, exStyle };
+    return Decide(Entry(hwnd), hwnd, styles);
+}
+
+void WindowRules::ForgetWindows() {
+    m_cache.clear();
+}
+
+bool WindowRules::OnWindowEvent(WindowEvent event, HWND hwnd) {
+    if (event != WindowEventDestroy && event != WindowEventNameChange) return false;
+    if (event == WindowEventNameChange && !m_usesTitle.load(std::memory_order_relaxed)) return false;
+    if (!m_stale.TryPush([&](HWND& h) { h = hwnd; })) m_staleOverflow.store(true, std::memory_order_release);
+    return event == WindowEventNameChange;
+}
+
+WindowRules::Stats WindowRules::GetStats() const {
+    return { m_lookups.load(std::memory_order_relaxed), m_hits.load(std::memory_order_relaxed),
+             m_classQueries.load(std::memory_order_relaxed), m_invalidations.load(std::memory_order_relaxed) };
+}
+
+void WindowRules::ResetStats() {
+    m_lookups.store(0, std::memory_order_relaxed);
+    m_hits.store(0, std::memory_order_relaxed);
+    m_classQueries.store(0, std::memory_order_relaxed);
+    m_invalidations.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,135 @@
+#pragma once
+#include "platform.hpp"
+#include "window_system.hpp"
+#include "mpsc_ring.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// --- Window Classification ---
+// Ordered rules deciding which windows can be the scaled target and which LS
+// windows are overlays. One rule per line, from the [Rules] section of
+// config.ini, ahead of the built-in defaults; the first rule that matches
+// wins:
+//
+//   <action> [class=NAME|PREFIX*] [title=TEXT] [process=EXE|self|other]
+//            [style=MASK] [exstyle=MASK]
+//
+// action: ignore (never the target), overlay (raised and activated like the
+// LS overlay), plain (neither). class and process are case-insensitive;
+// title matches a case-insensitive substring. For the style masks, "=" needs
+// all bits, "~" any bit and "!" none, e.g. "overlay exstyle~0x80020".
+//
+// Rules compile into per-class rule masks behind a perfect hash of the class
+// names, and each window's class, title and process are looked up once: the
+// mask of rules they satisfy is cached per HWND until the window is destroyed,
+// renamed or the rules change, so a rescan queries nothing but styles.
+//
+// The cache belongs to the one thread that classifies (the worker) and is
+// read without a lock. Load() stages new rules for that thread to pick up,
+// and window events queue their HWND in a ring it drains, so both may come
+// from any thread. Without window events, call ForgetWindows() before each
+// pass: a reused handle would otherwise keep its old verdict.
+class WindowRules {
+public:
+    enum Verdict : uint8_t { Default, Ignore, Overlay, Plain };
+    static const size_t kMaxRules = 64;
+    // Cached windows beyond this are dropped wholesale.
+    static const size_t kMaxCached = 8192;
+
+    struct Stats {
+        uint64_t lookups;
+        uint64_t hits;
+        uint64_t classQueries; // GetClass calls made
+        uint64_t invalidations;
+    };
+
+    WindowRules();
+
+    // Compiles `specs` ahead of the defaults; the classifying thread swaps
+    // them in (dropping the cache) on its next Classify. On a bad line
+    // nothing changes and `error` names it. Any thread.
+    bool Load(const std::vector<std::string>& specs, std::string* error = nullptr);
+    // The lines last loaded (not the defaults). Any thread.
+    std::vector<std::string> Specs() const;
+
+    // Classifying thread only. Styles are read only when a candidate rule
+    // tests them.
+    Verdict Classify(HWND hwnd);
+    Verdict Classify(HWND hwnd, LONG_PTR style, LONG_PTR exStyle);
+    // Classifying thread only: drops every cached window.
+    void ForgetWindows();
+
+    // Queues what an event made stale; any thread. True if a classification
+    // of `hwnd` may have changed (a rename, with title rules loaded).
+    bool OnWindowEvent(WindowEvent event, HWND hwnd);
+    Stats GetStats() const;
+    void ResetStats();
+
+private:
+    struct Rule {
+        Verdict verdict;
+        std::string classPrefix; // lower case; "" = any (exact names live in the hash)
+        bool classExact;
+        std::string title;       // lower case; "" = any
+        std::string process;     // lower case exe name; "" = any
+        int processSelf;         // 1 self, 0 other, -1 any
+        LONG_PTR styleAll, styleAny, styleNone;
+        LONG_PTR exStyleAll, exStyleAny, exStyleNone;
+        bool testsStyles;
+    };
+
+    struct Compiled {
+        std::vector<Rule> rules;
+        std::vector<std::string> specs;
+        // Perfect hash of the exact class names: slot = hash(name, seed) &
+        // (size - 1) is unique per name; the slot holds its rule mask.
+        uint32_t seed = 0;
+        std::vector<std::string> slotName;
+        std::vector<uint64_t> slotMask;
+        uint64_t anyClassMask = 0; // rules without a class condition
+        std::vector<size_t> prefixRules;
+        bool usesTitle = false;
+    };
+
+    struct Cached {
+        uint64_t mask;   // rules whose class, title and process conditions hold
+        uint64_t styled; // of those, the ones that also test styles
+    };
+
+    static bool ParseRule(const std::string& spec, Rule& rule, std::string* error);
+    static bool Build(const std::vector<std::string>& specs, Compiled& out, std::string* error);
+    static uint32_t Hash(const char* s, size_t n, uint32_t seed);
+
+    // Takes staged rules and queued invalidations; then the window's cache
+    // entry, computed on a miss.
+    void Sync();
+    Cached Entry(HWND hwnd);
+    Cached Describe(HWND hwnd);
+    Verdict Decide(const Cached& entry, HWND hwnd, const LONG_PTR* styles);
+
+    // Classifying thread only.
+    Compiled m_compiled;
+    std::unordered_map<HWND, Cached> m_cache;
+    std::unordered_map<DWORD, std::string> m_processNames;
+    uint32_t m_adopted = 0;
+
+    mutable std::mutex m_mutex; // guards the two below
+    Compiled m_staged;
+    std::vector<std::string> m_specs;
+    std::atomic<uint32_t> m_generation{ 0 };
+    std::atomic<bool> m_usesTitle{ false };
+    MpscRing<HWND, 256> m_stale;
+    std::atomic<bool> m_staleOverflow{ false };
+
+    std::atomic<uint64_t> m_lookups{ 0 };
+    std::atomic<uint64_t> m_hits{ 0 };
+    std::atomic<uint64_t> m_classQueries{ 0 };
+    std::atomic<uint64_t> m_invalidations{ 0 };
+};
+
+extern WindowRules g_WindowRules;
@@ -0,0 +1,126 @@
+#include "window_store.hpp"
+#include <algorithm>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LS_HAVE_SSE2 1
+#endif
+
+namespace {
+    template<typename T>
+    void InsertAt(std::vector<T>& column, size_t index, const T& value) {
+        column.insert(column.begin() + index, value);
+    }
+
+    template<typename T>
+    void EraseAt(std::vector<T>& column, size_t index) {
+        column.erase(column.begin() + index);
+    }
+
+    // Backward in-place merge of `count` zero rows at the positions given by
+    // `slots` (ascending, already adjusted for the final layout).
+    template<typename T>
+    void SpreadColumn(std::vector<T>& column, size_t oldSize, const std::vector<size_t>& slots) {
+        column.resize(oldSize + slots.size());
+        size_t src = oldSize;
+        size_t dst = column.size();
+        for (size_t k = slots.size(); k-- > 0;) {
+            size_t slot = slots[k];
+            while (dst > slot + 1) column[--dst] = column[--src];
+            column[--dst] = T();
+        }
+    }
+}
+
+ptrdiff_t WindowStore::Find(HWND h) const {
+    auto it = std::lower_bound(hwnd.begin(), hwnd.end(), h);
+    if (it == hwnd.end() || *it != h) return -1;
+    return it - hwnd.begin();
+}
+
+size_t WindowStore::Insert(HWND h) {
+    auto it = std::lower_bound(hwnd.begin(), hwnd.end(), h);
+    size_t index = it - hwnd.begin();
+    if (it != hwnd.end() && *it == h) return index;
+    InsertAt(hwnd, index, h);
+    InsertAt(originalProc, index, (WNDPROC)nullptr);
+    InsertAt(originalStyle, index, (LONG_PTR)0);
+    InsertAt(originalExStyle, index, (LONG_PTR)0);
+    InsertAt(appliedStyle, index, (LONG_PTR)0);
+    InsertAt(appliedExStyle, index, (LONG_PTR)0);
+    InsertAt(flags, index, (uint8_t)0);
+    return index;
+}
+
+void WindowStore::InsertSorted(const HWND* handles, size_t count) {
+    if (count == 0) return;
+    // Final row index of each new handle.
+    std::vector<size_t> slots;
+    slots.reserve(count);
+    std::vector<HWND> added;
+    added.reserve(count);
+    size_t i = 0;
+    for (size_t k = 0; k < count; ++k) {
+        while (i < hwnd.size() && hwnd[i] < handles[k]) ++i;
+        if (i < hwnd.size() && hwnd[i] == handles[k]) continue;
+        slots.push_back(i + slots.size());
+        added.push_back(handles[k]);
+    }
+    if (slots.empty()) return;
+
+    size_t oldSize = hwnd.size();
+    SpreadColumn(hwnd, oldSize, slots);
+    for (size_t k = 0; k < slots.size(); ++k) hwnd[slots[k]] = added[k];
+    SpreadColumn(originalProc, oldSize, slots);
+    SpreadColumn(originalStyle, oldSize, slots);
+    SpreadColumn(originalExStyle, oldSize, slots);
+    SpreadColumn(appliedStyle, oldSize, slots);
+    SpreadColumn(appliedExStyle, oldSize, slots);
+    SpreadColumn(flags, oldSize, slots);
+}
+
+void WindowStore::Erase(size_t index) {
+    EraseAt(hwnd, index);
+    EraseAt(originalProc, index);
+    EraseAt(originalStyle, index);
+    EraseAt(originalExStyle, index);
+    EraseAt(appliedStyle, index);
+    EraseAt(appliedExStyle, index);
+    EraseAt(flags, index);
+}
+
+void WindowStore::Clear() {
+    hwnd.clear();
+    originalProc.clear();
+    originalStyle.clear();
+    originalExStyle.clear();
+    appliedStyle.clear();
+    appliedExStyle.clear();
+    flags.clear();
+}
+
+void WindowStore::Swap(WindowStore& other) {
+    hwnd.swap(other.hwnd);
+    originalProc.swap(other.originalProc);
+    originalStyle.swap(other.originalStyle);
+    originalExStyle.swap(other.originalExStyle);
+    appliedStyle.swap(other.appliedStyle);
+    appliedExStyle.swap(other.appliedExStyle);
+    flags.swap(other.flags);
+}
+
+size_t FirstMismatch(const HWND* a, const HWND* b, size_t n) {
+    size_t i = 0;
+#ifdef LS_HAVE_SSE2
+    // 16 bytes of handles per compare; movemask is 0xFFFF while all bytes match.
+    const size_t perVector = 16 / sizeof(HWND);
+    for (; i + perVector <= n; i += perVector) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) != 0xFFFF) break;
+    }
+#endif
+    for (; i < n; ++i) {
+        if (a[i] != b[i]) break;
+    }
+    return i;
+}
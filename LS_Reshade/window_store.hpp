@@ -0,0 +1,41 @@
+#pragma once
+#include "platform.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Per-window bookkeeping as a structure of arrays, kept sorted by HWND so it
+// can be merge-walked against a discovery snapshot. Row i of every column
+// describes hwnd[i].
+struct WindowStore {
+    enum Flags : uint8_t {
+        StylesModified = 1 << 0,
+        Activated = 1 << 1,
+        Subclassed = 1 << 2, // runs HookProc
+    };
+
+    std::vector<HWND> hwnd;
+    std::vector<WNDPROC> originalProc;
+    std::vector<LONG_PTR> originalStyle;
+    std::vector<LONG_PTR> originalExStyle;
+    // Styles as last left by ProcessWindow; a mismatch means someone restyled.
+    std::vector<LONG_PTR> appliedStyle;
+    std::vector<LONG_PTR> appliedExStyle;
+    std::vector<uint8_t> flags;
+
+    size_t Size() const { return hwnd.size(); }
+
+    // Index of `h`, or -1.
+    ptrdiff_t Find(HWND h) const;
+    // Index of `h`, inserting a zeroed row if needed.
+    size_t Insert(HWND h);
+    // Merges a sorted, duplicate-free run of handles in one O(n + k) pass.
+    void InsertSorted(const HWND* handles, size_t count);
+    void Erase(size_t index);
+    void Clear();
+    void Swap(WindowStore& other);
+};
+
+// Index of the first position where a[i] != b[i], or n. Vectorized where the
+// target supports it; this is the hot "did anything change?" check.
+size_t FirstMismatch(const HWND* a, const HWND* b, size_t n);
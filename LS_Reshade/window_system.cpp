@@ -0,0 +1,3 @@
+#include "window_system.hpp"
+
+IWindowSystem* g_WindowSystem = nullptr;
@@ -0,0 +1,143 @@
+#pragma once
+#include "platform.hpp"
+#include <cstddef>
+
+// A single synthesized keyboard or mouse event (maps 1:1 onto an INPUT).
+struct InputEvent {
+    enum Type : WORD { Keyboard, Mouse };
+    Type type = Keyboard;
+    WORD vk = 0;
+    DWORD flags = 0;
+};
+
+// Stamped into dwExtraInfo of every event SendInputs synthesizes, so the key
+// watch can tell our own input from that of macro tools and remappers.
+const uintptr_t kInputSignature = 0x4C53524B; // "LSRK"
+
+// What the cursor looks like right now, system-wide.
+struct CursorState {
+    bool showing = true;
+    bool arrow = true;    // the standard arrow is the current cursor
+    bool clipped = false; // confined to less than the whole desktop
+};
+
+// One planned change to a window; see IWindowSystem::ApplyMutations.
+struct WindowMutation {
+    enum Op : uint8_t {
+        SetStyles = 1 << 0,  // GWL_STYLE and GWL_EXSTYLE
+        Reposition = 1 << 1, // SetWindowPos(insertAfter, swpFlags), never moves or sizes
+        Activate = 1 << 2,   // bring to top and take the foreground
+        SetProc = 1 << 3,    // GWLP_WNDPROC
+    };
+    HWND hwnd = nullptr;
+    uint8_t ops = 0;
+    LONG_PTR style = 0;
+    LONG_PTR exStyle = 0;
+    HWND insertAfter = nullptr;
+    UINT swpFlags = 0;
+    WNDPROC proc = nullptr;
+};
+
+// Window-manager events that can change focus or z-order derived state.
+enum WindowEvent {
+    WindowEventForeground,  // EVENT_SYSTEM_FOREGROUND
+    WindowEventZOrder,      // EVENT_OBJECT_REORDER
+    WindowEventVisibility,  // EVENT_OBJECT_SHOW / EVENT_OBJECT_HIDE
+    WindowEventDestroy,     // EVENT_OBJECT_DESTROY
+    WindowEventNameChange,  // EVENT_OBJECT_NAMECHANGE (window title)
+};
+
+// Every window, input and cursor call the core makes goes through this
+// interface, so the same logic runs against Win32 or the in-memory fake.
+// Method names deliberately avoid the Win32 A/W macro names.
+class IWindowSystem {
+public:
+    typedef bool (*EnumProc)(HWND hwnd, void* ctx);
+    typedef void (*EventProc)(WindowEvent event, HWND hwnd, void* ctx);
+    // `injected` is set for input synthesized with SendInputs only; other
+    // programs' synthetic keys are reported like typed ones.
+    typedef void (*KeyProc)(WORD vk, bool down, bool injected, void* ctx);
+    static const DWORD kWaitForever = 0xFFFFFFFF;
+
+    virtual ~IWindowSystem() = default;
+
+    // Identity
+    virtual DWORD CurrentProcessId() = 0;
+    virtual DWORD CurrentThreadId() = 0;
+    virtual DWORD GetWindowThread(HWND hwnd, DWORD* pid) = 0;
+
+    // Enumeration & z-order
+    virtual void EnumTopLevel(EnumProc proc, void* ctx) = 0;
+    virtual void EnumChildren(HWND parent, EnumProc proc, void* ctx) = 0;
+    virtual void EnumThreadTopLevel(DWORD tid, EnumProc proc, void* ctx) = 0;
+    virtual HWND NextWindow(HWND hwnd) = 0;
+    virtual bool IsAlive(HWND hwnd) = 0;
+    virtual bool IsVisible(HWND hwnd) = 0;
+    virtual int GetClass(HWND hwnd, char* buffer, int size) = 0;
+    // Without sending WM_GETTEXT, so it never waits on the owner thread.
+    virtual int GetTitle(HWND hwnd, char* buffer, int size) = 0;
+    // Executable file name of `pid`, without the path.
+    virtual int GetProcessName(DWORD pid, char* buffer, int size) = 0;
+
+    // Window data & placement
+    virtual LONG_PTR GetLong(HWND hwnd, int index) = 0;
+    virtual LONG_PTR SetLong(HWND hwnd, int index, LONG_PTR value) = 0;
+    virtual bool SetPos(HWND hwnd, HWND insertAfter, UINT flags) = 0;
+    // Applies a batch in order of kind: all styles, then the repositions as
+    // one transaction per parent, then activations, then procedures. Style
+    // and position changes send messages to the owner thread, so call this
+    // on that thread (see PostWake) to keep them from blocking.
+    virtual void ApplyMutations(const WindowMutation* mutations, size_t count) = 0;
+
+    // Events. One watcher at a time; returns false if the backend cannot
+    // deliver events (callers must then re-query instead of caching).
+    // Win32 delivers out-of-context, so the watching thread calls PumpEvents.
+    virtual bool WatchEvents(EventProc proc, void* ctx) = 0;
+    virtual void UnwatchEvents() = 0;
+    virtual void PumpEvents() = 0;
+    // Key transitions from a low-level keyboard hook, delivered by
+    // PumpEvents like the window events. Returns false if unavailable
+    // (callers then poll IsKeyDown).
+    virtual bool WatchKeys(KeyProc proc, void* ctx) = 0;
+    virtual void UnwatchKeys() = 0;
+    // False while the watch may be missing transitions (Win32: input went
+    // unreported, so the hook may have been removed; it is reinstalled and
+    // counts as live again once it reports a key). Callers poll meanwhile.
+    virtual bool KeysLive() = 0;
+    // Blocks until an event or message arrives for the calling thread, Wake()
+    // is called (from any thread), or `timeoutMs` passes. A Wake() made
+    // before the wait is not lost.
+    virtual void WaitEvents(DWORD timeoutMs) = 0;
+    virtual void Wake() = 0;
+    // Posts the backend's private WakeMessage() to `hwnd` and returns at
+    // once; the owner thread sees it in the window procedure. False if the
+    // window is gone.
+    virtual bool PostWake(HWND hwnd) = 0;
+    virtual UINT WakeMessage() = 0;
+
+    // Focus
+    virtual HWND GetForeground() = 0;
+    virtual bool SetForeground(HWND hwnd) = 0;
+    virtual bool BringToTop(HWND hwnd) = 0;
+    virtual bool AttachInput(DWORD from, DWORD to, bool attach) = 0;
+
+    // Messages
+    virtual LRESULT CallProc(WNDPROC proc, HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) = 0;
+    virtual LRESULT DefProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) = 0;
+
+    // Input
+    virtual bool IsKeyDown(int vk) = 0;
+    virtual UINT SendInputs(const InputEvent* events, UINT count) = 0;
+
+    // Cursor. QueryCursor only reads, so any thread may poll it; ShowCursor
+    // changes the calling thread's display count.
+    virtual void SetArrowCursor() = 0;
+    virtual bool IsCursorShowing() = 0;
+    virtual CursorState QueryCursor() = 0;
+    virtual int ShowCursor(bool show) = 0;
+    virtual void ReleaseCursorClip() = 0;
+};
+
+// Backend used by the core. Set once at startup (Win32 in the addon, the fake
+// in benchmarks) before the worker starts.
+extern IWindowSystem* g_WindowSystem;
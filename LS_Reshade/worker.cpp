@@ -0,0 +1,305 @@
+#include "worker.hpp"
+#include "window_system.hpp"
+#include "window_manager.hpp"
+#include "focus_resolver.hpp"
+#include "input_sim.hpp"
+#include "input_scheduler.hpp"
+#include "hotkey_engine.hpp"
+#include "settings.hpp"
+#include "logger.hpp"
+#include "metrics.hpp"
+#include "cursor_manager.hpp"
+#include "trace_recorder.hpp"
+#include "control_channel.hpp"
+#include <chrono>
+#include <thread>
+
+// Rebinds the toggle when a new settings snapshot has been published.
+static void SyncHotkey(WorkerState& state, const SettingsSnapshot& config) {
+    if (config.epoch == state.settingsEpoch) return;
+    state.settingsEpoch = config.epoch;
+    HotkeyChord chord;
+    chord.vk = (WORD)config.values.hotkeyVk;
+    chord.mods = (config.values.hotkeyCtrl ? HotkeyChord::ModCtrl : 0) |
+                 (config.values.hotkeyAlt ? HotkeyChord::ModAlt : 0) |
+                 (config.values.hotkeyShift ? HotkeyChord::ModShift : 0);
+    if (state.hotkeyBound && chord.vk == state.hotkey.vk && chord.mods == state.hotkey.mods) return;
+    state.hotkey = chord;
+    state.hotkeyBound = true;
+
+    HotkeyBinding binding;
+    binding.chords[0] = chord;
+    binding.length = 1;
+    binding.action = HotkeyTogglePassthrough;
+    g_Hotkeys.SetBindings(&binding, chord.vk != 0 ? 1 : 0);
+}
+
+// The session of the LS/target pair that has focus; -1 if none.
+static int FocusedSession(const FocusResolver::Pair** pair = nullptr) {
+    const FocusResolver::Pair* focused = g_FocusResolver.FocusedPair();
+    if (pair) *pair = focused;
+    return focused ? WindowManager::Session(focused->lsWindow) : -1;
+}
+
+// Turns a session on or off; its pair is pinned while it is on.
+static void SetSession(int session, const FocusResolver::Pair& pair, bool on) {
+    if (on) g_FocusResolver.Pin(pair.lsWindow, pair.target);
+    else g_FocusResolver.Unpin(pair.lsWindow);
+    WindowManager::SetPassthrough(session, on); // off: restores that session's windows
+    if (on) g_Cursor.Invalidate();
+}
+
+static void RestoreAll() {
+    g_FocusResolver.Unpin(nullptr);
+    WindowManager::RestoreAll();
+}
+
+// Settings keep the aggregate: passthrough is on while any session is.
+static void PublishPassthrough() {
+    bool any = WindowManager::ActiveSessions() != 0;
+    if (g_Settings.Read().inputPassthrough != any) g_Settings.SetPassthrough(any);
+}
+
+// 2. Handle Toggle, for the session that has focus. False if refused: the
+// poller cannot tell our own repress from the user's, and without a valid
+// focus it would only be undone on the next tick.
+static bool Toggle(WorkerState& state, const SettingsSnapshot& config) {
+    if (g_InputScheduler.Guarded() || !g_FocusResolver.HasValidFocus()) return false;
+    const FocusResolver::Pair* pair;
+    int session = FocusedSession(&pair);
+    if (session < 0) return false;
+
+    bool newState = !WindowManager::Passthrough(session);
+    SetSession(session, *pair, newState);
+    PublishPassthrough();
+    g_Trace.Record(TraceToggle, 0, (uint32_t)session, 0, newState);
+    LOG_INFO("Passthrough toggled: %s (session %d)", newState ? "ON" : "OFF", session);
+
+    // Auto Click & Repress Logic: a new toggle replaces the previous
+    // sequence, releasing anything it still holds.
+    if (config.values.autoClickRepress) {
+        const SettingsValues& v = config.values;
+        g_InputScheduler.Cancel(state.toggleSequence);
+        state.toggleSequence = g_InputScheduler.Start(InputSim::ToggleSequence(
+            newState, v.hotkeyVk, v.hotkeyCtrl, v.hotkeyAlt, v.hotkeyShift));
+        state.toggleOn = newState;
+    }
+    return true;
+}
+
+static void FillControlState(ControlState& out) {
+    SettingsSnapshot s = g_Settings.Read();
+    out.epoch = s.epoch;
+    out.hotkeyVk = s.values.hotkeyVk;
+    out.mods = (s.values.hotkeyCtrl ? HotkeyChord::ModCtrl : 0) | (s.values.hotkeyAlt ? HotkeyChord::ModAlt : 0) |
+               (s.values.hotkeyShift ? HotkeyChord::ModShift : 0);
+    out.autoClickRepress = s.values.autoClickRepress;
+    out.passthrough = s.inputPassthrough;
+    out.activeSessions = (uint8_t)WindowManager::ActiveSessions();
+}
+
+static void FillControlMetrics(ControlMetrics& out) {
+    MetricsSnapshot snap;
+    g_Metrics.Collect(snap);
+    out.seconds = snap.seconds;
+    for (size_t i = 0; i < MetricsSnapshot::kDists; ++i) {
+        const Histogram::Summary& d = snap.dists[i].summary;
+        out.dists[i] = { d.count, d.p50, d.p99, d.max };
+    }
+    for (size_t i = 0; i < MetricsSnapshot::kCounts; ++i) out.counts[i] = snap.counts[i].value;
+}
+
+static void ServeControl(WorkerState& state, const SettingsSnapshot& config) {
+    g_Control.Serve([&](const ControlRequest& request, ControlReply& reply) {
+        reply.result = ControlOk;
+        switch (request.command) {
+            case ControlGetState:
+                break;
+            case ControlToggle:
+                if (!Toggle(state, config)) reply.result = ControlRefused;
+                break;
+            case ControlSetPassthrough:
+                if (request.arg > 1) reply.result = ControlInvalid;
+                else if ((request.arg != 0) != WindowManager::Passthrough(FocusedSession()) && !Toggle(state, config)) reply.result = ControlRefused;
+                break;
+            case ControlSetConfig: {
+                if (request.hotkeyVk < 0 || request.hotkeyVk > 0xFF || (request.mods & ~7)) {
+                    reply.result = ControlInvalid;
+                    break;
+                }
+                SettingsValues values;
+                values.hotkeyVk = request.hotkeyVk;
+                values.hotkeyCtrl = (request.mods & HotkeyChord::ModCtrl) != 0;
+                values.hotkeyAlt = (request.mods & HotkeyChord::ModAlt) != 0;
+                values.hotkeyShift = (request.mods & HotkeyChord::ModShift) != 0;
+                values.autoClickRepress = request.autoClickRepress != 0;
+                g_Settings.SetValues(values);
+                g_SettingsStore.MarkDirty();
+                break;
+            }
+            case ControlGetMetrics:
+                FillControlMetrics(reply.metrics);
+                break;
+            default:
+                reply.result = ControlInvalid;
+                break;
+        }
+        FillControlState(reply.state);
+    });
+}
+
+static bool Tick(WorkerState& state, uint64_t nowMs) {
+    IWindowSystem* sys = g_WindowSystem;
+    SettingsSnapshot config = g_Settings.Read();
+    SyncHotkey(state, config);
+    g_Hotkeys.Update(nowMs);
+    sys->PumpEvents();
+    // Windows destroyed since the last tick, before any handle is reused
+    WindowManager::ReleaseDestroyed();
+    g_InputScheduler.Advance(nowMs);
+    if (state.toggleSequence && !g_InputScheduler.Running(state.toggleSequence)) {
+        uint64_t latency = g_InputScheduler.GetStats().lastMs;
+        g_Metrics.toggleLatencyMs.Record(latency);
+        LOG_INFO("Toggle sequence done in %llu ms (fixed delays: %u ms)",
+                 (unsigned long long)latency,
+                 state.toggleOn ? InputSim::kFixedDelayOnMs : InputSim::kFixedDelayOffMs);
+        state.toggleSequence = 0;
+    }
+
+    // 0. Passthrough set from outside (settings UI, shutdown): on means the
+    // session that has focus, off means every session.
+    size_t active = WindowManager::ActiveSessions();
+    if (config.inputPassthrough && active == 0) {
+        const FocusResolver::Pair* pair;
+        int session = FocusedSession(&pair);
+        if (session >= 0) {
+            SetSession(session, *pair, true);
+        } else {
+            PublishPassthrough(); // nothing to turn on
+        }
+    } else if (!config.inputPassthrough && active != 0) {
+        RestoreAll();
+    }
+
+    // Auto-disable on focus loss: focus is on none of the sessions
+    if (WindowManager::ActiveSessions() != 0) {
+        if (!g_FocusResolver.HasValidFocus()) {
+            g_Settings.SetPassthrough(false);
+            LOG_INFO("Passthrough disabled: Focus lost");
+            RestoreAll();
+        }
+    }
+
+    // 1. Hotkey actions (edges were detected as the key events arrived)
+    HotkeyAction action;
+    while (g_Hotkeys.PopAction(action)) {
+        if (action == HotkeyTogglePassthrough) Toggle(state, config);
+    }
+    // ... and requests from other processes
+    ServeControl(state, config);
+
+    // 3. Active Loop (passthrough may have changed above)
+    if (WindowManager::ActiveSessions() != 0) {
+        // Discover and process new or restyled windows of the sessions that are on
+        size_t windows = WindowManager::Refresh();
+        PublishPassthrough(); // a session ends with its LS window
+        g_Metrics.windowsPerTick.Record(windows);
+        g_Trace.Record(TraceRefresh, 0, (uint32_t)windows);
+
+        // Catch re-clips and cursor changes made since the last tick
+        g_Cursor.Revalidate(sys);
+        return true;
+    }
+    return false;
+}
+
+static uint64_t SteadyNowMs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool WorkerTick(WorkerState& state, uint64_t nowMs) {
+    uint64_t start = Metrics::NowNs();
+    bool active = Tick(state, nowMs);
+    uint64_t ns = Metrics::NowNs() - start;
+    g_Metrics.workerTickNs.Record(ns);
+    g_Trace.Record(TraceTick, ns, (uint32_t)nowMs, 0, active);
+    return active;
+}
+
+uint64_t WorkerNextWake(uint64_t nowMs, bool active) {
+    uint64_t wake = kWorkerIdle;
+    if (active) wake = nowMs + 10;
+    else if (!g_Hotkeys.EventDriven()) wake = nowMs + 50; // polling the hotkey
+    // Wake early for the next input step so sequence timing does not
+    // depend on the tick rate.
+    uint64_t due = g_InputScheduler.NextDue();
+    return due < wake ? due : wake;
+}
+
+// --- Worker Runtime ---
+
+WorkerRuntime g_Worker;
+
+bool WorkerRuntime::Start() {
+    std::lock_guard<std::mutex> lock(m_lifecycle);
+    if (m_thread.joinable()) return false;
+    m_stop.store(false, std::memory_order_release);
+    m_loops = 0;
+    m_starts.fetch_add(1, std::memory_order_relaxed);
+    g_Settings.OnChange([] { g_Worker.Notify(); });
+    m_thread = std::thread(&WorkerRuntime::Run, this);
+    return true;
+}
+
+void WorkerRuntime::Stop() {
+    std::lock_guard<std::mutex> lock(m_lifecycle);
+    if (!m_thread.joinable()) return;
+    m_stop.store(true, std::memory_order_release);
+    g_WindowSystem->Wake();
+    m_thread.join();
+    g_Settings.OnChange(nullptr);
+}
+
+bool WorkerRuntime::Running() {
+    std::lock_guard<std::mutex> lock(m_lifecycle);
+    return m_thread.joinable();
+}
+
+void WorkerRuntime::Notify() {
+    // The worker re-reads settings on its next tick anyway.
+    if (m_workerId.load(std::memory_order_relaxed) == std::this_thread::get_id()) return;
+    g_WindowSystem->Wake();
+}
+
+WorkerRuntime::Stats WorkerRuntime::GetStats() const {
+    return { m_starts.load(std::memory_order_relaxed), m_loops.load(std::memory_order_relaxed) };
+}
+
+void WorkerRuntime::Run() {
+    LOG_INFO("Worker thread started");
+    m_workerId = std::this_thread::get_id();
+    IWindowSystem* sys = g_WindowSystem;
+    g_Control.SetServer(sys->CurrentThreadId(), [] { g_Worker.Notify(); });
+    WorkerState state;
+    g_FocusResolver.Start();
+    g_Hotkeys.Start();
+
+    while (!m_stop.load(std::memory_order_acquire)) {
+        uint64_t now = SteadyNowMs();
+        uint64_t wake = WorkerNextWake(now, WorkerTick(state, now));
+        m_loops.fetch_add(1, std::memory_order_relaxed);
+        if (m_stop.load(std::memory_order_acquire)) break;
+        // Key and window events, settings changes and Stop() end the wait
+        // early. A Wake() made since the last wait is not lost.
+        now = SteadyNowMs();
+        if (wake == kWorkerIdle) sys->WaitEvents(IWindowSystem::kWaitForever);
+        else if (wake > now) sys->WaitEvents((DWORD)(wake - now));
+    }
+    g_InputScheduler.CancelAll();
+    g_Hotkeys.Stop();
+    g_FocusResolver.Stop();
+    g_Control.SetServer(0, nullptr);
+    m_workerId = std::thread::id();
+    LOG_INFO("Worker thread stopped");
+}
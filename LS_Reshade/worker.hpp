@@ -0,0 +1,60 @@
+#pragma once
+#include "platform.hpp"
+#include "input_scheduler.hpp"
+#include "hotkey_engine.hpp"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+// --- Main Logic ---
+struct WorkerState {
+    HotkeyChord hotkey = {};
+    bool hotkeyBound = false;
+    uint64_t settingsEpoch = 0; // last settings snapshot applied
+    InputScheduler::Handle toggleSequence = 0;
+    bool toggleOn = false;
+};
+
+// One iteration of the worker loop at `nowMs` (steady clock, or a virtual one
+// in benchmarks). Returns true while passthrough is active.
+bool WorkerTick(WorkerState& state, uint64_t nowMs);
+// When the worker should tick next, or kWorkerIdle when only an event can
+// give it work: active passthrough ticks every 10 ms, the polling hotkey
+// fallback every 50 ms, and pending input steps at their due time.
+const uint64_t kWorkerIdle = ~0ull;
+uint64_t WorkerNextWake(uint64_t nowMs, bool active);
+
+// --- Worker Runtime ---
+// Owns the worker thread. Stop() sets the stop token and wakes the worker's
+// wait, then joins it, so nothing of the worker runs once it returns; Start()
+// after Stop() runs a fresh worker. Settings changes from other threads also
+// end the wait at once, instead of on the next event or timeout.
+class WorkerRuntime {
+public:
+    struct Stats {
+        uint64_t starts;
+        uint64_t loops; // WorkerTick calls of the current worker
+    };
+
+    // False if a worker is already running.
+    bool Start();
+    void Stop();
+    bool Running();
+    // Ends the worker's current wait; no-op from the worker itself.
+    void Notify();
+
+    Stats GetStats() const;
+
+private:
+    void Run();
+
+    std::mutex m_lifecycle;
+    std::thread m_thread;
+    std::atomic<std::thread::id> m_workerId{};
+    std::atomic<bool> m_stop{ false };
+    std::atomic<uint64_t> m_starts{ 0 };
+    std::atomic<uint64_t> m_loops{ 0 };
+};
+
+extern WorkerRuntime g_Worker;
@@ -0,0 +1,39 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/LS_Reshade/control_channel.cpp" "CMakeFiles/LS_ReShade_core.dir/control_channel.cpp.o" "gcc" "CMakeFiles/LS_ReShade_core.dir/control_channel.cpp.o.d"
+  "/root/repo/LS_Reshade/cursor_manager.cpp" "CMakeFiles/LS_ReShade_core.dir/cursor_manager.cpp.o" "gcc" "CMakeFiles/LS_ReShade_core.dir/cursor_manager.cpp.o.d"
+  "/root/repo/LS_Reshade/focus_resolver.cpp" "CMakeFiles/LS_ReShade_core.dir/focus_resolver.cpp.o" "gcc" "CMakeFiles/LS_ReShade_core.dir/focus_resolver.cpp.o.d"
+  "/root/repo/LS_Reshade/hotkey_engine.cpp" "CMakeFiles/LS_ReShade_core.dir/hotkey_engine.cpp.o" "gcc" "CMakeFiles/LS_ReShade_core.dir/hotkey_engine.cpp.o.d"
+  "/root/repo/LS_Reshade/input_scheduler.cpp" "CMakeFiles/LS_ReShade_core.dir/input_scheduler.cpp.o" "gcc" "CMakeFiles/LS_ReShade_core.dir/input_scheduler.cpp.o.d"
+  "/root/repo/LS_Reshade/input_sim.cpp" "CMakeFiles/LS_ReShade_core.dir/input_sim.cpp.o" "gcc" "CMakeFiles/LS_ReShade_core.dir/input_sim.cpp.o.d"
+  "/root/repo/LS_Reshade/log_format.cpp" "CMakeFiles/LS_ReShade_core.dir/log_format.cpp.o" "gcc" "CMakeFiles/LS_ReShade_core.dir/log_format.cpp.o.d"
+  "/root/repo/LS_Reshade/logger.cpp" "CMakeFiles/LS_ReShade_core.dir/logger.cpp.o" "gcc" "CMakeFiles/LS_ReShade_core.dir/logger.cpp.o.d"
+  "/root/repo/LS_Reshade/mapped_file.cpp" "CMakeFiles/LS_ReShade_core.dir/mapped_file.cpp.o" "gcc" "CMakeFiles/LS_ReShade_core.dir/mapped_file.cpp.o.d"
+  "/root/repo/LS_Reshade/metrics.cpp" "CMakeFiles/LS_ReShade_core.dir/metrics.cpp.o" "gcc" "CMakeFiles/LS_ReShade_core.dir/metrics.cpp.o.d"
+  "/root/repo/LS_Reshade/proc_table.cpp" "CMakeFiles/LS_ReShade_core.dir/proc_table.cpp.o" "gcc" "CMakeFiles/LS_ReShade_core.dir/proc_table.cpp.o.d"
+  "/root/repo/LS_Reshade/restore_journal.cpp" "CMakeFiles/LS_ReShade_core.dir/restore_journal.cpp.o" "gcc" "CMakeFiles/LS_ReShade_core.dir/restore_journal.cpp.o.d"
+  "/root/repo/LS_Reshade/settings.cpp" "CMakeFiles/LS_ReShade_core.dir/settings.cpp.o" "gcc" "CMakeFiles/LS_ReShade_core.dir/settings.cpp.o.d"
+  "/root/repo/LS_Reshade/trace_recorder.cpp" "CMakeFiles/LS_ReShade_core.dir/trace_recorder.cpp.o" "gcc" "CMakeFiles/LS_ReShade_core.dir/trace_recorder.cpp.o.d"
+  "/root/repo/LS_Reshade/window_discovery.cpp" "CMakeFiles/LS_ReShade_core.dir/window_discovery.cpp.o" "gcc" "CMakeFiles/LS_ReShade_core.dir/window_discovery.cpp.o.d"
+  "/root/repo/LS_Reshade/window_manager.cpp" "CMakeFiles/LS_ReShade_core.dir/window_manager.cpp.o" "gcc" "CMakeFiles/LS_ReShade_core.dir/window_manager.cpp.o.d"
+  "/root/repo/LS_Reshade/window_mutations.cpp" "CMakeFiles/LS_ReShade_core.dir/window_mutations.cpp.o" "gcc" "CMakeFiles/LS_ReShade_core.dir/window_mutations.cpp.o.d"
+  "/root/repo/LS_Reshade/window_rules.cpp" "CMakeFiles/LS_ReShade_core.dir/window_rules.cpp.o" "gcc" "CMakeFiles/LS_ReShade_core.dir/window_rules.cpp.o.d"
+  "/root/repo/LS_Reshade/window_store.cpp" "CMakeFiles/LS_ReShade_core.dir/window_store.cpp.o" "gcc" "CMakeFiles/LS_ReShade_core.dir/window_store.cpp.o.d"
+  "/root/repo/LS_Reshade/window_system.cpp" "CMakeFiles/LS_ReShade_core.dir/window_system.cpp.o" "gcc" "CMakeFiles/LS_ReShade_core.dir/window_system.cpp.o.d"
+  "/root/repo/LS_Reshade/worker.cpp" "CMakeFiles/LS_ReShade_core.dir/worker.cpp.o" "gcc" "CMakeFiles/LS_ReShade_core.dir/worker.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,51 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/LS_ReShade_core.dir/control_channel.cpp.o"
+  "CMakeFiles/LS_ReShade_core.dir/control_channel.cpp.o.d"
+  "CMakeFiles/LS_ReShade_core.dir/cursor_manager.cpp.o"
+  "CMakeFiles/LS_ReShade_core.dir/cursor_manager.cpp.o.d"
+  "CMakeFiles/LS_ReShade_core.dir/focus_resolver.cpp.o"
+  "CMakeFiles/LS_ReShade_core.dir/focus_resolver.cpp.o.d"
+  "CMakeFiles/LS_ReShade_core.dir/hotkey_engine.cpp.o"
+  "CMakeFiles/LS_ReShade_core.dir/hotkey_engine.cpp.o.d"
+  "CMakeFiles/LS_ReShade_core.dir/input_scheduler.cpp.o"
+  "CMakeFiles/LS_ReShade_core.dir/input_scheduler.cpp.o.d"
+  "CMakeFiles/LS_ReShade_core.dir/input_sim.cpp.o"
+  "CMakeFiles/LS_ReShade_core.dir/input_sim.cpp.o.d"
+  "CMakeFiles/LS_ReShade_core.dir/log_format.cpp.o"
+  "CMakeFiles/LS_ReShade_core.dir/log_format.cpp.o.d"
+  "CMakeFiles/LS_ReShade_core.dir/logger.cpp.o"
+  "CMakeFiles/LS_ReShade_core.dir/logger.cpp.o.d"
+  "CMakeFiles/LS_ReShade_core.dir/mapped_file.cpp.o"
+  "CMakeFiles/LS_ReShade_core.dir/mapped_file.cpp.o.d"
+  "CMakeFiles/LS_ReShade_core.dir/metrics.cpp.o"
+  "CMakeFiles/LS_ReShade_core.dir/metrics.cpp.o.d"
+  "CMakeFiles/LS_ReShade_core.dir/proc_table.cpp.o"
+  "CMakeFiles/LS_ReShade_core.dir/proc_table.cpp.o.d"
+  "CMakeFiles/LS_ReShade_core.dir/restore_journal.cpp.o"
+  "CMakeFiles/LS_ReShade_core.dir/restore_journal.cpp.o.d"
+  "CMakeFiles/LS_ReShade_core.dir/settings.cpp.o"
+  "CMakeFiles/LS_ReShade_core.dir/settings.cpp.o.d"
+  "CMakeFiles/LS_ReShade_core.dir/trace_recorder.cpp.o"
+  "CMakeFiles/LS_ReShade_core.dir/trace_recorder.cpp.o.d"
+  "CMakeFiles/LS_ReShade_core.dir/window_discovery.cpp.o"
+  "CMakeFiles/LS_ReShade_core.dir/window_discovery.cpp.o.d"
+  "CMakeFiles/LS_ReShade_core.dir/window_manager.cpp.o"
+  "CMakeFiles/LS_ReShade_core.dir/window_manager.cpp.o.d"
+  "CMakeFiles/LS_ReShade_core.dir/window_mutations.cpp.o"
+  "CMakeFiles/LS_ReShade_core.dir/window_mutations.cpp.o.d"
+  "CMakeFiles/LS_ReShade_core.dir/window_rules.cpp.o"
+  "CMakeFiles/LS_ReShade_core.dir/window_rules.cpp.o.d"
+  "CMakeFiles/LS_ReShade_core.dir/window_store.cpp.o"
+  "CMakeFiles/LS_ReShade_core.dir/window_store.cpp.o.d"
+  "CMakeFiles/LS_ReShade_core.dir/window_system.cpp.o"
+  "CMakeFiles/LS_ReShade_core.dir/window_system.cpp.o.d"
+  "CMakeFiles/LS_ReShade_core.dir/worker.cpp.o"
+  "CMakeFiles/LS_ReShade_core.dir/worker.cpp.o.d"
+  "libLS_ReShade_core.a"
+  "libLS_ReShade_core.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/LS_ReShade_core.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,3 @@
+file(REMOVE_RECURSE
+  "libLS_ReShade_core.a"
+)
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/LS_ReShade_fake.dir/fake_window_system.cpp.o"
+  "CMakeFiles/LS_ReShade_fake.dir/fake_window_system.cpp.o.d"
+  "libLS_ReShade_fake.a"
+  "libLS_ReShade_fake.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/LS_ReShade_fake.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
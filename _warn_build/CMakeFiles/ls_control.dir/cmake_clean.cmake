@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ls_control.dir/tools/ls_control.cpp.o"
+  "CMakeFiles/ls_control.dir/tools/ls_control.cpp.o.d"
+  "ls_control"
+  "ls_control.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ls_control.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
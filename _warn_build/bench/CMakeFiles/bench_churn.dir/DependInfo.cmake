@@ -0,0 +1,21 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/LS_Reshade/bench/bench_churn.cpp" "bench/CMakeFiles/bench_churn.dir/bench_churn.cpp.o" "gcc" "bench/CMakeFiles/bench_churn.dir/bench_churn.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_warn_build/CMakeFiles/LS_ReShade_fake.dir/DependInfo.cmake"
+  "/root/repo/_warn_build/CMakeFiles/LS_ReShade_core.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
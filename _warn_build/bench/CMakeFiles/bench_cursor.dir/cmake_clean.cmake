@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_cursor.dir/bench_cursor.cpp.o"
+  "CMakeFiles/bench_cursor.dir/bench_cursor.cpp.o.d"
+  "bench_cursor"
+  "bench_cursor.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_cursor.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_hookproc.dir/bench_hookproc.cpp.o"
+  "CMakeFiles/bench_hookproc.dir/bench_hookproc.cpp.o.d"
+  "bench_hookproc"
+  "bench_hookproc.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_hookproc.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
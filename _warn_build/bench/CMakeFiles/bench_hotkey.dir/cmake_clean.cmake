@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_hotkey.dir/bench_hotkey.cpp.o"
+  "CMakeFiles/bench_hotkey.dir/bench_hotkey.cpp.o.d"
+  "bench_hotkey"
+  "bench_hotkey.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_hotkey.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
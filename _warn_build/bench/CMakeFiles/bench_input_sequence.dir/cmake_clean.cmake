@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_input_sequence.dir/bench_input_sequence.cpp.o"
+  "CMakeFiles/bench_input_sequence.dir/bench_input_sequence.cpp.o.d"
+  "bench_input_sequence"
+  "bench_input_sequence.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_input_sequence.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
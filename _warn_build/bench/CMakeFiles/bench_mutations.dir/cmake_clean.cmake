@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_mutations.dir/bench_mutations.cpp.o"
+  "CMakeFiles/bench_mutations.dir/bench_mutations.cpp.o.d"
+  "bench_mutations"
+  "bench_mutations.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_mutations.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
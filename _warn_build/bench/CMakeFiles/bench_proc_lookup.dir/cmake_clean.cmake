@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_proc_lookup.dir/bench_proc_lookup.cpp.o"
+  "CMakeFiles/bench_proc_lookup.dir/bench_proc_lookup.cpp.o.d"
+  "bench_proc_lookup"
+  "bench_proc_lookup.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_proc_lookup.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
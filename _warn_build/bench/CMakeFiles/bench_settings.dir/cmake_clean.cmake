@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_settings.dir/bench_settings.cpp.o"
+  "CMakeFiles/bench_settings.dir/bench_settings.cpp.o.d"
+  "bench_settings"
+  "bench_settings.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_settings.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
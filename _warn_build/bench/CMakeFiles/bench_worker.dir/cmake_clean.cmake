@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/bench_worker.dir/bench_worker.cpp.o"
+  "CMakeFiles/bench_worker.dir/bench_worker.cpp.o.d"
+  "bench_worker"
+  "bench_worker.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/bench_worker.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()